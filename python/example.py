@@ -30,3 +30,10 @@ sim.run(str(output_path / "sim.json"))
 
 for body in sim.bodies():
     print(f"{body.name}: pose={body.pose}, group_id={body.group_id}, type={body.type}")
+
+# Step natively (without the GIL) and read the poses through a view
+poses = sim.bodies().poses  # (num_bodies × ndof) snapshot refreshed by step()
+sim.set_kinematic_targets(
+    numpy.array([0], dtype=numpy.int32), poses[[0]] + [0, 0.1, 0, 0, 0, 0])
+sim.step(10)
+print(f"poses after 10 more steps:\n{poses}")
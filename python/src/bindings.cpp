@@ -10,7 +10,9 @@
 #include <boost/filesystem.hpp>
 #include <tbb/global_control.h>
 #include <tbb/task_scheduler_init.h>
+#include <mutex>
 #include <thread>
+#include <unordered_set>
 
 #include <SimState.hpp>
 #include <physics/rigid_body.hpp>
@@ -23,6 +25,57 @@ namespace py = pybind11;
 using namespace ipc;
 using namespace ipc::rigid;
 
+/// @brief Refresh the state buffers read by Python after the bodies changed.
+static void refresh_state_buffers(const SimState& sim)
+{
+    auto rbp = std::dynamic_pointer_cast<RigidBodyProblem>(sim.problem_ptr);
+    if (rbp) {
+        rbp->m_assembler.update_pose_buffers();
+        rbp->m_assembler.update_world_vertex_buffer();
+    }
+}
+
+/// @brief Assemblers whose bodies are being advanced by step() or run().
+static std::unordered_set<const RigidBodyAssembler*> stepping_assemblers;
+static std::mutex stepping_assemblers_mutex;
+
+/// @brief Marks the bodies of a simulation as busy while it is stepping.
+///
+/// step() and run() release the GIL, so Python threads can read the state
+/// of the bodies while they are being written. The state accessors check
+/// this mark and raise instead of reading a half-written state.
+class SteppingGuard {
+public:
+    SteppingGuard(const SimState& sim)
+    {
+        auto rbp =
+            std::dynamic_pointer_cast<RigidBodyProblem>(sim.problem_ptr);
+        assembler = rbp ? &rbp->m_assembler : nullptr;
+        std::scoped_lock lock(stepping_assemblers_mutex);
+        if (assembler && !stepping_assemblers.insert(assembler).second) {
+            throw std::runtime_error("Simulation is already stepping");
+        }
+    }
+    ~SteppingGuard()
+    {
+        std::scoped_lock lock(stepping_assemblers_mutex);
+        stepping_assemblers.erase(assembler);
+    }
+
+private:
+    const RigidBodyAssembler* assembler;
+};
+
+/// @brief Raise if the bodies are being advanced by step() or run().
+static void check_not_stepping(const RigidBodyAssembler& assembler)
+{
+    std::scoped_lock lock(stepping_assemblers_mutex);
+    if (stepping_assemblers.count(&assembler)) {
+        throw std::runtime_error(
+            "Cannot read the body state while the simulation is stepping");
+    }
+}
+
 // static tbb::global_control thread_limiter = tbb::global_control(
 //     tbb::global_control::max_allowed_parallelism,
 //     tbb::task_scheduler_init::default_num_threads());
@@ -148,7 +201,38 @@ PYBIND11_MODULE(rigidipc, m)
                 return py::make_iterator(self.m_rbs.begin(), self.m_rbs.end());
             },
             // Essential: keep object alive while iterator exists
-            py::keep_alive<0, 1>(), py::return_value_policy::reference);
+            py::keep_alive<0, 1>(), py::return_value_policy::reference)
+        // The following properties return snapshots (copies) of the state in
+        // the order of the scene file. They raise while Simulation.step() or
+        // Simulation.run() is advancing the bodies in another thread.
+        .def_property_readonly(
+            "poses",
+            [](RigidBodyAssembler& self) -> RigidBodyAssembler::StateBuffer {
+                check_not_stepping(self);
+                self.update_pose_buffers();
+                return self.pose_buffer();
+            },
+            "Snapshot of the body poses (one row of DoF per body).\n"
+            "Raises while the simulation is stepping.")
+        .def_property_readonly(
+            "velocities",
+            [](RigidBodyAssembler& self) -> RigidBodyAssembler::StateBuffer {
+                check_not_stepping(self);
+                self.update_pose_buffers();
+                return self.velocity_buffer();
+            },
+            "Snapshot of the body velocities (one row per body).\n"
+            "Raises while the simulation is stepping.")
+        .def_property_readonly(
+            "world_vertices",
+            [](RigidBodyAssembler& self) -> RigidBodyAssembler::StateBuffer {
+                check_not_stepping(self);
+                self.update_world_vertex_buffer();
+                return self.world_vertex_buffer();
+            },
+            "Snapshot of the world vertices of all bodies (in the order of\n"
+            "the scene file, like poses).\n"
+            "Raises while the simulation is stepping.");
 
     py::class_<SimState>(m, "Simulation")
         .def(py::init<>())
@@ -165,10 +249,57 @@ PYBIND11_MODULE(rigidipc, m)
                     ->m_assembler;
             },
             py::return_value_policy::reference)
-        .def("step", &SimState::simulation_step, "Take a single step")
         .def(
-            "run", &SimState::run_simulation, "Run the entire simulation",
-            py::arg("fout"))
+            "step",
+            [](SimState& self, int num_steps, bool save_steps) {
+                SteppingGuard guard(self);
+                // Run the steps natively without holding the GIL
+                py::gil_scoped_release release;
+                for (int i = 0; i < num_steps; i++) {
+                    self.simulation_step();
+                    if (save_steps) {
+                        self.save_simulation_step();
+                    }
+                }
+                refresh_state_buffers(self);
+            },
+            "Take one or more steps (releases the GIL while stepping)",
+            py::arg("num_steps") = 1, py::arg("save_steps") = false)
+        .def(
+            "set_kinematic_targets",
+            [](SimState& self,
+               const Eigen::Ref<const Eigen::VectorXi>& body_ids,
+               const Eigen::Ref<const RigidBodyAssembler::StateBuffer>& poses) {
+                auto rbp = std::dynamic_pointer_cast<RigidBodyProblem>(
+                    self.problem_ptr);
+                if (!rbp) {
+                    throw std::runtime_error(
+                        "Kinematic targets require a rigid body problem");
+                }
+                check_not_stepping(rbp->m_assembler);
+                int dim = rbp->m_assembler.dim();
+                if (dim != 0 && poses.cols() != PoseD::dim_to_ndof(dim)) {
+                    throw std::invalid_argument(
+                        "Kinematic targets must have one row of DoF per body");
+                }
+                if (poses.rows() != body_ids.size()) {
+                    throw std::invalid_argument(
+                        "Number of kinematic targets and body ids differ");
+                }
+                rbp->m_assembler.set_kinematic_targets(
+                    body_ids, poses, self.problem_ptr->timestep());
+            },
+            "Set the next target pose of several kinematic bodies at once",
+            py::arg("body_ids"), py::arg("poses"))
+        .def(
+            "run",
+            [](SimState& self, const std::string& fout) {
+                SteppingGuard guard(self);
+                py::gil_scoped_release release;
+                self.run_simulation(fout);
+                refresh_state_buffers(self);
+            },
+            "Run the entire simulation", py::arg("fout"))
         .def(
             "save_obj_sequence", &SimState::save_obj_sequence,
             "Save the simulation as a sequence of OBJ files",
@@ -11,7 +11,10 @@
 #include <igl/write_triangle_mesh.h>
 #include <nlohmann/json.hpp>
 
+#include <ccd/query_log.hpp>
 #include <constants.hpp>
+#include <interval/interval_root_finder.hpp>
+#include <io/asset_cache.hpp>
 #include <io/read_rb_scene.hpp>
 #include <io/serialize_json.hpp>
 #include <io/write_gltf.hpp>
@@ -35,6 +38,11 @@ SimState::SimState()
     , m_max_simulation_steps(-1)
     , m_checkpoint_frequency(100)
     , m_dirty_constraints(false)
+    , m_frame_timestep(0.01)
+    , m_time(0)
+    , m_time_t0(0)
+    , m_num_quiet_steps(0)
+    , m_num_ccd_limited_ls(0)
 {
     initial_rss = getCurrentRSS();
 }
@@ -114,6 +122,12 @@ bool SimState::load_simulation(const nlohmann::json& input_args)
     }
     m_num_simulation_steps = int(state_sequence.size()) - 1;
     problem_ptr->state(state_sequence.back());
+    m_time = m_time_t0 = m_num_simulation_steps * frame_timestep();
+    m_frame_state = state_sequence.back();
+    auto rbp = std::dynamic_pointer_cast<RigidBodyProblem>(problem_ptr);
+    if (rbp) {
+        rbp->m_assembler.save_body_states(m_states_t0);
+    }
     return true;
 }
 
@@ -135,7 +149,12 @@ bool SimState::init(const nlohmann::json& args_in)
             "gravity": [0.0, 0.0, 0.0],
             "collision_eps": 0.0,
             "time_stepper": "default",
-            "do_intersection_check": false
+            "do_intersection_check": false,
+            "incremental_intersection_check": true,
+            "body_order": "scene",
+            "body_reorder_frequency": 0,
+            "warm_start": false,
+            "barrier_hessian_projection": "eigen"
         },
         "homotopy_solver": {
             "inner_solver": "DEPRECATED",
@@ -152,6 +171,7 @@ bool SimState::init(const nlohmann::json& args_in)
             "velocity_conv_tol": null,
             "is_velocity_conv_tol_abs": false,
             "line_search_lower_bound": null,
+            "reuse_factorization": false,
             "linear_solver": {
                 "name": "Eigen::SimplicialLDLT",
                 "max_iter": 1000,
@@ -162,7 +182,8 @@ bool SimState::init(const nlohmann::json& args_in)
         },
         "ipc_solver": {
             "dhat_epsilon": 1e-9,
-            "min_barrier_stiffness_scale": null
+            "min_barrier_stiffness_scale": null,
+            "reuse_barrier_stiffness": false
         },
         "ncp_solver": {
             "max_iterations": 1000,
@@ -177,7 +198,8 @@ bool SimState::init(const nlohmann::json& args_in)
             "trajectory_type": "piecewise_linear",
             "initial_barrier_activation_distance": 1e-3,
             "minimum_separation_distance": 0,
-            "barrier_type": "ipc"
+            "barrier_type": "ipc",
+            "deterministic": true
         },
         "friction_constraints": {
             "static_friction_speed_bound": 1e-3,
@@ -193,6 +215,32 @@ bool SimState::init(const nlohmann::json& args_in)
         "viewport_bbox": {
             "min": [0, 0],
             "max": [0, 0]
+        },
+        "adaptive_timestep": {
+            "enabled": false,
+            "min_timestep": null,
+            "max_timestep": null,
+            "shrink_factor": 0.5,
+            "grow_factor": 2.0,
+            "max_newton_iterations": 100,
+            "max_ccd_limited_line_searches": 10,
+            "min_distance": 0,
+            "num_quiet_steps": 10
+        },
+        "ccd_query_log": {
+            "path": "",
+            "sample_rate": 1.0
+        },
+        "gltf_export": {
+            "quantize_rotations": false,
+            "frames_per_chunk": 64
+        },
+        "asset_cache": {
+            "directory": ""
+        },
+        "metrics": {
+            "path": "",
+            "format": "jsonl"
         }
     })"_json;
     // Fill in default values
@@ -241,11 +289,35 @@ bool SimState::init(const nlohmann::json& args_in)
     }
     problem_ptr = tmp_problem_ptr;
 
+    // Reuse the preprocessed body meshes of previous runs
+    const std::string asset_cache_dir = args["asset_cache"]["directory"];
+    if (!asset_cache_dir.empty() && !asset_cache().open(asset_cache_dir)) {
+        return false;
+    }
+
     bool success = problem_ptr->settings(args);
     if (!success) {
         return false;
     }
 
+    // Record the narrow-phase CCD queries for offline replay
+    const json& jccd_query_log = args["ccd_query_log"];
+    const std::string ccd_query_log_path = jccd_query_log["path"];
+    if (!ccd_query_log_path.empty()
+        && !ccd_query_log().open(
+            ccd_query_log_path, jccd_query_log["sample_rate"].get<double>())) {
+        return false;
+    }
+
+    // Stream the metrics of each step
+    const json& jmetrics = args["metrics"];
+    const std::string metrics_path = jmetrics["path"];
+    if (!metrics_path.empty()
+        && !open_metrics_log(
+            metrics_path, jmetrics["format"].get<MetricsFormat>())) {
+        return false;
+    }
+
     m_max_simulation_steps = args["max_iterations"].get<int>();
     problem_ptr->timestep(args["timestep"].get<double>());
     double max_time = args["max_time"].get<double>();
@@ -254,11 +326,58 @@ bool SimState::init(const nlohmann::json& args_in)
         m_max_simulation_steps = int(ceil(max_time / problem_ptr->timestep()));
     }
 
+    // Adaptive time-stepping (frames stay at the nominal time-step)
+    m_frame_timestep = args["timestep"].get<double>();
+    const json& jadaptive = args["adaptive_timestep"];
+    m_adaptive_timestep.enabled = jadaptive["enabled"].get<bool>();
+    m_adaptive_timestep.min_timestep = jadaptive["min_timestep"].is_null()
+        ? 1e-3 * m_frame_timestep
+        : jadaptive["min_timestep"].get<double>();
+    m_adaptive_timestep.max_timestep = jadaptive["max_timestep"].is_null()
+        ? m_frame_timestep
+        : jadaptive["max_timestep"].get<double>();
+    m_adaptive_timestep.shrink_factor = jadaptive["shrink_factor"];
+    m_adaptive_timestep.grow_factor = jadaptive["grow_factor"];
+    m_adaptive_timestep.max_newton_iterations =
+        jadaptive["max_newton_iterations"];
+    m_adaptive_timestep.max_ccd_limited_line_searches =
+        jadaptive["max_ccd_limited_line_searches"];
+    m_adaptive_timestep.min_distance = jadaptive["min_distance"];
+    m_adaptive_timestep.num_quiet_steps = jadaptive["num_quiet_steps"];
+    auto rbp = std::dynamic_pointer_cast<RigidBodyProblem>(problem_ptr);
+    if (m_adaptive_timestep.enabled && !rbp) {
+        // Rejected steps are retried from a snapshot of the bodies
+        spdlog::warn("Adaptive time-stepping requires a rigid body problem; "
+                     "disabling it!");
+        m_adaptive_timestep.enabled = false;
+    }
+    if (m_adaptive_timestep.enabled
+        && rbp->m_assembler.count_kinematic_bodies()) {
+        // Kinematic bodies consume their poses and remaining time per
+        // time-step (and become static at the end), which a rejected step
+        // cannot undo.
+        spdlog::warn("Adaptive time-stepping is not supported with "
+                     "kinematic bodies; disabling it!");
+        m_adaptive_timestep.enabled = false;
+    }
+    if (m_adaptive_timestep.enabled) {
+        problem_ptr->timestep(std::clamp(
+            m_frame_timestep, m_adaptive_timestep.min_timestep,
+            m_adaptive_timestep.max_timestep));
+    }
+    m_time = m_time_t0 = 0;
+    m_num_quiet_steps = 0;
+    m_num_ccd_limited_ls = 0;
+
     m_num_simulation_steps = 0;
     m_dirty_constraints = true;
 
     state_sequence.clear();
     state_sequence.push_back(problem_ptr->state());
+    m_frame_state = state_sequence.back();
+    if (rbp) {
+        rbp->m_assembler.save_body_states(m_states_t0);
+    }
     step_timings.clear();
     solver_iterations.clear();
     num_contacts.clear();
@@ -270,7 +389,7 @@ bool SimState::init(const nlohmann::json& args_in)
 nlohmann::json SimState::get_active_config()
 {
     nlohmann::json active_args;
-    active_args["timestep"] = problem_ptr->timestep();
+    active_args["timestep"] = frame_timestep();
     active_args["scene_type"] = problem_ptr->name();
 
     active_args[problem_ptr->name()] = problem_ptr->settings();
@@ -286,6 +405,20 @@ nlohmann::json SimState::get_active_config()
     return active_args;
 }
 
+/// @brief Body poses stored in a serialized state.
+static PosesD state_poses(const nlohmann::json& state)
+{
+    PosesD poses;
+    for (const nlohmann::json& jrb : state["rigid_bodies"]) {
+        VectorMax3d position;
+        VectorMax3d rotation;
+        from_json(jrb["position"], position);
+        from_json(jrb["rotation"], rotation);
+        poses.emplace_back(position, rotation);
+    }
+    return poses;
+}
+
 void print_progress_bar(
     int cur_iter,
     int max_iter,
@@ -332,6 +465,23 @@ void SimState::run_simulation(const std::string& fout)
     igl::Timer timer;
     timer.start();
 
+    // Stream the animation to disk as the simulation runs
+    fs::path gltf_filename(fout);
+    gltf_filename.replace_extension(".glb");
+    std::shared_ptr<RigidBodyProblem> rbp =
+        std::dynamic_pointer_cast<RigidBodyProblem>(problem_ptr);
+    if (rbp != nullptr && rbp->dim() == 3) {
+        const nlohmann::json& jgltf = args["gltf_export"];
+        if (m_gltf_writer.open(
+                gltf_filename.string(), rbp->m_assembler, frame_timestep(),
+                jgltf["quantize_rotations"].get<bool>(),
+                jgltf["frames_per_chunk"].get<int>())) {
+            for (const nlohmann::json& state : state_sequence) {
+                m_gltf_writer.append(state_poses(state));
+            }
+        }
+    }
+
     m_solve_collisions = true;
     print_progress_bar(0, m_max_simulation_steps, 0);
     for (int i = 0; i < m_max_simulation_steps; ++i) {
@@ -353,6 +503,8 @@ void SimState::run_simulation(const std::string& fout)
     }
 
     timer.stop();
+    ccd_query_log().close();
+    m_metrics_log.close();
     fmt::print(
         "Simulation finished (total_runtime={:g}s average_fps={:g})\n",
         timer.getElapsedTime(),
@@ -365,10 +517,9 @@ void SimState::run_simulation(const std::string& fout)
 
     save_simulation(fout);
     spdlog::info("Simulation results saved to {}", fout);
-    fs::path gltf_filename(fout);
-    gltf_filename.replace_extension(".glb");
-    save_gltf(gltf_filename.string());
-    spdlog::info("Animation saved to {}", gltf_filename.string());
+    if (m_gltf_writer.is_open() && m_gltf_writer.close()) {
+        spdlog::info("Animation saved to {}", gltf_filename.string());
+    }
 
     PROFILE_END();
     LOG_PROFILER(scene_file);
@@ -381,8 +532,12 @@ void SimState::simulation_step()
     m_step_has_intersections = false;
 
     step_timer.start();
-    problem_ptr->simulation_step(
-        m_step_had_collision, m_step_has_intersections, m_solve_collisions);
+    if (m_adaptive_timestep.enabled) {
+        adaptive_simulation_step();
+    } else {
+        problem_ptr->simulation_step(
+            m_step_had_collision, m_step_has_intersections, m_solve_collisions);
+    }
     step_timer.stop();
 
     if (m_step_had_collision) {
@@ -408,20 +563,212 @@ void SimState::simulation_step()
     //                          : "collisions_solved");
 }
 
+/// Linearly interpolate the body poses and velocities of a state between the
+/// body states at the start and end of a step.
+void interpolate_body_states(
+    const RigidBodyAssembler::BodyStates& states0,
+    const RigidBodyAssembler::BodyStates& states1,
+    double t,
+    nlohmann::json& state)
+{
+    auto lerp = [t](const VectorMax3d& x0, const VectorMax3d& x1) {
+        return to_json(Eigen::VectorXd((1 - t) * x0 + t * x1));
+    };
+    for (size_t i = 0; i < state["rigid_bodies"].size(); i++) {
+        nlohmann::json& jrb = state["rigid_bodies"][i];
+        jrb["position"] =
+            lerp(states0.poses[i].position, states1.poses[i].position);
+        jrb["rotation"] =
+            lerp(states0.poses[i].rotation, states1.poses[i].rotation);
+        jrb["linear_velocity"] = lerp(
+            states0.velocities[i].position, states1.velocities[i].position);
+        jrb["angular_velocity"] = lerp(
+            states0.velocities[i].rotation, states1.velocities[i].rotation);
+    }
+}
+
+void SimState::adaptive_simulation_step()
+{
+    // Take as many sub-steps as needed to reach the frame time. The last
+    // sub-step may overshoot the frame, in which case the frame is
+    // interpolated and the overshoot is used for the following frame(s).
+    const double frame_time = m_num_simulation_steps * m_frame_timestep;
+    const double eps = 1e-8 * m_frame_timestep;
+
+    RigidBodyAssembler& bodies =
+        std::static_pointer_cast<RigidBodyProblem>(problem_ptr)->m_assembler;
+
+    m_step_had_collision = false;
+    int num_substeps = 0, num_rejected = 0, num_iterations = 0;
+    while (m_time < frame_time - eps) {
+        bodies.save_body_states(m_states_t0);
+        const double h = problem_ptr->timestep();
+
+        bool had_collision = false, has_intersections = false;
+        problem_ptr->simulation_step(
+            had_collision, has_intersections, m_solve_collisions);
+        num_iterations += problem_ptr->opt_result.num_iterations;
+
+        // A difficult step is retried with the smaller time-step (unless it
+        // is already the smallest allowed).
+        if (update_adaptive_timestep(has_intersections)
+            && problem_ptr->timestep() < h) {
+            bodies.restore_body_states(m_states_t0);
+            // Do not carry κ or the factorization over from the rejected step
+            problem_ptr->solver().reset_history();
+            num_rejected++;
+            continue;
+        }
+
+        m_step_had_collision |= had_collision;
+        m_step_has_intersections |= has_intersections;
+        m_time_t0 = m_time;
+        m_time += h;
+        num_substeps++;
+    }
+    // Report the total work done for this frame
+    problem_ptr->opt_result.num_iterations = num_iterations;
+
+    double t = m_time > m_time_t0
+        ? (frame_time - m_time_t0) / (m_time - m_time_t0)
+        : 1.0;
+    m_frame_state = problem_ptr->state();
+    if (t < 1 - 1e-8) {
+        RigidBodyAssembler::BodyStates states1;
+        bodies.save_body_states(states1);
+        interpolate_body_states(m_states_t0, states1, t, m_frame_state);
+    }
+
+    spdlog::debug(
+        "sim_state action=adaptive_simulation_step sim_it={} "
+        "num_substeps={:d} num_rejected={:d} h={:g} t={:g}",
+        m_num_simulation_steps, num_substeps, num_rejected,
+        problem_ptr->timestep(), m_time);
+}
+
+bool SimState::update_adaptive_timestep(bool has_intersections)
+{
+    const AdaptiveTimestep& settings = m_adaptive_timestep;
+
+    // Count the line searches limited by CCD in the last step
+    size_t num_ccd_limited_ls = m_num_ccd_limited_ls;
+    nlohmann::json solver_stats = problem_ptr->solver().stats();
+    if (solver_stats.is_object()) {
+        m_num_ccd_limited_ls =
+            solver_stats.value("count_ccd_limited_ls", m_num_ccd_limited_ls);
+    }
+    num_ccd_limited_ls = m_num_ccd_limited_ls - num_ccd_limited_ls;
+
+    double min_distance = settings.min_distance > 0
+        ? problem_ptr->compute_min_distance()
+        : -1; // -1 if no geometry is close or the check is disabled
+
+    const OptimizationResults& result = problem_ptr->opt_result;
+    bool is_difficult = has_intersections || !result.success
+        || result.num_iterations > settings.max_newton_iterations
+        || int(num_ccd_limited_ls) > settings.max_ccd_limited_line_searches
+        || (min_distance >= 0 && min_distance < settings.min_distance);
+
+    double h = problem_ptr->timestep(), new_h = h;
+    if (is_difficult) {
+        new_h = std::max(h * settings.shrink_factor, settings.min_timestep);
+        m_num_quiet_steps = 0;
+    } else if (++m_num_quiet_steps >= settings.num_quiet_steps) {
+        new_h = std::min(h * settings.grow_factor, settings.max_timestep);
+        m_num_quiet_steps = 0;
+    }
+
+    if (new_h != h) {
+        spdlog::info(
+            "sim_state action=update_timestep h={:g} new_h={:g} "
+            "newton_iterations={:d} num_ccd_limited_ls={:d} "
+            "min_distance={:g}",
+            h, new_h, result.num_iterations, num_ccd_limited_ls,
+            min_distance);
+        problem_ptr->timestep(new_h);
+    }
+    return is_difficult;
+}
+
 void SimState::save_simulation_step()
 {
     PROFILE_POINT("SimState::save_simulation_step");
     PROFILE_START();
 
-    state_sequence.push_back(problem_ptr->state());
+    state_sequence.push_back(
+        m_adaptive_timestep.enabled ? m_frame_state : problem_ptr->state());
+    if (m_gltf_writer.is_open()) {
+        // The writer is only opened for rigid body problems
+        const RigidBodyAssembler& bodies =
+            std::static_pointer_cast<RigidBodyProblem>(problem_ptr)
+                ->m_assembler;
+        m_gltf_writer.append(
+            m_adaptive_timestep.enabled
+                ? state_poses(m_frame_state)
+                : bodies.to_scene_order(bodies.rb_poses()));
+    }
     step_timings.push_back(step_timer.getElapsedTime());
     solver_iterations.push_back(problem_ptr->opt_result.num_iterations);
     num_contacts.push_back(problem_ptr->num_contacts());
     step_minimum_distances.push_back(problem_ptr->compute_min_distance());
+    if (m_metrics_log.is_open()) {
+        log_step_metrics();
+    }
 
     PROFILE_END();
 }
 
+bool SimState::open_metrics_log(const std::string& path, MetricsFormat format)
+{
+    if (!m_metrics_log.open(path, format)) {
+        return false;
+    }
+    m_metrics_totals = metrics_totals();
+    return true;
+}
+
+nlohmann::json SimState::metrics_totals() const
+{
+    nlohmann::json totals = problem_ptr->solver().stats();
+    if (!totals.is_object()) {
+        totals = nlohmann::json::object();
+    }
+    totals.update(problem_ptr->constraint().stats());
+    totals["ccd_time"] = problem_ptr->get_ccd_time();
+    totals["count_root_finder_boxes"] = interval_root_finder_total_num_boxes();
+    return totals;
+}
+
+void SimState::log_step_metrics()
+{
+    nlohmann::json record;
+    record["step"] = m_num_simulation_steps;
+    record["timestep"] = problem_ptr->timestep();
+    record["step_time"] = step_timings.back();
+    record["newton_iterations"] = solver_iterations.back();
+    record["num_contacts"] = num_contacts.back();
+    record["min_distance"] = step_minimum_distances.back();
+    record["rss"] = getCurrentRSS();
+
+    // Counters and timers are reported as their change during the step
+    nlohmann::json totals = metrics_totals();
+    for (const auto& item : totals.items()) {
+        const nlohmann::json& total = item.value();
+        const auto prev_total = m_metrics_totals.find(item.key());
+        const bool has_prev = prev_total != m_metrics_totals.end();
+        if (total.is_number_integer()) {
+            record[item.key()] = total.get<long long>()
+                - (has_prev ? prev_total->get<long long>() : 0);
+        } else if (total.is_number()) {
+            record[item.key()] = total.get<double>()
+                - (has_prev ? prev_total->get<double>() : 0.0);
+        }
+    }
+    m_metrics_totals = std::move(totals);
+
+    m_metrics_log.append(std::move(record));
+}
+
 bool SimState::save_simulation(const std::string& filename)
 {
     PROFILE_POINT("SimState::save_simulation");
@@ -465,6 +812,9 @@ bool SimState::save_obj_sequence(const std::string& dir_name)
     fs::path dir_path(dir_name);
     fs::create_directories(dir_path);
 
+    // The last frame can be interpolated, so restore the actual state after
+    const nlohmann::json current_state = problem_ptr->state();
+
     bool success = true;
     for (int i = 0; i < state_sequence.size(); i++) {
         const auto& state = state_sequence[i];
@@ -474,33 +824,38 @@ bool SimState::save_obj_sequence(const std::string& dir_name)
             false);
     }
 
-    problem_ptr->state(state_sequence.back());
+    problem_ptr->state(current_state);
 
     return success;
 }
 
 bool SimState::save_gltf(const std::string& filename)
 {
-    std::vector<PosesD> poses(state_sequence.size());
+    std::shared_ptr<RigidBodyProblem> rbp =
+        std::dynamic_pointer_cast<RigidBodyProblem>(problem_ptr);
 
-    bool success = true;
-    for (int i = 0; i < state_sequence.size(); i++) {
-        const auto& state = state_sequence[i];
-        std::vector<nlohmann::json> jrbs = state["rigid_bodies"];
-        for (int j = 0; j < jrbs.size(); j++) {
-            VectorMax3d position;
-            VectorMax3d rotation;
-            from_json(jrbs[j]["position"], position);
-            from_json(jrbs[j]["rotation"], rotation);
-            poses[i].emplace_back(position, rotation);
+    if (fs::path(filename).extension() == ".glb") {
+        const nlohmann::json& jgltf = args["gltf_export"];
+        GLBAnimationWriter writer;
+        if (!writer.open(
+                filename, rbp->m_assembler, frame_timestep(),
+                jgltf["quantize_rotations"].get<bool>(),
+                jgltf["frames_per_chunk"].get<int>())) {
+            return false;
         }
+        for (const nlohmann::json& state : state_sequence) {
+            writer.append(state_poses(state));
+        }
+        return writer.close();
     }
 
-    std::shared_ptr<RigidBodyProblem> rbp =
-        std::dynamic_pointer_cast<RigidBodyProblem>(problem_ptr);
-
+    std::vector<PosesD> poses;
+    poses.reserve(state_sequence.size());
+    for (const nlohmann::json& state : state_sequence) {
+        poses.push_back(state_poses(state));
+    }
     return write_gltf(
-        filename, rbp->m_assembler, poses, problem_ptr->timestep());
+        filename, rbp->m_assembler, poses, frame_timestep());
 }
 
 } // namespace ipc::rigid
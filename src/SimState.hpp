@@ -5,6 +5,9 @@
 
 #include <memory> // shared_ptr
 
+#include <io/metrics_log.hpp>
+#include <io/write_gltf.hpp>
+#include <physics/rigid_body_assembler.hpp>
 #include <physics/simulation_problem.hpp>
 #include <solvers/optimization_solver.hpp>
 
@@ -29,9 +32,19 @@ public:
 
     void run_simulation(const std::string& fout);
 
+    /// @brief Append the metrics of each step to the given file.
+    bool open_metrics_log(const std::string& path, MetricsFormat format);
+
     const nlohmann::json& get_config() { return args; }
     nlohmann::json get_active_config();
 
+    /// @brief Time between two saved frames.
+    double frame_timestep() const
+    {
+        return m_adaptive_timestep.enabled ? m_frame_timestep
+                                           : problem_ptr->timestep();
+    }
+
     // ----------------------------------------------
     std::shared_ptr<SimulationProblem> problem_ptr;
 
@@ -53,11 +66,55 @@ public:
     std::vector<int> num_contacts;
     std::vector<double> step_minimum_distances;
 
+    /// @brief Settings of the adaptive time-step control.
+    struct AdaptiveTimestep {
+        bool enabled = false;
+        double min_timestep; ///< Smallest allowed time-step
+        double max_timestep; ///< Largest allowed time-step
+        double shrink_factor;
+        double grow_factor;
+        /// Shrink if a step takes more Newton iterations than this
+        int max_newton_iterations;
+        /// Shrink if a step has more CCD limited line searches than this
+        int max_ccd_limited_line_searches;
+        /// Shrink if the minimum distance falls below this (0 to disable)
+        double min_distance;
+        /// Number of consecutive quiet steps before growing the time-step
+        int num_quiet_steps;
+    } m_adaptive_timestep;
+
 protected:
+    /// @brief Advance to the next frame using adaptive sub-steps.
+    void adaptive_simulation_step();
+    /// @brief Update the time-step based on the statistics of the last step.
+    /// @return True if the step was difficult (and the time-step shrunk).
+    bool update_adaptive_timestep(bool has_intersections);
+
+    /// @brief Running totals of the solver and collision detection counters.
+    nlohmann::json metrics_totals() const;
+    /// @brief Queue the metrics of the last step in the metrics log.
+    void log_step_metrics();
+
     igl::Timer step_timer;
     size_t initial_rss;
 
     bool m_dirty_constraints;
+
+    // Adaptive time-stepping state
+    double m_frame_timestep;      ///< Time between two saved frames
+    double m_time;                ///< Simulated time of the current state
+    double m_time_t0;             ///< Simulated time at the start of last step
+    /// Body states at the start of the last step
+    RigidBodyAssembler::BodyStates m_states_t0;
+    nlohmann::json m_frame_state; ///< State interpolated to the last frame
+    int m_num_quiet_steps;        ///< Consecutive steps without difficulty
+    size_t m_num_ccd_limited_ls;  ///< Running count of CCD limited searches
+
+    /// @brief Animation streamed to disk while running the simulation.
+    GLBAnimationWriter m_gltf_writer;
+
+    MetricsLog m_metrics_log;
+    nlohmann::json m_metrics_totals; ///< Totals at the end of the last step
 };
 
 } // namespace ipc::rigid
@@ -1,26 +1,27 @@
 #include "ccd.hpp"
 
 #include <mutex>
+#include <tuple>
+
+#include <igl/Timer.h>
 
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 #include <tbb/parallel_invoke.h>
+#include <tbb/parallel_sort.h>
 
 #include <ipc/ccd/ccd.hpp>
 #include <ipc/friction/closest_point.hpp>
 
+#include <ccd/conservative_advancement/time_of_impact.hpp>
 #include <ccd/linear/broad_phase.hpp>
 #include <ccd/linear/edge_vertex_ccd.hpp>
 #include <ccd/piecewise_linear/time_of_impact.hpp>
+#include <ccd/query_log.hpp>
 #include <ccd/redon/time_of_impact.hpp>
 #include <ccd/rigid/broad_phase.hpp>
 #include <ccd/rigid/time_of_impact.hpp>
 
-// #define SAVE_CCD_QUERIES
-#ifdef SAVE_CCD_QUERIES
-#include <ccd/save_queries.hpp>
-#endif
-
 #include <profiler.hpp>
 
 namespace ipc::rigid {
@@ -75,6 +76,7 @@ void detect_collision_candidates(
     case TrajectoryType::PIECEWISE_LINEAR:
     case TrajectoryType::RIGID:
     case TrajectoryType::REDON:
+    case TrajectoryType::CONSERVATIVE_ADVANCEMENT:
         detect_collision_candidates_rigid(
             bodies, poses_t0, poses_t1, collision_types, candidates, method,
             inflation_radius);
@@ -149,9 +151,73 @@ void detect_collisions_from_candidates(
         [&] { tbb::parallel_for_each(candidates.ee_candidates, ee_impact); },
         [&] { tbb::parallel_for_each(candidates.fv_candidates, fv_impact); });
 
+    // The impacts are appended in the order they are found, so sort them by
+    // their primitives to make the order reproducible.
+    tbb::parallel_sort(
+        impacts.ev_impacts.begin(), impacts.ev_impacts.end(),
+        [](const EdgeVertexImpact& i0, const EdgeVertexImpact& i1) {
+            return std::tie(i0.edge_index, i0.vertex_index)
+                < std::tie(i1.edge_index, i1.vertex_index);
+        });
+    tbb::parallel_sort(
+        impacts.ee_impacts.begin(), impacts.ee_impacts.end(),
+        [](const EdgeEdgeImpact& i0, const EdgeEdgeImpact& i1) {
+            return std::tie(i0.impacted_edge_index, i0.impacting_edge_index)
+                < std::tie(i1.impacted_edge_index, i1.impacting_edge_index);
+        });
+    tbb::parallel_sort(
+        impacts.fv_impacts.begin(), impacts.fv_impacts.end(),
+        [](const FaceVertexImpact& i0, const FaceVertexImpact& i1) {
+            return std::tie(i0.face_index, i0.vertex_index)
+                < std::tie(i1.face_index, i1.vertex_index);
+        });
+
     PROFILE_END();
 }
 
+/// @brief Run a narrow-phase query and record it in the CCD query log.
+/// @param vertices Body coordinates of the primitive vertices (see CCDQuery).
+template <typename CCD>
+static bool logged_ccd(
+    int type,
+    const Eigen::MatrixXd& vertices,
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1,
+    CCD ccd,
+    double& toi,
+    TrajectoryType trajectory,
+    double earliest_toi,
+    double minimum_separation_distance)
+{
+    igl::Timer timer;
+    timer.start();
+    bool is_impacting = ccd(toi);
+    timer.stop();
+
+    CCDQuery query;
+    query.type = type;
+    query.trajectory = trajectory;
+    query.dim = vertices.cols();
+    for (int i = 0; i < vertices.rows(); i++) {
+        query.vertices[i].setZero();
+        query.vertices[i].head(query.dim) = vertices.row(i);
+    }
+    query.poseA_t0 = poseA_t0;
+    query.poseA_t1 = poseA_t1;
+    query.poseB_t0 = poseB_t0;
+    query.poseB_t1 = poseB_t1;
+    query.earliest_toi = earliest_toi;
+    query.minimum_separation_distance = minimum_separation_distance;
+    query.is_impacting = is_impacting;
+    query.toi = is_impacting ? toi : std::numeric_limits<double>::infinity();
+    query.seconds = timer.getElapsedTimeInSec();
+    ccd_query_log().append(query);
+
+    return is_impacting;
+}
+
 // Determine if a single edge-vertext pair intersects.
 bool edge_vertex_ccd(
     const RigidBodyAssembler& bodies,
@@ -165,19 +231,48 @@ bool edge_vertex_ccd(
 {
     assert(bodies.dim() == 2);
 
-#ifdef SAVE_CCD_QUERIES
-    save_ccd_candidate(bodies, poses_t0, poses_t1, candidate);
-#endif
-
     long bodyA_id, vertex_id, bodyB_id, edge_id;
     bodies.global_to_local_vertex(candidate.vertex_id, bodyA_id, vertex_id);
     bodies.global_to_local_edge(candidate.edge_id, bodyB_id, edge_id);
     const RigidBody& bodyA = bodies[bodyA_id];
     const RigidBody& bodyB = bodies[bodyB_id];
-    const PoseD& poseA_t0 = poses_t0[bodyA_id];
-    const PoseD& poseA_t1 = poses_t1[bodyA_id];
-    const PoseD& poseB_t0 = poses_t0[bodyB_id];
-    const PoseD& poseB_t1 = poses_t1[bodyB_id];
+    const auto ccd = [&](double& ccd_toi) {
+        return edge_vertex_ccd(
+            bodyA, poses_t0[bodyA_id], poses_t1[bodyA_id], vertex_id, bodyB,
+            poses_t0[bodyB_id], poses_t1[bodyB_id], edge_id, ccd_toi,
+            trajectory, earliest_toi, minimum_separation_distance);
+    };
+    if (!ccd_query_log().sample(
+            CollisionType::EDGE_VERTEX, candidate.vertex_id, candidate.edge_id,
+            poses_t0[bodyA_id], poses_t1[bodyA_id], poses_t0[bodyB_id],
+            poses_t1[bodyB_id])) {
+        return ccd(toi);
+    }
+
+    Eigen::MatrixXd vertices(3, bodies.dim());
+    vertices.row(0) = bodyA.vertices.row(vertex_id);
+    vertices.row(1) = bodyB.vertices.row(bodyB.edges(edge_id, 0));
+    vertices.row(2) = bodyB.vertices.row(bodyB.edges(edge_id, 1));
+    return logged_ccd(
+        CollisionType::EDGE_VERTEX, vertices, poses_t0[bodyA_id],
+        poses_t1[bodyA_id], poses_t0[bodyB_id], poses_t1[bodyB_id], ccd, toi,
+        trajectory, earliest_toi, minimum_separation_distance);
+}
+
+bool edge_vertex_ccd(
+    const RigidBody& bodyA,
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    size_t vertex_id,
+    const RigidBody& bodyB,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1,
+    size_t edge_id,
+    double& toi,
+    TrajectoryType trajectory,
+    double earliest_toi,
+    double minimum_separation_distance)
+{
     long e0_id = bodyB.edges(edge_id, 0);
     long e1_id = bodyB.edges(edge_id, 1);
 
@@ -213,6 +308,11 @@ bool edge_vertex_ccd(
             bodyA, poseA_t0, poseA_t1, vertex_id, bodyB, poseB_t0, poseB_t1,
             edge_id, toi, earliest_toi);
 
+    case TrajectoryType::CONSERVATIVE_ADVANCEMENT:
+        return compute_edge_vertex_time_of_impact_conservative_advancement(
+            bodyA, poseA_t0, poseA_t1, vertex_id, bodyB, poseB_t0, poseB_t1,
+            edge_id, toi, earliest_toi, minimum_separation_distance);
+
     default:
         throw "Invalid trajectory type";
     }
@@ -228,19 +328,49 @@ bool edge_edge_ccd(
     double earliest_toi,
     double minimum_separation_distance)
 {
-#ifdef SAVE_CCD_QUERIES
-    save_ccd_candidate(bodies, poses_t0, poses_t1, candidate);
-#endif
-
     long bodyA_id, edgeA_id, bodyB_id, edgeB_id;
     bodies.global_to_local_edge(candidate.edge0_id, bodyA_id, edgeA_id);
     bodies.global_to_local_edge(candidate.edge1_id, bodyB_id, edgeB_id);
     const RigidBody& bodyA = bodies[bodyA_id];
     const RigidBody& bodyB = bodies[bodyB_id];
-    const PoseD& poseA_t0 = poses_t0[bodyA_id];
-    const PoseD& poseA_t1 = poses_t1[bodyA_id];
-    const PoseD& poseB_t0 = poses_t0[bodyB_id];
-    const PoseD& poseB_t1 = poses_t1[bodyB_id];
+    const auto ccd = [&](double& ccd_toi) {
+        return edge_edge_ccd(
+            bodyA, poses_t0[bodyA_id], poses_t1[bodyA_id], edgeA_id, bodyB,
+            poses_t0[bodyB_id], poses_t1[bodyB_id], edgeB_id, ccd_toi,
+            trajectory, earliest_toi, minimum_separation_distance);
+    };
+    if (!ccd_query_log().sample(
+            CollisionType::EDGE_EDGE, candidate.edge0_id, candidate.edge1_id,
+            poses_t0[bodyA_id], poses_t1[bodyA_id], poses_t0[bodyB_id],
+            poses_t1[bodyB_id])) {
+        return ccd(toi);
+    }
+
+    Eigen::MatrixXd vertices(4, bodies.dim());
+    vertices.row(0) = bodyA.vertices.row(bodyA.edges(edgeA_id, 0));
+    vertices.row(1) = bodyA.vertices.row(bodyA.edges(edgeA_id, 1));
+    vertices.row(2) = bodyB.vertices.row(bodyB.edges(edgeB_id, 0));
+    vertices.row(3) = bodyB.vertices.row(bodyB.edges(edgeB_id, 1));
+    return logged_ccd(
+        CollisionType::EDGE_EDGE, vertices, poses_t0[bodyA_id],
+        poses_t1[bodyA_id], poses_t0[bodyB_id], poses_t1[bodyB_id], ccd, toi,
+        trajectory, earliest_toi, minimum_separation_distance);
+}
+
+bool edge_edge_ccd(
+    const RigidBody& bodyA,
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    size_t edgeA_id,
+    const RigidBody& bodyB,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1,
+    size_t edgeB_id,
+    double& toi,
+    TrajectoryType trajectory,
+    double earliest_toi,
+    double minimum_separation_distance)
+{
     long ea0_id = bodyA.edges(edgeA_id, 0);
     long ea1_id = bodyA.edges(edgeA_id, 1);
     long eb0_id = bodyB.edges(edgeB_id, 0);
@@ -283,6 +413,11 @@ bool edge_edge_ccd(
             bodyA, poseA_t0, poseA_t1, edgeA_id, bodyB, poseB_t0, poseB_t1,
             edgeB_id, toi, earliest_toi);
 
+    case TrajectoryType::CONSERVATIVE_ADVANCEMENT:
+        return compute_edge_edge_time_of_impact_conservative_advancement(
+            bodyA, poseA_t0, poseA_t1, edgeA_id, bodyB, poseB_t0, poseB_t1,
+            edgeB_id, toi, earliest_toi, minimum_separation_distance);
+
     default:
         throw "Invalid trajectory type";
     }
@@ -298,19 +433,49 @@ bool face_vertex_ccd(
     double earliest_toi,
     double minimum_separation_distance)
 {
-#ifdef SAVE_CCD_QUERIES
-    save_ccd_candidate(bodies, poses_t0, poses_t1, candidate);
-#endif
-
     long bodyA_id, vertex_id, bodyB_id, face_id;
     bodies.global_to_local_vertex(candidate.vertex_id, bodyA_id, vertex_id);
     bodies.global_to_local_face(candidate.face_id, bodyB_id, face_id);
     const RigidBody& bodyA = bodies[bodyA_id];
     const RigidBody& bodyB = bodies[bodyB_id];
-    const PoseD& poseA_t0 = poses_t0[bodyA_id];
-    const PoseD& poseA_t1 = poses_t1[bodyA_id];
-    const PoseD& poseB_t0 = poses_t0[bodyB_id];
-    const PoseD& poseB_t1 = poses_t1[bodyB_id];
+    const auto ccd = [&](double& ccd_toi) {
+        return face_vertex_ccd(
+            bodyA, poses_t0[bodyA_id], poses_t1[bodyA_id], vertex_id, bodyB,
+            poses_t0[bodyB_id], poses_t1[bodyB_id], face_id, ccd_toi,
+            trajectory, earliest_toi, minimum_separation_distance);
+    };
+    if (!ccd_query_log().sample(
+            CollisionType::FACE_VERTEX, candidate.vertex_id, candidate.face_id,
+            poses_t0[bodyA_id], poses_t1[bodyA_id], poses_t0[bodyB_id],
+            poses_t1[bodyB_id])) {
+        return ccd(toi);
+    }
+
+    Eigen::MatrixXd vertices(4, bodies.dim());
+    vertices.row(0) = bodyA.vertices.row(vertex_id);
+    vertices.row(1) = bodyB.vertices.row(bodyB.faces(face_id, 0));
+    vertices.row(2) = bodyB.vertices.row(bodyB.faces(face_id, 1));
+    vertices.row(3) = bodyB.vertices.row(bodyB.faces(face_id, 2));
+    return logged_ccd(
+        CollisionType::FACE_VERTEX, vertices, poses_t0[bodyA_id],
+        poses_t1[bodyA_id], poses_t0[bodyB_id], poses_t1[bodyB_id], ccd, toi,
+        trajectory, earliest_toi, minimum_separation_distance);
+}
+
+bool face_vertex_ccd(
+    const RigidBody& bodyA,
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    size_t vertex_id,
+    const RigidBody& bodyB,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1,
+    size_t face_id,
+    double& toi,
+    TrajectoryType trajectory,
+    double earliest_toi,
+    double minimum_separation_distance)
+{
     long f0_id = bodyB.faces(face_id, 0);
     long f1_id = bodyB.faces(face_id, 1);
     long f2_id = bodyB.faces(face_id, 2);
@@ -351,6 +516,11 @@ bool face_vertex_ccd(
             bodyA, poseA_t0, poseA_t1, vertex_id, bodyB, poseB_t0, poseB_t1,
             face_id, toi, earliest_toi);
 
+    case TrajectoryType::CONSERVATIVE_ADVANCEMENT:
+        return compute_face_vertex_time_of_impact_conservative_advancement(
+            bodyA, poseA_t0, poseA_t1, vertex_id, bodyB, poseB_t0, poseB_t1,
+            face_id, toi, earliest_toi, minimum_separation_distance);
+
     default:
         throw "Invalid trajectory type";
     }
@@ -396,7 +566,8 @@ double edge_vertex_closest_point(
 
     case TrajectoryType::PIECEWISE_LINEAR:
     case TrajectoryType::RIGID:
-    case TrajectoryType::REDON: {
+    case TrajectoryType::REDON:
+    case TrajectoryType::CONSERVATIVE_ADVANCEMENT: {
         // Compute the poses at time toi
         PoseD poseA_toi = PoseD::interpolate(poseA_t0, poseA_t1, toi);
         PoseD poseB_toi = PoseD::interpolate(poseB_t0, poseB_t1, toi);
@@ -457,7 +628,8 @@ void edge_edge_closest_point(
 
     case TrajectoryType::PIECEWISE_LINEAR:
     case TrajectoryType::RIGID:
-    case TrajectoryType::REDON: {
+    case TrajectoryType::REDON:
+    case TrajectoryType::CONSERVATIVE_ADVANCEMENT: {
         // Compute the poses at time toi
         PoseD poseA_toi = PoseD::interpolate(poseA_t0, poseA_t1, toi);
         PoseD poseB_toi = PoseD::interpolate(poseB_t0, poseB_t1, toi);
@@ -522,7 +694,8 @@ void face_vertex_closest_point(
 
     case TrajectoryType::PIECEWISE_LINEAR:
     case TrajectoryType::RIGID:
-    case TrajectoryType::REDON: {
+    case TrajectoryType::REDON:
+    case TrajectoryType::CONSERVATIVE_ADVANCEMENT: {
         // Compute the poses at time toi
         PoseD poseA_toi = PoseD::interpolate(poseA_t0, poseA_t1, toi);
         PoseD poseB_toi = PoseD::interpolate(poseB_t0, poseB_t1, toi);
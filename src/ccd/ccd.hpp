@@ -41,7 +41,10 @@ enum TrajectoryType {
     RIGID,
     /// @brief Same trajectory as RIGID, but the time of impact is computed
     /// using Redon et al. [2002].
-    REDON
+    REDON,
+    /// @brief Same trajectory as RIGID, but the time of impact is computed
+    /// by conservative advancement using floating-point distances.
+    CONSERVATIVE_ADVANCEMENT
 };
 
 NLOHMANN_JSON_SERIALIZE_ENUM(
@@ -49,7 +52,8 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
     { { LINEAR, "linear" },
       { PIECEWISE_LINEAR, "piecewise_linear" },
       { RIGID, "rigid" },
-      { REDON, "redon" } });
+      { REDON, "redon" },
+      { CONSERVATIVE_ADVANCEMENT, "conservative_advancement" } });
 
 namespace CollisionType {
     static const int EDGE_VERTEX = 1;
@@ -129,6 +133,51 @@ bool face_vertex_ccd(
     double earliest_toi = 1,
     double minimum_separation_distance = 0);
 
+/// @brief Determine if an edge-vertex pair of two bodies intersects.
+bool edge_vertex_ccd(
+    const RigidBody& bodyA, // Body of the vertex
+    const PoseD& poseA_t0,  // Pose of bodyA at t=0
+    const PoseD& poseA_t1,  // Pose of bodyA at t=1
+    size_t vertex_id,       // In bodyA
+    const RigidBody& bodyB, // Body of the edge
+    const PoseD& poseB_t0,  // Pose of bodyB at t=0
+    const PoseD& poseB_t1,  // Pose of bodyB at t=1
+    size_t edge_id,         // In bodyB
+    double& toi,
+    TrajectoryType trajectory,
+    double earliest_toi = 1,
+    double minimum_separation_distance = 0);
+
+/// @brief Determine if an edge-edge pair of two bodies intersects.
+bool edge_edge_ccd(
+    const RigidBody& bodyA, // Body of the first edge
+    const PoseD& poseA_t0,  // Pose of bodyA at t=0
+    const PoseD& poseA_t1,  // Pose of bodyA at t=1
+    size_t edgeA_id,        // In bodyA
+    const RigidBody& bodyB, // Body of the second edge
+    const PoseD& poseB_t0,  // Pose of bodyB at t=0
+    const PoseD& poseB_t1,  // Pose of bodyB at t=1
+    size_t edgeB_id,        // In bodyB
+    double& toi,
+    TrajectoryType trajectory,
+    double earliest_toi = 1,
+    double minimum_separation_distance = 0);
+
+/// @brief Determine if a face-vertex pair of two bodies intersects.
+bool face_vertex_ccd(
+    const RigidBody& bodyA, // Body of the vertex
+    const PoseD& poseA_t0,  // Pose of bodyA at t=0
+    const PoseD& poseA_t1,  // Pose of bodyA at t=1
+    size_t vertex_id,       // In bodyA
+    const RigidBody& bodyB, // Body of the triangle
+    const PoseD& poseB_t0,  // Pose of bodyB at t=0
+    const PoseD& poseB_t1,  // Pose of bodyB at t=1
+    size_t face_id,         // In bodyB
+    double& toi,
+    TrajectoryType trajectory,
+    double earliest_toi = 1,
+    double minimum_separation_distance = 0);
+
 double edge_vertex_closest_point(
     const RigidBodyAssembler& bodies,
     const PosesD& poses_t0,
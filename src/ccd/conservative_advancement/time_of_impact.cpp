@@ -0,0 +1,158 @@
+// Time-of-impact computation for rigid bodies by conservative advancement.
+#include "time_of_impact.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include <ccd/rigid/motion_bound.hpp>
+#include <interval/interval.hpp>
+
+namespace ipc::rigid {
+
+// Bound on the number of advancement steps. The steps shrink with the gap
+// between the primitives, so this is only reached when they stay close for a
+// long time (e.g., sliding contact).
+static const int MAX_ADVANCEMENT_STEPS = 1000;
+
+/// @brief Advance both bodies as far as the lower bound allows until the gap
+/// between the primitives is within the tolerance.
+///
+/// The poses are interpolated linearly, so the trajectory from the poses at t
+/// to the poses at t=1 is the remainder of the original one and the lower
+/// bound of it scales by (1 - t).
+///
+/// An impact is only reported once the gap (distance minus the minimum
+/// separation) shrank to a toi_tolerance fraction of its initial value, so
+/// primitives that are close but move apart are not reported. If the steps
+/// do not reach earliest_toi or the tolerance, the last time is reported as
+/// the (conservative) time-of-impact.
+template <typename DistanceBound, typename TOIBound>
+static bool conservative_advancement(
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1,
+    DistanceBound distance_lower_bound,
+    TOIBound toi_lower_bound,
+    double& toi,
+    double earliest_toi,
+    double minimum_separation_distance,
+    double toi_tolerance)
+{
+    const auto gap = [&](const PoseD& poseA_t, const PoseD& poseB_t) {
+        return (Interval(distance_lower_bound(poseA_t, poseB_t))
+                - Interval(minimum_separation_distance))
+            .lower();
+    };
+
+    const double gap_t0 = gap(poseA_t0, poseB_t0);
+    if (gap_t0 <= 0) {
+        toi = 0;
+        return true;
+    }
+    const double gap_tolerance = toi_tolerance * gap_t0;
+
+    double t = 0;
+    for (int i = 0; i < MAX_ADVANCEMENT_STEPS; i++) {
+        const PoseD poseA_t = PoseD::interpolate(poseA_t0, poseA_t1, t);
+        const PoseD poseB_t = PoseD::interpolate(poseB_t0, poseB_t1, t);
+        if (i > 0 && gap(poseA_t, poseB_t) <= gap_tolerance) {
+            toi = t; // Always a time before the impact
+            return true;
+        }
+        const double dt = toi_lower_bound(poseA_t, poseB_t) * (1 - t);
+        if (t + dt >= earliest_toi) {
+            toi = std::numeric_limits<double>::infinity();
+            return false;
+        }
+        t += dt;
+    }
+    toi = t;
+    return true;
+}
+
+bool compute_edge_vertex_time_of_impact_conservative_advancement(
+    const RigidBody& bodyA,
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    size_t vertex_id,
+    const RigidBody& bodyB,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1,
+    size_t edge_id,
+    double& toi,
+    double earliest_toi,
+    double minimum_separation_distance,
+    double toi_tolerance)
+{
+    return conservative_advancement(
+        poseA_t0, poseA_t1, poseB_t0, poseB_t1,
+        [&](const PoseD& poseA_t, const PoseD& poseB_t) {
+            return edge_vertex_distance_lower_bound(
+                bodyA, poseA_t, vertex_id, bodyB, poseB_t, edge_id);
+        },
+        [&](const PoseD& poseA_t, const PoseD& poseB_t) {
+            return edge_vertex_toi_lower_bound(
+                bodyA, poseA_t, poseA_t1, vertex_id, bodyB, poseB_t, poseB_t1,
+                edge_id, minimum_separation_distance);
+        },
+        toi, earliest_toi, minimum_separation_distance, toi_tolerance);
+}
+
+bool compute_edge_edge_time_of_impact_conservative_advancement(
+    const RigidBody& bodyA,
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    size_t edgeA_id,
+    const RigidBody& bodyB,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1,
+    size_t edgeB_id,
+    double& toi,
+    double earliest_toi,
+    double minimum_separation_distance,
+    double toi_tolerance)
+{
+    return conservative_advancement(
+        poseA_t0, poseA_t1, poseB_t0, poseB_t1,
+        [&](const PoseD& poseA_t, const PoseD& poseB_t) {
+            return edge_edge_distance_lower_bound(
+                bodyA, poseA_t, edgeA_id, bodyB, poseB_t, edgeB_id);
+        },
+        [&](const PoseD& poseA_t, const PoseD& poseB_t) {
+            return edge_edge_toi_lower_bound(
+                bodyA, poseA_t, poseA_t1, edgeA_id, bodyB, poseB_t, poseB_t1,
+                edgeB_id, minimum_separation_distance);
+        },
+        toi, earliest_toi, minimum_separation_distance, toi_tolerance);
+}
+
+bool compute_face_vertex_time_of_impact_conservative_advancement(
+    const RigidBody& bodyA,
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    size_t vertex_id,
+    const RigidBody& bodyB,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1,
+    size_t face_id,
+    double& toi,
+    double earliest_toi,
+    double minimum_separation_distance,
+    double toi_tolerance)
+{
+    return conservative_advancement(
+        poseA_t0, poseA_t1, poseB_t0, poseB_t1,
+        [&](const PoseD& poseA_t, const PoseD& poseB_t) {
+            return face_vertex_distance_lower_bound(
+                bodyA, poseA_t, vertex_id, bodyB, poseB_t, face_id);
+        },
+        [&](const PoseD& poseA_t, const PoseD& poseB_t) {
+            return face_vertex_toi_lower_bound(
+                bodyA, poseA_t, poseA_t1, vertex_id, bodyB, poseB_t, poseB_t1,
+                face_id, minimum_separation_distance);
+        },
+        toi, earliest_toi, minimum_separation_distance, toi_tolerance);
+}
+
+} // namespace ipc::rigid
@@ -0,0 +1,340 @@
+#include "query_log.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include <logger.hpp>
+
+namespace ipc::rigid {
+
+// Records are fixed-size blocks of native-endian values after a short header.
+// The version must be bumped whenever the layout changes.
+static const char LOG_MAGIC[8] = { 'C', 'C', 'D', 'Q', 'L', 'O', 'G', '\0' };
+static const uint32_t LOG_VERSION = 1;
+
+// Queries buffered per thread before they are written to the file.
+static const size_t BUFFER_SIZE = 1024;
+
+///////////////////////////////////////////////////////////////////////////////
+// Binary serialization
+
+template <typename T> static void write_pod(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T> static bool read_pod(std::istream& in, T& value)
+{
+    return bool(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+static void write_pose(std::ostream& out, const PoseD& pose)
+{
+    // Padded to the 3D layout so all records have the same size
+    Eigen::Vector3d position = Eigen::Vector3d::Zero();
+    Eigen::Vector3d rotation = Eigen::Vector3d::Zero();
+    position.head(pose.position.size()) = pose.position;
+    rotation.head(pose.rotation.size()) = pose.rotation;
+    for (int i = 0; i < 3; i++) {
+        write_pod(out, position[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        write_pod(out, rotation[i]);
+    }
+}
+
+static bool read_pose(std::istream& in, int dim, PoseD& pose)
+{
+    Eigen::Vector3d position, rotation;
+    for (int i = 0; i < 3; i++) {
+        read_pod(in, position[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        read_pod(in, rotation[i]);
+    }
+    pose.position = position.head(PoseD::dim_to_pos_ndof(dim));
+    pose.rotation = rotation.head(PoseD::dim_to_rot_ndof(dim));
+    return bool(in);
+}
+
+static void write_query(std::ostream& out, const CCDQuery& query)
+{
+    write_pod(out, uint8_t(query.type));
+    write_pod(out, uint8_t(query.trajectory));
+    write_pod(out, uint8_t(query.dim));
+    write_pod(out, uint8_t(query.is_impacting));
+    for (const Eigen::Vector3d& vertex : query.vertices) {
+        for (int i = 0; i < 3; i++) {
+            write_pod(out, vertex[i]);
+        }
+    }
+    write_pose(out, query.poseA_t0);
+    write_pose(out, query.poseA_t1);
+    write_pose(out, query.poseB_t0);
+    write_pose(out, query.poseB_t1);
+    write_pod(out, query.earliest_toi);
+    write_pod(out, query.minimum_separation_distance);
+    write_pod(out, query.toi);
+    write_pod(out, query.seconds);
+}
+
+static bool read_query(std::istream& in, CCDQuery& query)
+{
+    uint8_t type, trajectory, dim, is_impacting;
+    if (!read_pod(in, type)) {
+        return false; // End of the log
+    }
+    read_pod(in, trajectory);
+    read_pod(in, dim);
+    read_pod(in, is_impacting);
+    query.type = type;
+    query.trajectory = TrajectoryType(trajectory);
+    query.dim = dim;
+    query.is_impacting = is_impacting;
+    for (Eigen::Vector3d& vertex : query.vertices) {
+        for (int i = 0; i < 3; i++) {
+            read_pod(in, vertex[i]);
+        }
+    }
+    read_pose(in, dim, query.poseA_t0);
+    read_pose(in, dim, query.poseA_t1);
+    read_pose(in, dim, query.poseB_t0);
+    read_pose(in, dim, query.poseB_t1);
+    read_pod(in, query.earliest_toi);
+    read_pod(in, query.minimum_separation_distance);
+    read_pod(in, query.toi);
+    return read_pod(in, query.seconds);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sampling
+
+// Mix the bits of a value into a hash (finalizer of SplitMix64).
+static uint64_t hash_bits(uint64_t seed, uint64_t bits)
+{
+    uint64_t z = seed ^ (bits + 0x9e3779b97f4a7c15ULL + (seed << 6));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t hash_pose(uint64_t seed, const PoseD& pose)
+{
+    const VectorMax6d dof = pose.dof();
+    for (int i = 0; i < dof.size(); i++) {
+        uint64_t bits;
+        std::memcpy(&bits, &dof[i], sizeof(bits));
+        seed = hash_bits(seed, bits);
+    }
+    return seed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CCDQuery
+
+RigidBody CCDQuery::body(int i) const
+{
+    assert(i == 0 || i == 1);
+    const int num_vertices = i == 0 ? num_vertices_A() : num_vertices_B();
+    const int offset = i == 0 ? 0 : num_vertices_A();
+
+    // The poses are relative to the frame of the whole body, so the primitive
+    // is used as is instead of being moved to its principal frame. Its mass
+    // properties are not needed to replay the query (and are degenerate for a
+    // single vertex).
+    RigidBodyAsset asset;
+    asset.vertices.resize(num_vertices, dim);
+    for (int vi = 0; vi < num_vertices; vi++) {
+        asset.vertices.row(vi) = vertices[offset + vi].head(dim);
+    }
+    if (num_vertices == 2) {
+        asset.edges.resize(1, 2);
+        asset.edges.row(0) << 0, 1;
+    } else if (num_vertices == 3) {
+        asset.edges.resize(3, 2);
+        asset.edges.row(0) << 0, 1;
+        asset.edges.row(1) << 1, 2;
+        asset.edges.row(2) << 2, 0;
+        asset.faces.resize(1, 3);
+        asset.faces.row(0) << 0, 1, 2;
+    }
+    asset.mesh_selector = MeshSelector(num_vertices, asset.edges, asset.faces);
+
+    const int rot_ndof = PoseD::dim_to_rot_ndof(dim);
+    asset.center_of_mass = VectorMax3d::Zero(dim);
+    asset.R0 = MatrixMax3d::Identity(rot_ndof, rot_ndof);
+    asset.mass = 1;
+    asset.moment_of_inertia = VectorMax3d::Ones(rot_ndof);
+
+    asset.r_max = asset.vertices.rowwise().norm().maxCoeff();
+    asset.local_box_min = asset.vertices.colwise().minCoeff();
+    asset.local_box_max = asset.vertices.colwise().maxCoeff();
+    asset.average_edge_length = 0;
+    for (long ei = 0; ei < asset.edges.rows(); ei++) {
+        asset.average_edge_length +=
+            (asset.vertices.row(asset.edges(ei, 0))
+             - asset.vertices.row(asset.edges(ei, 1)))
+                .norm();
+    }
+    if (asset.edges.rows() > 0) {
+        asset.average_edge_length /= asset.edges.rows();
+    }
+
+    return RigidBody(
+        asset, /*pose=*/PoseD::Zero(dim),
+        /*velocity=*/PoseD::Zero(dim),
+        /*force=*/PoseD::Zero(dim),
+        /*is_dof_fixed=*/VectorMax6b::Zero(PoseD::dim_to_ndof(dim)),
+        /*oriented=*/false,
+        /*group_id=*/i);
+}
+
+bool CCDQuery::run(
+    const RigidBody& bodyA,
+    const RigidBody& bodyB,
+    TrajectoryType trajectory,
+    double& toi) const
+{
+    switch (type) {
+    case CollisionType::EDGE_VERTEX:
+        return edge_vertex_ccd(
+            bodyA, poseA_t0, poseA_t1, /*vertex_id=*/0, bodyB, poseB_t0,
+            poseB_t1, /*edge_id=*/0, toi, trajectory, earliest_toi,
+            minimum_separation_distance);
+    case CollisionType::EDGE_EDGE:
+        return edge_edge_ccd(
+            bodyA, poseA_t0, poseA_t1, /*edgeA_id=*/0, bodyB, poseB_t0,
+            poseB_t1, /*edgeB_id=*/0, toi, trajectory, earliest_toi,
+            minimum_separation_distance);
+    case CollisionType::FACE_VERTEX:
+        return face_vertex_ccd(
+            bodyA, poseA_t0, poseA_t1, /*vertex_id=*/0, bodyB, poseB_t0,
+            poseB_t1, /*face_id=*/0, toi, trajectory, earliest_toi,
+            minimum_separation_distance);
+    default:
+        throw "Invalid collision type";
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CCDQueryLog
+
+bool CCDQueryLog::open(const std::string& path, double sample_rate)
+{
+    close();
+    if (sample_rate <= 0 || sample_rate > 1) {
+        spdlog::error(
+            "Invalid CCD query sample rate {:g} (must be in (0, 1])!",
+            sample_rate);
+        return false;
+    }
+
+    std::scoped_lock lock(m_file_mutex);
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        spdlog::error("Unable to open CCD query log: {}", path);
+        return false;
+    }
+    m_file.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+    write_pod(m_file, LOG_VERSION);
+
+    m_sample_rate = sample_rate;
+    m_is_open = true;
+    spdlog::info(
+        "Logging {:g}% of the CCD queries to {}", 100 * sample_rate, path);
+    return true;
+}
+
+void CCDQueryLog::close()
+{
+    if (!m_is_open) {
+        return;
+    }
+    m_is_open = false;
+    for (std::vector<CCDQuery>& buffer : m_buffers) {
+        write(buffer);
+        buffer.clear();
+    }
+    std::scoped_lock lock(m_file_mutex);
+    m_file.close();
+}
+
+bool CCDQueryLog::sample(
+    int type,
+    long primitiveA_id,
+    long primitiveB_id,
+    const PoseD& poseA_t0,
+    const PoseD& poseA_t1,
+    const PoseD& poseB_t0,
+    const PoseD& poseB_t1) const
+{
+    if (!m_is_open) {
+        return false;
+    }
+    if (m_sample_rate >= 1) {
+        return true;
+    }
+    uint64_t hash = hash_bits(uint64_t(type), uint64_t(primitiveA_id));
+    hash = hash_bits(hash, uint64_t(primitiveB_id));
+    hash = hash_pose(hash, poseA_t0);
+    hash = hash_pose(hash, poseA_t1);
+    hash = hash_pose(hash, poseB_t0);
+    hash = hash_pose(hash, poseB_t1);
+    // Record the query if the hash lies in the first sample_rate of its range
+    return hash < uint64_t(std::ldexp(m_sample_rate, 64));
+}
+
+void CCDQueryLog::append(const CCDQuery& query)
+{
+    std::vector<CCDQuery>& buffer = m_buffers.local();
+    buffer.push_back(query);
+    if (buffer.size() >= BUFFER_SIZE) {
+        write(buffer);
+        buffer.clear();
+    }
+}
+
+void CCDQueryLog::write(const std::vector<CCDQuery>& queries)
+{
+    std::scoped_lock lock(m_file_mutex);
+    for (const CCDQuery& query : queries) {
+        write_query(m_file, query);
+    }
+}
+
+bool CCDQueryLog::read(const std::string& path, std::vector<CCDQuery>& queries)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        spdlog::error("Unable to open CCD query log: {}", path);
+        return false;
+    }
+    char magic[sizeof(LOG_MAGIC)];
+    uint32_t version;
+    if (!in.read(magic, sizeof(magic)) || !read_pod(in, version)
+        || std::memcmp(magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        spdlog::error("Invalid CCD query log: {}", path);
+        return false;
+    }
+    if (version != LOG_VERSION) {
+        spdlog::error(
+            "Unsupported CCD query log version {:d} (expected {:d})", version,
+            LOG_VERSION);
+        return false;
+    }
+
+    queries.clear();
+    CCDQuery query;
+    while (read_query(in, query)) {
+        queries.push_back(query);
+    }
+    return true;
+}
+
+CCDQueryLog& ccd_query_log()
+{
+    static CCDQueryLog log;
+    return log;
+}
+
+} // namespace ipc::rigid
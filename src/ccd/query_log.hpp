@@ -0,0 +1,123 @@
+// Binary log of narrow-phase CCD queries for offline replay.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <ccd/ccd.hpp>
+#include <physics/rigid_body.hpp>
+
+namespace ipc::rigid {
+
+/// @brief A single narrow-phase CCD query with its inputs and result.
+///
+/// Body A holds the vertex (edge-vertex and face-vertex) or the first edge
+/// (edge-edge) and body B the edge, second edge, or face. The vertices are
+/// stored in body coordinates, so the query can be re-run without the rest
+/// of the scene.
+struct CCDQuery {
+    int type;                  ///< One of CollisionType
+    TrajectoryType trajectory; ///< Trajectory type the query was run with
+    int dim;
+
+    /// @brief Vertices of the primitive of body A followed by those of body B.
+    std::array<Eigen::Vector3d, 4> vertices;
+    PoseD poseA_t0, poseA_t1, poseB_t0, poseB_t1;
+
+    double earliest_toi;
+    double minimum_separation_distance;
+
+    bool is_impacting; ///< Result of the query
+    double toi;        ///< Time of impact (∞ if not impacting)
+    double seconds;    ///< Time spent in the query
+
+    /// @brief Number of vertices of the primitive of body A.
+    int num_vertices_A() const
+    {
+        return type == CollisionType::EDGE_EDGE ? 2 : 1;
+    }
+    /// @brief Number of vertices of the primitive of body B.
+    int num_vertices_B() const
+    {
+        return type == CollisionType::FACE_VERTEX ? 3 : 2;
+    }
+
+    /// @brief Rebuild body A (i = 0) or body B (i = 1) from the primitive.
+    /// @note The body has placeholder mass properties.
+    RigidBody body(int i) const;
+
+    /// @brief Re-run the query with the given trajectory type.
+    /// @param bodyA Body A as returned by body(0).
+    /// @param bodyB Body B as returned by body(1).
+    bool run(
+        const RigidBody& bodyA,
+        const RigidBody& bodyB,
+        TrajectoryType trajectory,
+        double& toi) const;
+
+    bool run(TrajectoryType trajectory, double& toi) const
+    {
+        return run(body(0), body(1), trajectory, toi);
+    }
+};
+
+/// @brief Thread-safe writer of a binary CCD query log.
+///
+/// Records are buffered per thread and written in blocks, so logging does
+/// not serialize the narrow-phase.
+class CCDQueryLog {
+public:
+    ~CCDQueryLog() { close(); }
+
+    /// @brief Start logging to the given file.
+    /// @param path Output file (overwritten).
+    /// @param sample_rate Fraction of the queries to record in (0, 1].
+    bool open(const std::string& path, double sample_rate = 1);
+
+    /// @brief Write all buffered records and stop logging.
+    void close();
+
+    bool is_open() const { return m_is_open; }
+
+    /// @brief Decide if a query should be recorded.
+    ///
+    /// The decision is a hash of the query's primitives and poses, so the
+    /// same queries are recorded regardless of the thread scheduling.
+    /// @param type One of CollisionType
+    /// @param primitiveA_id Global id of the vertex or first edge
+    /// @param primitiveB_id Global id of the edge, second edge, or face
+    bool sample(
+        int type,
+        long primitiveA_id,
+        long primitiveB_id,
+        const PoseD& poseA_t0,
+        const PoseD& poseA_t1,
+        const PoseD& poseB_t0,
+        const PoseD& poseB_t1) const;
+
+    void append(const CCDQuery& query);
+
+    /// @brief Read all queries of a log file.
+    static bool read(const std::string& path, std::vector<CCDQuery>& queries);
+
+protected:
+    void write(const std::vector<CCDQuery>& queries);
+
+    std::atomic<bool> m_is_open { false };
+    double m_sample_rate = 1;
+
+    std::mutex m_file_mutex;
+    std::ofstream m_file;
+    tbb::enumerable_thread_specific<std::vector<CCDQuery>> m_buffers;
+};
+
+/// @brief Log the narrow-phase queries of the simulation are recorded in.
+CCDQueryLog& ccd_query_log();
+
+} // namespace ipc::rigid
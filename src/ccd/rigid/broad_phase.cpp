@@ -1,6 +1,16 @@
 #include "broad_phase.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <tuple>
+
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
 
 #include <ccd/linear/broad_phase.hpp>
 #include <ccd/rigid/rigid_body_bvh.hpp>
@@ -11,6 +21,134 @@
 
 namespace ipc::rigid {
 
+// Tasks of the body-pair broad phase per thread. More tasks than threads
+// leaves room to balance the error of the cost estimates.
+static const size_t BROAD_PHASE_TASKS_PER_THREAD = 8;
+
+/// @brief Find the candidates of the given body pairs with their BVHs.
+///
+/// The cost of a body pair grows with the size of its bodies, so a pair of
+/// large bodies can take longer than all other pairs together. Pairs are
+/// split over subtrees of the larger body's BVH until no task costs more
+/// than a fraction of the total, and the tasks are run longest-first.
+template <typename T>
+static void detect_body_pairs_collision_candidates_bvh(
+    const RigidBodyAssembler& bodies,
+    const Poses<T>& poses,
+    const std::vector<std::pair<int, int>>& body_pairs,
+    const int collision_types,
+    Candidates& candidates,
+    const double inflation_radius)
+{
+    PROFILE_POINT("detect_body_pairs_collision_candidates_bvh");
+    PROFILE_START();
+
+    // The smaller body of each pair is moved into the larger one's space and
+    // its BVH refit. The refit is shared by all tasks of the pair, so it is
+    // computed by the first task to run and released by the last one to
+    // finish. Only the refits of the pairs in flight are kept in memory.
+    struct BodyPair {
+        int bodyA_id, bodyB_id;
+        double cost;
+        std::once_flag is_refit;
+        std::atomic<size_t> num_unfinished_tasks { 0 };
+        std::vector<AABB> vertex_aabbs;
+        std::vector<PrimitiveBVH::Box> node_boxes;
+    };
+    std::vector<BodyPair> pairs(body_pairs.size());
+    tbb::parallel_for(size_t(0), body_pairs.size(), [&](size_t i) {
+        BodyPair& pair = pairs[i];
+        pair.bodyA_id = body_pairs[i].first;
+        pair.bodyB_id = body_pairs[i].second;
+        sort_body_pair(bodies, pair.bodyA_id, pair.bodyB_id);
+        pair.cost = body_pair_cost(bodies, pair.bodyA_id, pair.bodyB_id);
+    });
+
+    // Split the pairs costing more than a task
+    double total_cost = 0;
+    for (const BodyPair& pair : pairs) {
+        total_cost += pair.cost;
+    }
+    const double task_cost = total_cost
+        / (BROAD_PHASE_TASKS_PER_THREAD
+           * tbb::this_task_arena::max_concurrency());
+
+    struct Task {
+        size_t pair;
+        int bodyB_root;
+        double cost;
+    };
+    std::vector<Task> tasks;
+    tasks.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); i++) {
+        size_t num_subtasks = size_t(std::ceil(pairs[i].cost / task_cost));
+        if (num_subtasks <= 1) {
+            tasks.push_back({ i, /*bodyB_root=*/0, pairs[i].cost });
+            pairs[i].num_unfinished_tasks = 1;
+            continue;
+        }
+        std::vector<int> roots =
+            bodies[pairs[i].bodyB_id].bvh.subtrees(num_subtasks);
+        for (int root : roots) {
+            tasks.push_back({ i, root, pairs[i].cost / roots.size() });
+        }
+        pairs[i].num_unfinished_tasks = roots.size();
+    }
+
+    // Longest-first, with the cheap tasks grouped into chunks of about one
+    // task's cost
+    std::stable_sort(
+        tasks.begin(), tasks.end(),
+        [](const Task& a, const Task& b) { return a.cost > b.cost; });
+    std::vector<size_t> chunk_starts;
+    double chunk_cost = task_cost;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (chunk_cost >= task_cost) {
+            chunk_starts.push_back(i);
+            chunk_cost = 0;
+        }
+        chunk_cost += tasks[i].cost;
+    }
+    chunk_starts.push_back(tasks.size());
+
+    ThreadSpecificCandidates storages;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(size_t(0), chunk_starts.size() - 1, 1),
+        [&](const tbb::blocked_range<size_t>& range) {
+            ThreadSpecificCandidates::reference local_storage_candidates =
+                storages.local();
+            for (size_t ci = range.begin(); ci != range.end(); ++ci) {
+                for (size_t ti = chunk_starts[ci]; ti < chunk_starts[ci + 1];
+                     ti++) {
+                    BodyPair& pair = pairs[tasks[ti].pair];
+                    std::call_once(pair.is_refit, [&] {
+                        int bodyA_id = pair.bodyA_id, bodyB_id = pair.bodyB_id;
+                        pair.vertex_aabbs = body_pair_vertex_aabbs(
+                            bodies, poses, bodyA_id, bodyB_id,
+                            inflation_radius);
+                        pair.node_boxes = refit_body_bvh(
+                            bodies[bodyA_id], pair.vertex_aabbs,
+                            inflation_radius);
+                    });
+                    detect_body_pair_collision_candidates_from_aabbs(
+                        bodies, pair.vertex_aabbs, pair.node_boxes,
+                        pair.bodyA_id, pair.bodyB_id, tasks[ti].bodyB_root,
+                        collision_types, local_storage_candidates,
+                        inflation_radius);
+                    if (--pair.num_unfinished_tasks == 0) {
+                        pair.vertex_aabbs = std::vector<AABB>();
+                        pair.node_boxes = std::vector<PrimitiveBVH::Box>();
+                    }
+                }
+            }
+        },
+        tbb::simple_partitioner());
+
+    merge_local_candidates(storages, candidates);
+
+    PROFILE_END();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Broad-Phase Discrete Collision Detection
 // NOTE: Yes, this is inside the CCD directory.
@@ -34,8 +172,8 @@ void detect_collision_candidates_rigid(
     switch (method) {
     case BRUTE_FORCE:
         detect_collision_candidates_brute_force(
-            bodies.world_vertices(poses), bodies.m_edges, bodies.m_faces,
-            bodies.group_ids(), collision_types, candidates);
+            bodies.world_vertices_buffered(poses), bodies.m_edges,
+            bodies.m_faces, bodies.group_ids(), collision_types, candidates);
         break;
     case HASH_GRID:
         detect_collision_candidates_rigid_hash_grid(
@@ -106,21 +244,9 @@ void detect_collision_candidates_rigid_bvh(
     // Use interval arithmetic to conservativly capture all distance candidates
     auto posesI = cast<Interval>(poses);
 
-    ThreadSpecificCandidates storages;
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(size_t(0), body_pairs.size()),
-        [&](const tbb::blocked_range<size_t>& range) {
-            ThreadSpecificCandidates::reference local_storage_candidates =
-                storages.local();
-            for (long i = range.begin(); i != range.end(); ++i) {
-                detect_body_pair_collision_candidates_bvh(
-                    bodies, posesI, body_pairs[i].first, body_pairs[i].second,
-                    collision_types, local_storage_candidates,
-                    inflation_radius);
-            }
-        });
-
-    merge_local_candidates(storages, candidates);
+    detect_body_pairs_collision_candidates_bvh(
+        bodies, posesI, body_pairs, collision_types, candidates,
+        inflation_radius);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -146,8 +272,8 @@ void detect_collision_candidates_rigid(
     switch (method) {
     case BRUTE_FORCE:
         detect_collision_candidates_brute_force(
-            bodies.world_vertices(poses_t0), bodies.m_edges, bodies.m_faces,
-            bodies.group_ids(), collision_types, candidates);
+            bodies.world_vertices_buffered(poses_t0), bodies.m_edges,
+            bodies.m_faces, bodies.group_ids(), collision_types, candidates);
         break;
     case HASH_GRID:
         detect_collision_candidates_rigid_hash_grid(
@@ -226,21 +352,9 @@ void detect_collision_candidates_rigid_bvh(
     Poses<Interval> poses = interpolate(
         cast<Interval>(poses_t0), cast<Interval>(poses_t1), Interval(0, 1));
 
-    ThreadSpecificCandidates storages;
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(size_t(0), body_pairs.size()),
-        [&](const tbb::blocked_range<size_t>& range) {
-            ThreadSpecificCandidates::reference local_storage_candidates =
-                storages.local();
-            for (long i = range.begin(); i != range.end(); ++i) {
-                detect_body_pair_collision_candidates_bvh(
-                    bodies, poses, body_pairs[i].first, body_pairs[i].second,
-                    collision_types, local_storage_candidates,
-                    inflation_radius);
-            }
-        });
-
-    merge_local_candidates(storages, candidates);
+    detect_body_pairs_collision_candidates_bvh(
+        bodies, poses, body_pairs, collision_types, candidates,
+        inflation_radius);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -280,8 +394,6 @@ void detect_intersection_candidates_rigid_bvh(
     std::vector<std::pair<int, int>> body_pairs =
         bodies.close_bodies(poses, poses, /*inflation_radius=*/0);
 
-    auto posesI = cast<Interval>(poses);
-
     ThreadSpecificEFCandidates storages;
     tbb::parallel_for(
         tbb::blocked_range<size_t>(size_t(0), body_pairs.size()),
@@ -291,18 +403,8 @@ void detect_intersection_candidates_rigid_bvh(
             for (long i = range.begin(); i != range.end(); ++i) {
                 int bodyA_id = body_pairs[i].first;
                 int bodyB_id = body_pairs[i].second;
-                sort_body_pair(bodies, bodyA_id, bodyB_id);
-
-                const auto RA = poses[bodyA_id].construct_rotation_matrix();
-                const auto RB = poses[bodyB_id].construct_rotation_matrix();
-                const auto& pA = poses[bodyA_id].position;
-                const auto& pB = poses[bodyB_id].position;
-                const MatrixXI VA =
-                    ((bodies[bodyA_id].vertices * RA.transpose()).rowwise()
-                     + (pA - pB).transpose())
-                    * RB;
-
-                std::vector<AABB> aabbs = vertex_aabbs(VA);
+                std::vector<AABB> aabbs =
+                    body_pair_vertex_aabbs(bodies, poses, bodyA_id, bodyB_id);
 
                 detect_body_pair_intersection_candidates_from_aabbs(
                     bodies, aabbs, bodyA_id, bodyB_id,
@@ -313,6 +415,70 @@ void detect_intersection_candidates_rigid_bvh(
     merge_local_candidates(storages, ef_candidates);
 }
 
+// Number of candidates of a body pair tested together in parallel.
+static const size_t INTERSECTION_TEST_CHUNK_SIZE = 256;
+
+bool find_intersection_rigid_bvh(
+    const RigidBodyAssembler& bodies,
+    const PosesD& poses,
+    const std::vector<std::pair<int, int>>& body_pairs,
+    const std::function<bool(const EdgeFaceCandidate&)>& is_intersecting)
+{
+    std::atomic<bool> is_found { false };
+    tbb::task_group_context context;
+
+    // Test a chunk of candidates in parallel, cancelling all work on a hit
+    auto test_chunk = [&](const std::vector<EdgeFaceCandidate>& chunk) {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(size_t(0), chunk.size()),
+            [&](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    if (is_found) {
+                        return;
+                    }
+                    if (is_intersecting(chunk[i])) {
+                        is_found = true;
+                        context.cancel_group_execution();
+                        return;
+                    }
+                }
+            });
+    };
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(size_t(0), body_pairs.size()),
+        [&](const tbb::blocked_range<size_t>& range) {
+            // The candidates are streamed from the traversal, so only a
+            // chunk of them is stored at a time.
+            std::vector<EdgeFaceCandidate> chunk;
+            chunk.reserve(INTERSECTION_TEST_CHUNK_SIZE);
+            for (size_t i = range.begin(); i != range.end() && !is_found;
+                 ++i) {
+                int bodyA_id = body_pairs[i].first;
+                int bodyB_id = body_pairs[i].second;
+                std::vector<AABB> aabbs =
+                    body_pair_vertex_aabbs(bodies, poses, bodyA_id, bodyB_id);
+
+                detect_body_pair_intersection_candidates_from_aabbs(
+                    bodies, aabbs, bodyA_id, bodyB_id,
+                    [&](const EdgeFaceCandidate& ef_candidate) {
+                        chunk.push_back(ef_candidate);
+                        if (chunk.size() >= INTERSECTION_TEST_CHUNK_SIZE) {
+                            test_chunk(chunk);
+                            chunk.clear();
+                        }
+                        return !is_found;
+                    });
+            }
+            if (!is_found) {
+                test_chunk(chunk);
+            }
+        },
+        context);
+
+    return is_found;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Helper functions
 ///////////////////////////////////////////////////////////////////////////////
@@ -350,4 +516,30 @@ void merge_local_candidates(
     PROFILE_END();
 }
 
+void sort_candidates(Candidates& candidates)
+{
+    PROFILE_POINT("sort_candidates");
+    PROFILE_START();
+    // Lexicographic in the ids (not symmetric), so the order is total
+    tbb::parallel_sort(
+        candidates.ev_candidates.begin(), candidates.ev_candidates.end(),
+        [](const EdgeVertexCandidate& ev0, const EdgeVertexCandidate& ev1) {
+            return std::tie(ev0.edge_id, ev0.vertex_id)
+                < std::tie(ev1.edge_id, ev1.vertex_id);
+        });
+    tbb::parallel_sort(
+        candidates.ee_candidates.begin(), candidates.ee_candidates.end(),
+        [](const EdgeEdgeCandidate& ee0, const EdgeEdgeCandidate& ee1) {
+            return std::tie(ee0.edge0_id, ee0.edge1_id)
+                < std::tie(ee1.edge0_id, ee1.edge1_id);
+        });
+    tbb::parallel_sort(
+        candidates.fv_candidates.begin(), candidates.fv_candidates.end(),
+        [](const FaceVertexCandidate& fv0, const FaceVertexCandidate& fv1) {
+            return std::tie(fv0.face_id, fv0.vertex_id)
+                < std::tie(fv1.face_id, fv1.vertex_id);
+        });
+    PROFILE_END();
+}
+
 } // namespace ipc::rigid
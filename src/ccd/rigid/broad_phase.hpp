@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include <tbb/enumerable_thread_specific.h>
 
 #include <Eigen/Core>
@@ -88,6 +90,18 @@ void detect_intersection_candidates_rigid_bvh(
     const PosesD& poses,
     std::vector<EdgeFaceCandidate>& ef_candidates);
 
+/// @brief Use a BVH to stream the candidate intersections of the given body
+/// pairs to a test, stopping as soon as it finds an intersection.
+///
+/// The candidates are tested in parallel and never all stored at once.
+/// @param is_intersecting Exact test of an edge-face candidate.
+/// @return True if any candidate is intersecting.
+bool find_intersection_rigid_bvh(
+    const RigidBodyAssembler& bodies,
+    const PosesD& poses,
+    const std::vector<std::pair<int, int>>& body_pairs,
+    const std::function<bool(const EdgeFaceCandidate&)>& is_intersecting);
+
 ///////////////////////////////////////////////////////////////////////////////
 // Helper functions
 ///////////////////////////////////////////////////////////////////////////////
@@ -95,7 +109,14 @@ void detect_intersection_candidates_rigid_bvh(
 typedef tbb::enumerable_thread_specific<Candidates>
     ThreadSpecificCandidates;
 
+/// @brief Concatenate the thread-local candidates (in no particular order).
 void merge_local_candidates(
     const ThreadSpecificCandidates& storages, Candidates& candidates);
 
+/// @brief Sort the candidates by their primitive ids.
+///
+/// The order the threads find candidates in depends on the scheduling, so
+/// this makes everything that depends on the order reproducible.
+void sort_candidates(Candidates& candidates);
+
 } // namespace ipc::rigid
@@ -0,0 +1,342 @@
+// Rigorous bounds on the motion of rigid body primitives.
+#include "motion_bound.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <interval/interval.hpp>
+
+namespace ipc::rigid {
+
+// All bounds are evaluated in interval arithmetic (i.e., with directed
+// rounding), so they hold for the exact poses and vertices and not only for
+// their floating-point approximations.
+
+static Interval norm(const VectorMax3I& x)
+{
+    Interval squared_norm(0);
+    for (int i = 0; i < x.size(); i++) {
+        squared_norm += x(i) * x(i);
+    }
+    return sqrt(squared_norm);
+}
+
+double vertex_motion_bound(
+    const RigidBody& body,
+    const Pose<double>& pose_t0,
+    const Pose<double>& pose_t1,
+    size_t vertex_id)
+{
+    // The rotation vector is interpolated linearly and the exponential map is
+    // 1-Lipschitz, so the orientations at t and s are within an angle of
+    // |t - s|‖Δθ‖, and a vertex at distance r from the CM moves at most
+    // |t - s|‖Δθ‖ r due to the rotation.
+    const VectorMax3I dp = pose_t1.position.cast<Interval>()
+        - pose_t0.position.cast<Interval>();
+    const VectorMax3I dtheta = pose_t1.rotation.cast<Interval>()
+        - pose_t0.rotation.cast<Interval>();
+    const VectorMax3I r =
+        body.vertices.row(vertex_id).transpose().cast<Interval>();
+    return (norm(dp) + norm(dtheta) * norm(r)).upper();
+}
+
+/// @brief Enclosures of the world vertices of a primitive at a pose.
+template <typename DerivedIds>
+static std::vector<VectorMax3I> interval_vertices(
+    const RigidBody& body, const Pose<double>& pose, const DerivedIds& ids)
+{
+    const PoseI poseI = pose.cast<Interval>();
+    const MatrixMax3I R = poseI.construct_rotation_matrix();
+    std::vector<VectorMax3I> V(ids.size());
+    for (int i = 0; i < ids.size(); i++) {
+        V[i] = body.world_vertex<Interval>(R, poseI.position, ids(i));
+    }
+    return V;
+}
+
+/// @brief Midpoints of the vertex enclosures.
+static std::vector<VectorMax3d> midpoints(const std::vector<VectorMax3I>& V)
+{
+    std::vector<VectorMax3d> mid(V.size());
+    for (size_t i = 0; i < V.size(); i++) {
+        mid[i].resize(V[i].size());
+        for (int j = 0; j < V[i].size(); j++) {
+            mid[i](j) = median(V[i](j));
+        }
+    }
+    return mid;
+}
+
+/// @brief Point of the segment [e0, e1] closest to p.
+static VectorMax3d closest_point_on_edge(
+    const VectorMax3d& p, const VectorMax3d& e0, const VectorMax3d& e1)
+{
+    const VectorMax3d e = e1 - e0;
+    const double e_sqr = e.squaredNorm();
+    const double t =
+        e_sqr > 0 ? std::clamp((p - e0).dot(e) / e_sqr, 0.0, 1.0) : 0.0;
+    return e0 + t * e;
+}
+
+/// @brief Lower bound on the distance between the convex hulls of A and B.
+///
+/// For any direction n, every a ∈ conv(A) and b ∈ conv(B) satisfy
+/// ‖b - a‖ ≥ (minⱼ n·bⱼ - maxᵢ n·aᵢ) / ‖n‖. The bound is tight when n is the
+/// difference of the closest points, which is only used as a hint.
+static double separation_lower_bound(
+    const std::vector<VectorMax3I>& A,
+    const std::vector<VectorMax3I>& B,
+    const VectorMax3d& n)
+{
+    const VectorMax3I nI = n.cast<Interval>();
+    const auto dot = [&](const VectorMax3I& x) {
+        Interval d(0);
+        for (int i = 0; i < x.size(); i++) {
+            d += nI(i) * x(i);
+        }
+        return d;
+    };
+
+    double max_a = -std::numeric_limits<double>::infinity();
+    for (const VectorMax3I& a : A) {
+        max_a = std::max(max_a, dot(a).upper());
+    }
+    double min_b = std::numeric_limits<double>::infinity();
+    for (const VectorMax3I& b : B) {
+        min_b = std::min(min_b, dot(b).lower());
+    }
+
+    const double gap = (Interval(min_b) - Interval(max_a)).lower();
+    if (!(gap > 0)) {
+        return 0; // Touching, or n is not a separating direction
+    }
+    return (Interval(gap) / norm(nI)).lower();
+}
+
+/// @brief Time before which two primitives at the given initial distance
+/// cannot come closer than the minimum separation if their vertices move at
+/// most t·motion_bound.
+///
+/// Every point of a primitive is a fixed convex combination of its vertices,
+/// so the distance between the primitives decreases at most as fast as the
+/// sum of the largest vertex motions.
+static double toi_lower_bound(
+    double distance_t0,
+    double minimum_separation_distance,
+    double motion_bound)
+{
+    const double gap =
+        (Interval(distance_t0) - Interval(minimum_separation_distance))
+            .lower();
+    if (!(gap > 0)) {
+        return 0;
+    }
+    if (motion_bound == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return (Interval(gap) / Interval(motion_bound)).lower();
+}
+
+template <typename DerivedIds>
+static double max_motion_bound(
+    const RigidBody& body,
+    const Pose<double>& pose_t0,
+    const Pose<double>& pose_t1,
+    const DerivedIds& vertex_ids)
+{
+    double bound = 0;
+    for (int i = 0; i < vertex_ids.size(); i++) {
+        bound = std::max(
+            bound, vertex_motion_bound(body, pose_t0, pose_t1, vertex_ids(i)));
+    }
+    return bound;
+}
+
+/// @brief Difference of the closest points of the segments [a0, a1] and
+/// [b0, b1] (from the first to the second).
+static VectorMax3d edge_edge_closest_direction(
+    const VectorMax3d& a0,
+    const VectorMax3d& a1,
+    const VectorMax3d& b0,
+    const VectorMax3d& b1)
+{
+    const VectorMax3d da = a1 - a0, db = b1 - b0, r = b0 - a0;
+    const double a = da.squaredNorm(), b = da.dot(db), c = db.squaredNorm();
+    const double d = da.dot(r), e = db.dot(r);
+    const double det = a * c - b * b;
+    if (det > 0) {
+        const double s = (c * d - b * e) / det, t = (b * d - a * e) / det;
+        if (s >= 0 && s <= 1 && t >= 0 && t <= 1) {
+            return (b0 + t * db) - (a0 + s * da);
+        }
+    }
+    // Otherwise one of the closest points is an end-point
+    std::array<VectorMax3d, 4> directions = { {
+        closest_point_on_edge(a0, b0, b1) - a0,
+        closest_point_on_edge(a1, b0, b1) - a1,
+        b0 - closest_point_on_edge(b0, a0, a1),
+        b1 - closest_point_on_edge(b1, a0, a1),
+    } };
+    return *std::min_element(
+        directions.begin(), directions.end(),
+        [](const VectorMax3d& x, const VectorMax3d& y) {
+            return x.squaredNorm() < y.squaredNorm();
+        });
+}
+
+/// @brief Difference of the closest points of p and the triangle
+/// (f0, f1, f2) (from the point to the triangle).
+static VectorMax3d face_vertex_closest_direction(
+    const VectorMax3d& p,
+    const VectorMax3d& f0,
+    const VectorMax3d& f1,
+    const VectorMax3d& f2)
+{
+    const VectorMax3d e0 = f1 - f0, e1 = f2 - f0, r = p - f0;
+    const double a = e0.squaredNorm(), b = e0.dot(e1), c = e1.squaredNorm();
+    const double d = e0.dot(r), e = e1.dot(r);
+    const double det = a * c - b * b;
+    if (det > 0) {
+        const double u = (c * d - b * e) / det, v = (a * e - b * d) / det;
+        if (u >= 0 && v >= 0 && u + v <= 1) {
+            return f0 + u * e0 + v * e1 - p;
+        }
+    }
+    // Otherwise the closest point is on one of the edges
+    std::array<VectorMax3d, 3> directions = { {
+        closest_point_on_edge(p, f0, f1) - p,
+        closest_point_on_edge(p, f1, f2) - p,
+        closest_point_on_edge(p, f2, f0) - p,
+    } };
+    return *std::min_element(
+        directions.begin(), directions.end(),
+        [](const VectorMax3d& x, const VectorMax3d& y) {
+            return x.squaredNorm() < y.squaredNorm();
+        });
+}
+
+double edge_vertex_distance_lower_bound(
+    const RigidBody& bodyA,
+    const Pose<double>& poseA,
+    size_t vertex_id,
+    const RigidBody& bodyB,
+    const Pose<double>& poseB,
+    size_t edge_id)
+{
+    const Eigen::Matrix<int, 1, 1> v(vertex_id);
+    const Eigen::Vector2i e = bodyB.edges.row(edge_id);
+    const std::vector<VectorMax3I> VA = interval_vertices(bodyA, poseA, v);
+    const std::vector<VectorMax3I> VB = interval_vertices(bodyB, poseB, e);
+    const std::vector<VectorMax3d> a = midpoints(VA), b = midpoints(VB);
+    return separation_lower_bound(
+        VA, VB, closest_point_on_edge(a[0], b[0], b[1]) - a[0]);
+}
+
+double edge_edge_distance_lower_bound(
+    const RigidBody& bodyA,
+    const Pose<double>& poseA,
+    size_t edgeA_id,
+    const RigidBody& bodyB,
+    const Pose<double>& poseB,
+    size_t edgeB_id)
+{
+    const Eigen::Vector2i ea = bodyA.edges.row(edgeA_id);
+    const Eigen::Vector2i eb = bodyB.edges.row(edgeB_id);
+    const std::vector<VectorMax3I> VA = interval_vertices(bodyA, poseA, ea);
+    const std::vector<VectorMax3I> VB = interval_vertices(bodyB, poseB, eb);
+    const std::vector<VectorMax3d> a = midpoints(VA), b = midpoints(VB);
+    return separation_lower_bound(
+        VA, VB, edge_edge_closest_direction(a[0], a[1], b[0], b[1]));
+}
+
+double face_vertex_distance_lower_bound(
+    const RigidBody& bodyA,
+    const Pose<double>& poseA,
+    size_t vertex_id,
+    const RigidBody& bodyB,
+    const Pose<double>& poseB,
+    size_t face_id)
+{
+    const Eigen::Matrix<int, 1, 1> v(vertex_id);
+    const Eigen::Vector3i f = bodyB.faces.row(face_id);
+    const std::vector<VectorMax3I> VA = interval_vertices(bodyA, poseA, v);
+    const std::vector<VectorMax3I> VB = interval_vertices(bodyB, poseB, f);
+    const std::vector<VectorMax3d> a = midpoints(VA), b = midpoints(VB);
+    return separation_lower_bound(
+        VA, VB, face_vertex_closest_direction(a[0], b[0], b[1], b[2]));
+}
+
+double edge_vertex_toi_lower_bound(
+    const RigidBody& bodyA,
+    const Pose<double>& poseA_t0,
+    const Pose<double>& poseA_t1,
+    size_t vertex_id,
+    const RigidBody& bodyB,
+    const Pose<double>& poseB_t0,
+    const Pose<double>& poseB_t1,
+    size_t edge_id,
+    double minimum_separation_distance)
+{
+    const Eigen::Vector2i e = bodyB.edges.row(edge_id);
+    const double distance_t0 = edge_vertex_distance_lower_bound(
+        bodyA, poseA_t0, vertex_id, bodyB, poseB_t0, edge_id);
+
+    const double motion_bound =
+        vertex_motion_bound(bodyA, poseA_t0, poseA_t1, vertex_id)
+        + max_motion_bound(bodyB, poseB_t0, poseB_t1, e);
+
+    return toi_lower_bound(
+        distance_t0, minimum_separation_distance, motion_bound);
+}
+
+double edge_edge_toi_lower_bound(
+    const RigidBody& bodyA,
+    const Pose<double>& poseA_t0,
+    const Pose<double>& poseA_t1,
+    size_t edgeA_id,
+    const RigidBody& bodyB,
+    const Pose<double>& poseB_t0,
+    const Pose<double>& poseB_t1,
+    size_t edgeB_id,
+    double minimum_separation_distance)
+{
+    const Eigen::Vector2i ea = bodyA.edges.row(edgeA_id);
+    const Eigen::Vector2i eb = bodyB.edges.row(edgeB_id);
+    const double distance_t0 = edge_edge_distance_lower_bound(
+        bodyA, poseA_t0, edgeA_id, bodyB, poseB_t0, edgeB_id);
+
+    const double motion_bound =
+        max_motion_bound(bodyA, poseA_t0, poseA_t1, ea)
+        + max_motion_bound(bodyB, poseB_t0, poseB_t1, eb);
+
+    return toi_lower_bound(
+        distance_t0, minimum_separation_distance, motion_bound);
+}
+
+double face_vertex_toi_lower_bound(
+    const RigidBody& bodyA,
+    const Pose<double>& poseA_t0,
+    const Pose<double>& poseA_t1,
+    size_t vertex_id,
+    const RigidBody& bodyB,
+    const Pose<double>& poseB_t0,
+    const Pose<double>& poseB_t1,
+    size_t face_id,
+    double minimum_separation_distance)
+{
+    const Eigen::Vector3i f = bodyB.faces.row(face_id);
+    const double distance_t0 = face_vertex_distance_lower_bound(
+        bodyA, poseA_t0, vertex_id, bodyB, poseB_t0, face_id);
+
+    const double motion_bound =
+        vertex_motion_bound(bodyA, poseA_t0, poseA_t1, vertex_id)
+        + max_motion_bound(bodyB, poseB_t0, poseB_t1, f);
+
+    return toi_lower_bound(
+        distance_t0, minimum_separation_distance, motion_bound);
+}
+
+} // namespace ipc::rigid
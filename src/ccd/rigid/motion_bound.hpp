@@ -0,0 +1,88 @@
+// Rigorous bounds on the motion of rigid body primitives.
+#pragma once
+
+#include <physics/rigid_body.hpp>
+
+namespace ipc::rigid {
+
+/// @brief Upper bound on the speed of a vertex along its rigid trajectory.
+///
+/// ‖v(t) - v(s)‖ ≤ |t - s| · bound for all t, s ∈ [0, 1].
+double vertex_motion_bound(
+    const RigidBody& body,
+    const Pose<double>& pose_t0, // Pose of body at t=0
+    const Pose<double>& pose_t1, // Pose of body at t=1
+    size_t vertex_id);           // In body
+
+/// @brief Lower bound on the distance between a vertex and an edge computed
+/// with directed rounding.
+double edge_vertex_distance_lower_bound(
+    const RigidBody& bodyA,    // Body of the vertex
+    const Pose<double>& poseA, // Pose of bodyA
+    size_t vertex_id,          // In bodyA
+    const RigidBody& bodyB,    // Body of the edge
+    const Pose<double>& poseB, // Pose of bodyB
+    size_t edge_id);           // In bodyB
+
+/// @brief Lower bound on the distance between two edges computed with
+/// directed rounding.
+double edge_edge_distance_lower_bound(
+    const RigidBody& bodyA,    // Body of the first edge
+    const Pose<double>& poseA, // Pose of bodyA
+    size_t edgeA_id,           // In bodyA
+    const RigidBody& bodyB,    // Body of the second edge
+    const Pose<double>& poseB, // Pose of bodyB
+    size_t edgeB_id);          // In bodyB
+
+/// @brief Lower bound on the distance between a vertex and a triangle
+/// computed with directed rounding.
+double face_vertex_distance_lower_bound(
+    const RigidBody& bodyA,    // Body of the vertex
+    const Pose<double>& poseA, // Pose of bodyA
+    size_t vertex_id,          // In bodyA
+    const RigidBody& bodyB,    // Body of the triangle
+    const Pose<double>& poseB, // Pose of bodyB
+    size_t face_id);           // In bodyB
+
+/// @brief Conservative lower bound on the time-of-impact of an edge-vertex
+/// pair computed with directed rounding.
+/// @return A time before which the primitives cannot come closer than the
+///         minimum separation distance (∞ if they do not move).
+double edge_vertex_toi_lower_bound(
+    const RigidBody& bodyA,       // Body of the vertex
+    const Pose<double>& poseA_t0, // Pose of bodyA at t=0
+    const Pose<double>& poseA_t1, // Pose of bodyA at t=1
+    size_t vertex_id,             // In bodyA
+    const RigidBody& bodyB,       // Body of the edge
+    const Pose<double>& poseB_t0, // Pose of bodyB at t=0
+    const Pose<double>& poseB_t1, // Pose of bodyB at t=1
+    size_t edge_id,               // In bodyB
+    double minimum_separation_distance = 0);
+
+/// @brief Conservative lower bound on the time-of-impact of an edge-edge
+/// pair computed with directed rounding.
+double edge_edge_toi_lower_bound(
+    const RigidBody& bodyA,       // Body of the first edge
+    const Pose<double>& poseA_t0, // Pose of bodyA at t=0
+    const Pose<double>& poseA_t1, // Pose of bodyA at t=1
+    size_t edgeA_id,              // In bodyA
+    const RigidBody& bodyB,       // Body of the second edge
+    const Pose<double>& poseB_t0, // Pose of bodyB at t=0
+    const Pose<double>& poseB_t1, // Pose of bodyB at t=1
+    size_t edgeB_id,              // In bodyB
+    double minimum_separation_distance = 0);
+
+/// @brief Conservative lower bound on the time-of-impact of a face-vertex
+/// pair computed with directed rounding.
+double face_vertex_toi_lower_bound(
+    const RigidBody& bodyA,       // Body of the vertex
+    const Pose<double>& poseA_t0, // Pose of bodyA at t=0
+    const Pose<double>& poseA_t1, // Pose of bodyA at t=1
+    size_t vertex_id,             // In bodyA
+    const RigidBody& bodyB,       // Body of the triangle
+    const Pose<double>& poseB_t0, // Pose of bodyB at t=0
+    const Pose<double>& poseB_t1, // Pose of bodyB at t=1
+    size_t face_id,               // In bodyB
+    double minimum_separation_distance = 0);
+
+} // namespace ipc::rigid
@@ -2,6 +2,46 @@
 
 namespace ipc::rigid {
 
+// The boxes are grown by inflation_radius because bodyB's BVH is not grown.
+std::vector<PrimitiveBVH::Box> refit_body_bvh(
+    const RigidBody& body,
+    const std::vector<AABB>& vertex_aabbs,
+    const double inflation_radius)
+{
+    const Eigen::MatrixXi &E = body.edges, &F = body.faces;
+    const auto& selector = body.mesh_selector;
+
+    auto to_box = [&](const AABB& aabb) {
+        PrimitiveBVH::Box box;
+        box[0].setZero();
+        box[1].setZero();
+        box[0].head(aabb.min.size()) = (aabb.min - inflation_radius).matrix();
+        box[1].head(aabb.max.size()) = (aabb.max + inflation_radius).matrix();
+        return box;
+    };
+
+    std::vector<PrimitiveBVH::Box> primitive_boxes;
+    primitive_boxes.reserve(body.bvh_size());
+    for (size_t i = 0; i < body.num_codim_vertices(); i++) {
+        size_t vi = selector.codim_vertices_to_vertices(i);
+        primitive_boxes.push_back(to_box(vertex_aabbs[vi]));
+    }
+    for (size_t i = 0; i < body.num_codim_edges(); i++) {
+        size_t ei = selector.codim_edges_to_edges(i);
+        primitive_boxes.push_back(
+            to_box(AABB(vertex_aabbs[E(ei, 0)], vertex_aabbs[E(ei, 1)])));
+    }
+    for (size_t fi = 0; fi < body.num_faces(); fi++) {
+        primitive_boxes.push_back(to_box(AABB(
+            vertex_aabbs[F(fi, 0)], vertex_aabbs[F(fi, 1)],
+            vertex_aabbs[F(fi, 2)])));
+    }
+
+    std::vector<PrimitiveBVH::Box> node_boxes;
+    body.bvh.refit(primitive_boxes, node_boxes);
+    return node_boxes;
+}
+
 void detect_body_pair_collision_candidates_from_aabbs(
     const RigidBodyAssembler& bodies,
     const std::vector<AABB>& bodyA_vertex_aabbs,
@@ -10,6 +50,24 @@ void detect_body_pair_collision_candidates_from_aabbs(
     const int collision_types,
     Candidates& candidates,
     const double inflation_radius)
+{
+    detect_body_pair_collision_candidates_from_aabbs(
+        bodies, bodyA_vertex_aabbs,
+        refit_body_bvh(bodies[bodyA_id], bodyA_vertex_aabbs, inflation_radius),
+        bodyA_id, bodyB_id, /*bodyB_root=*/0, collision_types, candidates,
+        inflation_radius);
+}
+
+void detect_body_pair_collision_candidates_from_aabbs(
+    const RigidBodyAssembler& bodies,
+    const std::vector<AABB>& bodyA_vertex_aabbs,
+    const std::vector<PrimitiveBVH::Box>& bodyA_node_boxes,
+    const int bodyA_id,
+    const int bodyB_id,
+    const int bodyB_root,
+    const int collision_types,
+    Candidates& candidates,
+    const double inflation_radius)
 {
     bool build_ev = collision_types & CollisionType::EDGE_VERTEX;
     bool build_ee = collision_types & CollisionType::EDGE_EDGE;
@@ -53,21 +111,25 @@ void detect_body_pair_collision_candidates_from_aabbs(
     const RigidBody& bodyA = bodies[bodyA_id];
     const RigidBody& bodyB = bodies[bodyB_id];
 
-    const std::vector<AABB> bodyB_vertex_aabbs =
-        vertex_aabbs(bodyB.vertices, inflation_radius);
     const Eigen::MatrixXi &EA = bodyA.edges, &EB = bodyB.edges,
                           &FA = bodyA.faces, &FB = bodyB.faces;
 
     const auto& selectorA = bodyA.mesh_selector;
     const auto& selectorB = bodyB.mesh_selector;
 
+    // bodyB is at rest in its local space, so its vertex boxes are only
+    // constructed for the primitives that are actually tested.
+    auto bodyB_vertex_aabb = [&](size_t vi) {
+        return vertex_aabb(
+            VectorMax3d(bodyB.vertices.row(vi)), inflation_radius);
+    };
+
     auto bodyA_edge_aabb = [&](size_t ei) {
         return AABB(
             bodyA_vertex_aabbs[EA(ei, 0)], bodyA_vertex_aabbs[EA(ei, 1)]);
     };
     auto bodyB_edge_aabb = [&](size_t ei) {
-        return AABB(
-            bodyB_vertex_aabbs[EB(ei, 0)], bodyB_vertex_aabbs[EB(ei, 1)]);
+        return AABB(bodyB_vertex_aabb(EB(ei, 0)), bodyB_vertex_aabb(EB(ei, 1)));
     };
     auto bodyA_face_aabb = [&](size_t fi) {
         return AABB(
@@ -76,237 +138,209 @@ void detect_body_pair_collision_candidates_from_aabbs(
     };
     auto bodyB_face_aabb = [&](size_t fi) {
         return AABB(
-            bodyB_vertex_aabbs[FB(fi, 0)], bodyB_vertex_aabbs[FB(fi, 1)],
-            bodyB_vertex_aabbs[FB(fi, 2)]);
+            bodyB_vertex_aabb(FB(fi, 0)), bodyB_vertex_aabb(FB(fi, 1)),
+            bodyB_vertex_aabb(FB(fi, 2)));
     };
 
+    const size_t num_cvA = bodyA.num_codim_vertices();
+    const size_t num_ceA = bodyA.num_codim_edges();
+    const size_t num_cvB = bodyB.num_codim_vertices();
+    const size_t num_ceB = bodyB.num_codim_edges();
+
     ///////////////////////////////////////////////////////////////////////////
     // query (f, *)
-    for (size_t fa_id = 0; fa_id < FA.rows(); fa_id++) {
+    auto query_face = [&](size_t fa_id, size_t id) {
         // all (f_e, *v) and (f_v, *e) are not needed because faces are only 3D
         assert(!build_ev);
 
         // Construct a bbox of bodyA's face
         AABB fa_aabb = bodyA_face_aabb(fa_id);
 
-        std::vector<unsigned int> ids;
-        bodyB.bvh.intersect_box(
-            // Grow the box by inflation_radius because the BVH is not grown
-            fa_aabb.min.array() - inflation_radius,
-            fa_aabb.max.array() + inflation_radius, //
-            ids);
+        if (id < num_cvB) {
 
-        for (const auto& id : ids) {
-            if (id < bodyB.num_codim_vertices()) {
+            // (f, cv) - no need to do a AABB check
+            add_fv(fa_id, selectorB.codim_vertices_to_vertices(id));
+            // ignore (f_e, cv) and (f_v, cv)
 
-                // (f, cv) - no need to do a AABB check
-                add_fv(fa_id, selectorB.codim_vertices_to_vertices(id));
-                // ignore (f_e, cv) and (f_v, cv)
+        } else if (id < num_cvB + num_ceB) {
 
-            } else if (
-                id < bodyB.num_codim_vertices() + bodyB.num_codim_edges()) {
+            size_t eb_id = selectorB.codim_edges_to_edges(id - num_cvB);
 
-                size_t eb_id = selectorB.codim_edges_to_edges(
-                    id - bodyB.num_codim_vertices());
-
-                // (f, ce_v)
-                for (int vi = 0; vi < EB.cols(); vi++) {
-                    size_t vb_id = EB(eb_id, vi);
-                    if (selectorB.vertex_to_edge(vb_id) == eb_id
-                        && fa_aabb.intersects(bodyB_vertex_aabbs[vb_id])) {
-                        add_fv(fa_id, vb_id);
-                    }
+            // (f, ce_v)
+            for (int vi = 0; vi < EB.cols(); vi++) {
+                size_t vb_id = EB(eb_id, vi);
+                if (selectorB.vertex_to_edge(vb_id) == eb_id
+                    && fa_aabb.intersects(bodyB_vertex_aabb(vb_id))) {
+                    add_fv(fa_id, vb_id);
                 }
+            }
 
-                // (f_e, ce)
-                AABB eb_aabb = bodyB_edge_aabb(eb_id);
-                for (int ei = 0; ei < FA.cols(); ei++) {
-                    size_t ea_id = selectorA.face_to_edge(fa_id, ei);
-                    if (selectorA.edge_to_face(ea_id) == fa_id) {
-                        AABB ea_aabb = bodyA_edge_aabb(ea_id);
-                        if (ea_aabb.intersects(ea_aabb)) {
-                            add_ee(ea_id, eb_id);
-                        }
+            // (f_e, ce)
+            AABB eb_aabb = bodyB_edge_aabb(eb_id);
+            for (int ei = 0; ei < FA.cols(); ei++) {
+                size_t ea_id = selectorA.face_to_edge(fa_id, ei);
+                if (selectorA.edge_to_face(ea_id) == fa_id) {
+                    AABB ea_aabb = bodyA_edge_aabb(ea_id);
+                    if (ea_aabb.intersects(eb_aabb)) {
+                        add_ee(ea_id, eb_id);
                     }
                 }
+            }
 
-                // ignore (f, ce), (f_v, ce), (f_v, ce_v), and (f_e, ce_v)
+            // ignore (f, ce), (f_v, ce), (f_v, ce_v), and (f_e, ce_v)
 
-            } else {
+        } else {
+
+            size_t fb_id = id - num_cvB - num_ceB;
 
-                size_t fb_id =
-                    id - bodyB.num_codim_vertices() - bodyB.num_codim_edges();
-
-                AABB fb_aabb = bodyB_face_aabb(fb_id);
-                for (int f_vi = 0; f_vi < FA.cols(); f_vi++) {
-                    // (f_v, f)
-                    long va_id = FA(fa_id, f_vi);
-                    if (selectorA.vertex_to_face(va_id) == fa_id) {
-                        if (bodyA_vertex_aabbs[va_id] .intersects(fb_aabb)) {
-                            // Convert the local ids to the global ones
-                            add_vf(va_id, fb_id);
-                        }
+            AABB fb_aabb = bodyB_face_aabb(fb_id);
+            for (int f_vi = 0; f_vi < FA.cols(); f_vi++) {
+                // (f_v, f)
+                long va_id = FA(fa_id, f_vi);
+                if (selectorA.vertex_to_face(va_id) == fa_id) {
+                    if (bodyA_vertex_aabbs[va_id].intersects(fb_aabb)) {
+                        // Convert the local ids to the global ones
+                        add_vf(va_id, fb_id);
                     }
+                }
 
-                    // (f, f_v)
-                    long vb_id = FB(fb_id, f_vi);
-                    if (selectorB.vertex_to_face(vb_id) == fb_id) {
-                        if (fa_aabb.intersects(bodyB_vertex_aabbs[vb_id])) {
-                            // Convert the local ids to the global ones
-                            add_fv(fa_id, vb_id);
-                        }
+                // (f, f_v)
+                long vb_id = FB(fb_id, f_vi);
+                if (selectorB.vertex_to_face(vb_id) == fb_id) {
+                    if (fa_aabb.intersects(bodyB_vertex_aabb(vb_id))) {
+                        // Convert the local ids to the global ones
+                        add_fv(fa_id, vb_id);
                     }
                 }
+            }
 
-                for (int fa_ei = 0; fa_ei < FA.cols(); fa_ei++) {
-                    long ea_id = selectorA.face_to_edge(fa_id, fa_ei);
+            for (int fa_ei = 0; fa_ei < FA.cols(); fa_ei++) {
+                long ea_id = selectorA.face_to_edge(fa_id, fa_ei);
 
-                    if (selectorA.edge_to_face(ea_id) != fa_id) {
-                        continue;
-                    }
+                if (selectorA.edge_to_face(ea_id) != fa_id) {
+                    continue;
+                }
 
-                    AABB ea_aabb = bodyA_edge_aabb(ea_id);
+                AABB ea_aabb = bodyA_edge_aabb(ea_id);
 
-                    for (int fb_ei = 0; fb_ei < FB.cols(); fb_ei++) {
-                        long eb_id = selectorB.face_to_edge(fb_id, fb_ei);
+                for (int fb_ei = 0; fb_ei < FB.cols(); fb_ei++) {
+                    long eb_id = selectorB.face_to_edge(fb_id, fb_ei);
 
-                        if (selectorB.edge_to_face(eb_id) != fb_id) {
-                            continue;
-                        }
+                    if (selectorB.edge_to_face(eb_id) != fb_id) {
+                        continue;
+                    }
 
-                        AABB eb_aabb = bodyB_edge_aabb(eb_id);
+                    AABB eb_aabb = bodyB_edge_aabb(eb_id);
 
-                        if (ea_aabb.intersects(eb_aabb)) {
-                            // Convert the local ids to the global ones
-                            add_ee(ea_id, eb_id);
-                        }
+                    if (ea_aabb.intersects(eb_aabb)) {
+                        // Convert the local ids to the global ones
+                        add_ee(ea_id, eb_id);
                     }
                 }
-
-                // ignore (f, f), (f, f_e), (f_v, f_v), (f_v, f_e), (f_e, f),
-                // (f_e, f_v)
             }
+
+            // ignore (f, f), (f, f_e), (f_v, f_v), (f_v, f_e), (f_e, f),
+            // (f_e, f_v)
         }
-    }
+    };
 
     // query (ce, *)
-    for (long co_ea_id = 0; co_ea_id < bodyA.num_codim_edges(); co_ea_id++) {
-        size_t ea_id = selectorA.codim_edges_to_edges(co_ea_id);
-
-        AABB ea_aabb = bodyA_edge_aabb(ea_id);
+    auto query_codim_edge = [&](size_t ea_id, size_t id) {
+        if (id < num_cvB) {
+            size_t vb_id = selectorB.codim_vertices_to_vertices(id);
 
-        std::vector<unsigned int> ids;
-        bodyB.bvh.intersect_box(
-            // Grow the box by inflation_radius because the BVH is not grown
-            ea_aabb.min.array() - inflation_radius,
-            ea_aabb.max.array() + inflation_radius, //
-            ids);
+            // (ce, cv)
+            add_ev(ea_id, vb_id);
 
-        for (const auto& id : ids) {
-            if (id < bodyB.num_codim_vertices()) {
-                size_t vb_id = selectorB.codim_vertices_to_vertices(id);
+        } else if (id < num_cvB + num_ceB) {
+            size_t eb_id = selectorB.codim_edges_to_edges(id - num_cvB);
 
-                // (ce, cv)
-                add_ev(ea_id, vb_id);
+            // (ce, ce)
+            add_ee(ea_id, eb_id);
 
-            } else if (
-                id < bodyB.num_codim_edges() + bodyB.num_codim_vertices()) {
-                size_t eb_id = selectorB.codim_edges_to_edges(id);
+            for (int vi = 0; vi < EB.cols(); vi++) {
+                // (ce, ce_v)
+                size_t vb_id = EB(eb_id, vi);
+                if (selectorB.vertex_to_edge(vb_id) == eb_id) {
+                    add_ev(ea_id, vb_id);
+                }
 
-                // (ce, ce)
-                add_ee(ea_id, eb_id);
+                // (ce_v, ce)
+                size_t va_id = EA(ea_id, vi);
+                if (selectorA.vertex_to_edge(va_id) == ea_id) {
+                    add_ve(va_id, eb_id);
+                }
+            }
 
-                for (int vi = 0; vi < EB.cols(); vi++) {
-                    // (ce, ce_v)
-                    size_t vb_id = EB(eb_id, vi);
-                    if (selectorB.vertex_to_edge(vb_id) == eb_id) {
-                        add_ev(ea_id, vb_id);
-                    }
+            // (ce_v, ce_v) is not needed
 
-                    // (ce_v, ce)
-                    size_t va_id = EA(ea_id, vi);
-                    if (selectorA.vertex_to_edge(va_id) == ea_id) {
-                        add_ve(va_id, eb_id);
-                    }
-                }
+        } else {
+            // (ce, f*)
+            size_t fb_id = id - num_cvB - num_ceB;
 
-                // (ce_v, ce_v) is not needed
+            // (ce_v, f_v) is not needed
+            // (ce_v, f_e) is not needed because in 3D
+            // (ce, f_v) is not needed because in 3D
+            assert(!build_ev);
 
-            } else {
-                // (ce, f*)
-                size_t fb_id =
-                    id - bodyB.num_codim_vertices() - bodyB.num_codim_edges();
-
-                // (ce_v, f_v) is not needed
-                // (ce_v, f_e) is not needed because in 3D
-                // (ce, f_v) is not needed because in 3D
-                assert(!build_ev);
-
-                // (ce_v, f)
-                for (int vi = 0; vi < EA.cols(); vi++) {
-                    size_t va_id = EA(ea_id, vi);
-                    if (selectorA.vertex_to_edge(va_id) == ea_id) {
-                        add_vf(va_id, fb_id);
-                    }
+            // (ce_v, f)
+            for (int vi = 0; vi < EA.cols(); vi++) {
+                size_t va_id = EA(ea_id, vi);
+                if (selectorA.vertex_to_edge(va_id) == ea_id) {
+                    add_vf(va_id, fb_id);
                 }
+            }
 
-                // (ce, f_e)
-                for (int ei = 0; ei < FB.cols(); ei++) {
-                    size_t eb_id = selectorB.face_to_edge(fb_id, ei);
-                    if (selectorB.edge_to_face(eb_id) == fb_id) {
-                        add_ee(ea_id, eb_id);
-                    }
+            // (ce, f_e)
+            for (int ei = 0; ei < FB.cols(); ei++) {
+                size_t eb_id = selectorB.face_to_edge(fb_id, ei);
+                if (selectorB.edge_to_face(eb_id) == fb_id) {
+                    add_ee(ea_id, eb_id);
                 }
-
-                // (ce, f) is not needed
             }
+
+            // (ce, f) is not needed
         }
-    }
+    };
 
     // query (cv, *)
-    for (long co_va_id = 0; co_va_id < bodyA.num_codim_vertices(); co_va_id++) {
-        size_t va_id = selectorA.codim_vertices_to_vertices(co_va_id);
+    auto query_codim_vertex = [&](size_t va_id, size_t id) {
+        if (id < num_cvB) {
+            // (cv, cv) is not needed
+        } else if (id < num_cvB + num_ceB) {
+            size_t eb_id = selectorB.codim_edges_to_edges(id - num_cvB);
 
-        AABB va_aabb = bodyA_vertex_aabbs[va_id];
+            // (cv, ce)
+            add_ve(va_id, eb_id);
 
-        std::vector<unsigned int> ids;
-        bodyB.bvh.intersect_box(
-            // Grow the box by inflation_radius because the BVH is not grown
-            va_aabb.min.array() - inflation_radius,
-            va_aabb.max.array() + inflation_radius, //
-            ids);
+            // (cv, ce_v) is not needed
+        } else {
+            // (cv, f)
+            size_t fb_id = id - num_cvB - num_ceB;
+            add_vf(va_id, fb_id);
 
-        for (const auto& id : ids) {
-            if (id < bodyB.num_codim_vertices()) {
-                // (cv, cv) is not needed
-            } else if (
-                id < bodyB.num_codim_vertices() + bodyB.num_codim_edges()) {
+            // (cv, f_e) is not needed because in 3D
+            assert(!build_ev);
 
-                size_t eb_id = selectorB.codim_edges_to_edges(
-                    id - bodyB.num_codim_vertices());
-
-                // (cv, ce)
-                add_ev(eb_id, va_id);
+            // (cv, f_v) is not needed
+        }
+    };
 
-                // (cv, ce_v) is not needed
+    // Traverse both local BVHs simultaneously instead of descending bodyB's
+    // BVH once per primitive of bodyA.
+    PrimitiveBVH::intersect(
+        bodyA.bvh, bodyA_node_boxes, bodyB.bvh, bodyB_root,
+        [&](unsigned int idA, unsigned int idB) {
+            if (idA < num_cvA) {
+                query_codim_vertex(
+                    selectorA.codim_vertices_to_vertices(idA), idB);
+            } else if (idA < num_cvA + num_ceA) {
+                query_codim_edge(
+                    selectorA.codim_edges_to_edges(idA - num_cvA), idB);
             } else {
-                // (cv, f)
-                size_t fb_id =
-                    id - bodyB.num_codim_vertices() - bodyB.num_codim_edges();
-                add_vf(va_id, fb_id);
-
-                // (cv, f_e) is not needed because in 3D
-                assert(!build_ev);
-
-                // (cv, f_v) is not needed
+                query_face(idA - num_cvA - num_ceA, idB);
             }
-        }
-        // for (int fb_id = 0; fb_id < FB.rows(); fb_id++) {
-        //     if (AABB::are_overlapping(va_aabb, bodyB_face_aabb(fb_id))) {
-        //         add_vf(va_id, fb_id);
-        //     }
-        // }
-    }
+        });
 }
 
 void detect_body_pair_intersection_candidates_from_aabbs(
@@ -317,35 +351,57 @@ void detect_body_pair_intersection_candidates_from_aabbs(
     std::vector<EdgeFaceCandidate>& ef_candidates,
     const double inflation_radius)
 {
+    detect_body_pair_intersection_candidates_from_aabbs(
+        bodies, bodyA_vertex_aabbs, bodyA_id, bodyB_id,
+        [&](const EdgeFaceCandidate& ef_candidate) {
+            ef_candidates.push_back(ef_candidate);
+            return true;
+        },
+        inflation_radius);
+}
+
+bool detect_body_pair_intersection_candidates_from_aabbs(
+    const RigidBodyAssembler& bodies,
+    const std::vector<AABB>& bodyA_vertex_aabbs,
+    const int bodyA_id,
+    const int bodyB_id,
+    const std::function<bool(const EdgeFaceCandidate&)>& callback,
+    const double inflation_radius)
+{
+    bool is_stopped = false;
     auto add_ef = [&](size_t eai, size_t fbi) {
-        ef_candidates.emplace_back(
-            bodies.m_body_edge_id[bodyA_id] + eai,
-            bodies.m_body_face_id[bodyB_id] + fbi);
+        is_stopped = is_stopped
+            || !callback(EdgeFaceCandidate(
+                bodies.m_body_edge_id[bodyA_id] + eai,
+                bodies.m_body_face_id[bodyB_id] + fbi));
     };
     auto add_fe = [&](size_t fai, size_t ebi) {
-        ef_candidates.emplace_back(
-            bodies.m_body_edge_id[bodyB_id] + ebi,
-            bodies.m_body_face_id[bodyA_id] + fai);
+        is_stopped = is_stopped
+            || !callback(EdgeFaceCandidate(
+                bodies.m_body_edge_id[bodyB_id] + ebi,
+                bodies.m_body_face_id[bodyA_id] + fai));
     };
 
     const RigidBody& bodyA = bodies[bodyA_id];
     const RigidBody& bodyB = bodies[bodyB_id];
 
-    const std::vector<AABB> bodyB_vertex_aabbs =
-        vertex_aabbs(bodyB.vertices, inflation_radius);
     const Eigen::MatrixXi &EA = bodyA.edges, &EB = bodyB.edges,
                           &FA = bodyA.faces, &FB = bodyB.faces;
 
     const auto& selectorA = bodyA.mesh_selector;
     const auto& selectorB = bodyB.mesh_selector;
 
+    auto bodyB_vertex_aabb = [&](size_t vi) {
+        return vertex_aabb(
+            VectorMax3d(bodyB.vertices.row(vi)), inflation_radius);
+    };
+
     auto bodyA_edge_aabb = [&](size_t ei) {
         return AABB(
             bodyA_vertex_aabbs[EA(ei, 0)], bodyA_vertex_aabbs[EA(ei, 1)]);
     };
     auto bodyB_edge_aabb = [&](size_t ei) {
-        return AABB(
-            bodyB_vertex_aabbs[EB(ei, 0)], bodyB_vertex_aabbs[EB(ei, 1)]);
+        return AABB(bodyB_vertex_aabb(EB(ei, 0)), bodyB_vertex_aabb(EB(ei, 1)));
     };
     auto bodyA_face_aabb = [&](size_t fi) {
         return AABB(
@@ -354,90 +410,76 @@ void detect_body_pair_intersection_candidates_from_aabbs(
     };
     auto bodyB_face_aabb = [&](size_t fi) {
         return AABB(
-            bodyB_vertex_aabbs[FB(fi, 0)], bodyB_vertex_aabbs[FB(fi, 1)],
-            bodyB_vertex_aabbs[FB(fi, 2)]);
+            bodyB_vertex_aabb(FB(fi, 0)), bodyB_vertex_aabb(FB(fi, 1)),
+            bodyB_vertex_aabb(FB(fi, 2)));
     };
 
+    const size_t num_cvA = bodyA.num_codim_vertices();
+    const size_t num_ceA = bodyA.num_codim_edges();
+    const size_t num_cvB = bodyB.num_codim_vertices();
+    const size_t num_ceB = bodyB.num_codim_edges();
+
     ///////////////////////////////////////////////////////////////////////////
     // query (f, *)
-    for (size_t fa_id = 0; fa_id < FA.rows(); fa_id++) {
-        // Construct a bbox of bodyA's face
-        AABB fa_aabb = bodyA_face_aabb(fa_id);
+    auto query_face = [&](size_t fa_id, size_t id) {
+        if (id < num_cvB) {
+            // ignore (f, cv)
+        } else if (id < num_cvB + num_ceB) {
 
-        std::vector<unsigned int> ids;
-        bodyB.bvh.intersect_box(
-            // Grow the box by inflation_radius because the BVH is not grown
-            fa_aabb.min.array() - inflation_radius,
-            fa_aabb.max.array() + inflation_radius, //
-            ids);
+            // (f, ce)
+            size_t eb_id = selectorB.codim_edges_to_edges(id - num_cvB);
+            add_fe(fa_id, eb_id);
 
-        for (const auto& id : ids) {
-            if (id < bodyB.num_codim_vertices()) {
-                // ignore (f, cv)
-            } else if (
-                id < bodyB.num_codim_edges() + bodyB.num_codim_vertices()) {
+        } else {
+            size_t fb_id = id - num_cvB - num_ceB;
 
-                // (f, ce)
-                size_t eb_id = selectorB.codim_edges_to_edges(
-                    id - bodyB.num_codim_vertices());
-                add_fe(fa_id, eb_id);
+            // Construct a bbox of bodyA's face
+            AABB fa_aabb = bodyA_face_aabb(fa_id);
+            AABB fb_aabb = bodyB_face_aabb(fb_id);
 
-            } else {
-                size_t fb_id =
-                    id - bodyB.num_codim_vertices() - bodyB.num_codim_edges();
-
-                AABB fb_aabb = bodyB_face_aabb(fb_id);
-
-                for (int ei = 0; ei < FA.cols(); ei++) {
-                    long ea_id = bodyA.mesh_selector.face_to_edge(fa_id, ei);
-                    if (selectorA.edge_to_face(ea_id) == fa_id) {
-                        AABB ea_aabb = bodyA_edge_aabb(ea_id);
-                        if (ea_aabb.intersects(fb_aabb)) {
-                            add_ef(ea_id, fb_id);
-                        }
+            for (int ei = 0; ei < FA.cols(); ei++) {
+                long ea_id = selectorA.face_to_edge(fa_id, ei);
+                if (selectorA.edge_to_face(ea_id) == fa_id) {
+                    AABB ea_aabb = bodyA_edge_aabb(ea_id);
+                    if (ea_aabb.intersects(fb_aabb)) {
+                        add_ef(ea_id, fb_id);
                     }
+                }
 
-                    long eb_id = bodyB.mesh_selector.face_to_edge(fb_id, ei);
-                    if (bodyB.mesh_selector.edge_to_face(eb_id) == fb_id) {
-                        AABB eb_aabb = bodyB_edge_aabb(eb_id);
-                        if (fa_aabb.intersects(eb_aabb)) {
-                            add_fe(fa_id, eb_id);
-                        }
+                long eb_id = selectorB.face_to_edge(fb_id, ei);
+                if (selectorB.edge_to_face(eb_id) == fb_id) {
+                    AABB eb_aabb = bodyB_edge_aabb(eb_id);
+                    if (fa_aabb.intersects(eb_aabb)) {
+                        add_fe(fa_id, eb_id);
                     }
                 }
             }
         }
-    }
+    };
 
     // query (ce, *)
-    for (long co_ea_id = 0; co_ea_id < bodyA.num_codim_edges(); co_ea_id++) {
-        size_t ea_id = selectorA.codim_edges_to_edges(co_ea_id);
-
-        AABB ea_aabb = bodyA_edge_aabb(ea_id);
-
-        std::vector<unsigned int> ids;
-        bodyB.bvh.intersect_box(
-            // Grow the box by inflation_radius because the BVH is not grown
-            ea_aabb.min.array() - inflation_radius,
-            ea_aabb.max.array() + inflation_radius, //
-            ids);
-
-        for (const auto& id : ids) {
-            if (id < bodyB.num_codim_vertices()) {
-                // ignore (ce, cv)
-            } else if (
-                id < bodyB.num_codim_edges() + bodyB.num_codim_vertices()) {
-                // ignore (ce, cv)
-            } else {
-                size_t fb_id =
-                    id - bodyB.num_codim_vertices() - bodyB.num_codim_edges();
-                // (ce, f)
-                add_ef(ea_id, fb_id);
-            }
+    auto query_codim_edge = [&](size_t ea_id, size_t id) {
+        if (id >= num_cvB + num_ceB) {
+            // (ce, f)
+            add_ef(ea_id, id - num_cvB - num_ceB);
         }
-    }
+        // ignore (ce, cv) and (ce, ce)
+    };
 
-    // no need to query (cv, *)
+    PrimitiveBVH::intersect(
+        bodyA.bvh, refit_body_bvh(bodyA, bodyA_vertex_aabbs, inflation_radius),
+        bodyB.bvh, [&](unsigned int idA, unsigned int idB) {
+            if (idA < num_cvA) {
+                // no need to query (cv, *)
+            } else if (idA < num_cvA + num_ceA) {
+                query_codim_edge(
+                    selectorA.codim_edges_to_edges(idA - num_cvA), idB);
+            } else {
+                query_face(idA - num_cvA - num_ceA, idB);
+            }
+            return !is_stopped;
+        });
+    return !is_stopped;
 }
 
 } // namespace ipc::rigid
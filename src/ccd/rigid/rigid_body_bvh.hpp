@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cmath>
+#include <functional>
+
 #include <Eigen/Core>
 
 #include "ipc/candidates/candidates.hpp"
@@ -53,11 +56,66 @@ vertex_aabbs(const MatrixX<T>& V, double inflation_radius = 0)
     return aabbs;
 }
 
+/// @brief Boxes of the smaller body's vertices in the larger body's local
+/// coordinates (sorts the body pair accordingly).
+template <typename T>
+inline std::vector<AABB> body_pair_vertex_aabbs(
+    const RigidBodyAssembler& bodies,
+    const Poses<T>& poses,
+    int& bodyA_id,
+    int& bodyB_id,
+    const double inflation_radius = 0.0)
+{
+    sort_body_pair(bodies, bodyA_id, bodyB_id);
+
+    const auto RA = poses[bodyA_id].construct_rotation_matrix();
+    const auto RB = poses[bodyB_id].construct_rotation_matrix();
+    const auto& pA = poses[bodyA_id].position;
+    const auto& pB = poses[bodyB_id].position;
+    const MatrixX<T> VA =
+        ((bodies[bodyA_id].vertices * RA.transpose()).rowwise()
+         + (pA - pB).transpose())
+        * RB;
+
+    return vertex_aabbs(VA, inflation_radius);
+}
+
+/// @brief Estimated cost of finding the candidates of a sorted body pair.
+///
+/// Each primitive of the smaller body descends the larger body's tree.
+inline double body_pair_cost(
+    const RigidBodyAssembler& bodies, const int bodyA_id, const int bodyB_id)
+{
+    return (bodies[bodyA_id].bvh_size() + 1)
+        * std::log2(bodies[bodyB_id].bvh_size() + 2);
+}
+
+/// @brief Refit bodyA's local BVH to its primitives' boxes in bodyB's local
+/// space.
+std::vector<PrimitiveBVH::Box> refit_body_bvh(
+    const RigidBody& body,
+    const std::vector<AABB>& vertex_aabbs,
+    const double inflation_radius);
+
+void detect_body_pair_collision_candidates_from_aabbs(
+    const RigidBodyAssembler& bodies,
+    const std::vector<AABB>& bodyA_vertex_aabbs,
+    const int bodyA_id,
+    const int bodyB_id,
+    const int collision_types,
+    Candidates& candidates,
+    const double inflation_radius = 0.0);
+
+/// @brief Find the candidates of bodyA and a subtree of bodyB's BVH.
+/// @param bodyA_node_boxes bodyA's BVH refit with refit_body_bvh().
+/// @param bodyB_root Root of the subtree (see PrimitiveBVH::subtrees()).
 void detect_body_pair_collision_candidates_from_aabbs(
     const RigidBodyAssembler& bodies,
     const std::vector<AABB>& bodyA_vertex_aabbs,
+    const std::vector<PrimitiveBVH::Box>& bodyA_node_boxes,
     const int bodyA_id,
     const int bodyB_id,
+    const int bodyB_root,
     const int collision_types,
     Candidates& candidates,
     const double inflation_radius = 0.0);
@@ -72,27 +130,14 @@ inline void detect_body_pair_collision_candidates_bvh(
     Candidates& candidates,
     const double inflation_radius = 0.0)
 {
-    sort_body_pair(bodies, bodyA_id, bodyB_id);
-
     // Compute the smaller body's vertices in the larger body's local
     // coordinates.
-    // PROFILE_POINT(fmt::format(
-    //     "detect_body_pair_collision_candidates_bvh<{}>:compute_vertices",
-    //     get_type_name<T>()));
-    // PROFILE_START();
-    const auto RA = poses[bodyA_id].construct_rotation_matrix();
-    const auto RB = poses[bodyB_id].construct_rotation_matrix();
-    const auto& pA = poses[bodyA_id].position;
-    const auto& pB = poses[bodyB_id].position;
-    const MatrixX<T> VA =
-        ((bodies[bodyA_id].vertices * RA.transpose()).rowwise()
-         + (pA - pB).transpose())
-        * RB;
-    // PROFILE_END();
+    std::vector<AABB> aabbs = body_pair_vertex_aabbs(
+        bodies, poses, bodyA_id, bodyB_id, inflation_radius);
 
     detect_body_pair_collision_candidates_from_aabbs(
-        bodies, vertex_aabbs(VA, inflation_radius), bodyA_id, bodyB_id,
-        collision_types, candidates, inflation_radius);
+        bodies, aabbs, bodyA_id, bodyB_id, collision_types, candidates,
+        inflation_radius);
 }
 
 void detect_body_pair_intersection_candidates_from_aabbs(
@@ -103,4 +148,16 @@ void detect_body_pair_intersection_candidates_from_aabbs(
     std::vector<EdgeFaceCandidate>& candidates,
     const double inflation_radius = 0.0);
 
+/// @brief Stream the candidate intersections of a body pair to a callback.
+/// @param callback Called with each candidate; the search stops once it
+///                 returns false.
+/// @return False if the callback stopped the search.
+bool detect_body_pair_intersection_candidates_from_aabbs(
+    const RigidBodyAssembler& bodies,
+    const std::vector<AABB>& bodyA_vertex_aabbs,
+    const int bodyA_id,
+    const int bodyB_id,
+    const std::function<bool(const EdgeFaceCandidate&)>& callback,
+    const double inflation_radius = 0.0);
+
 } // namespace ipc::rigid
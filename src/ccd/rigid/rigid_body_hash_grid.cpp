@@ -46,8 +46,9 @@ void RigidBodyHashGrid::resize(
 
     std::vector<int> body_ids =
         body_pairs_to_body_ids(body_pairs, bodies.num_bodies());
+    Eigen::MatrixXd buffer;
     for (int i : body_ids) {
-        Eigen::MatrixXd V = bodies[i].world_vertices(poses[i]);
+        const Eigen::MatrixXd& V = bodies[i].world_vertices(poses[i], buffer);
         min = min.cwiseMin(V.colwise().minCoeff().transpose());
         max = max.cwiseMax(V.colwise().maxCoeff().transpose());
     }
@@ -130,8 +131,9 @@ void RigidBodyHashGrid::addBodies(
 
     // ahmed: this duplicates the code in aabb.hpp build_vertex_boxes()
     // build_edge_boxes() and build_face_boxes()
+    Eigen::MatrixXd buffer;
     for (int id : body_ids) {
-        Eigen::MatrixXd V = bodies[id].world_vertices(poses[id]);
+        const Eigen::MatrixXd& V = bodies[id].world_vertices(poses[id], buffer);
         tbb::parallel_invoke(
             [&]() {
                 long v0i = bodies.m_body_vertex_id[id];
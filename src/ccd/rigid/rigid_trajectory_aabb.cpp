@@ -1,9 +1,48 @@
 #include "rigid_trajectory_aabb.hpp"
 
+#include <utils/sinc.hpp>
+
 namespace ipc::rigid {
 
 typedef Pose<Interval> PoseI;
 
+/// @brief Enclosure of the velocity of a point of a body with (interval)
+/// local coordinates y.
+///
+/// The velocity is Δp + ω × R y, and the angular velocity of a linearly
+/// interpolated rotation vector has norm at most ‖Δθ‖ (the Jacobian of the
+/// exponential map has singular values at most one).
+static VectorMax3I point_velocity_aabb(
+    const PoseI& pose_t0, const PoseI& pose_t1, const VectorMax3I& y)
+{
+    const VectorMax3I dtheta = pose_t1.rotation - pose_t0.rotation;
+    const double speed = (norm(dtheta) * norm(y)).upper();
+    VectorMax3I velocity = pose_t1.position - pose_t0.position;
+    for (int i = 0; i < velocity.size(); i++) {
+        velocity(i) += Interval(-speed, speed);
+    }
+    return velocity;
+}
+
+/// @brief Intersect two enclosures of the same range.
+static VectorMax3I
+intersect_aabbs(const VectorMax3I& naive, const VectorMax3I& mean_value)
+{
+    VectorMax3I result(naive.size());
+    for (int i = 0; i < naive.size(); i++) {
+        result(i) = boost::numeric::intersect(naive(i), mean_value(i));
+        if (empty(result(i))) {
+            return naive; // Only possible due to rounding
+        }
+    }
+    return result;
+}
+
+static Interval midpoint(const Interval& x)
+{
+    return Interval(boost::numeric::median(x));
+}
+
 VectorMax3I vertex_trajectory_aabb(
     const RigidBody& body,
     const PoseI& pose_t0, // Pose of body at t=0
@@ -61,10 +100,34 @@ VectorMax3I edge_vertex_aabb(
     const PoseI& poseB_t1,  // Pose of bodyB at t=1
     size_t edge_id,         // In bodyB
     const Interval& t,
-    const Interval& alpha)
+    const Interval& alpha,
+    TrajectoryEnclosure enclosure)
 {
-    return vertex_trajectory_aabb(bodyA, poseA_t0, poseA_t1, vertex_id, t)
-        - edge_trajectory_aabb(bodyB, poseB_t0, poseB_t1, edge_id, t, alpha);
+    const PoseI poseB = PoseI::interpolate(poseB_t0, poseB_t1, t);
+    const long e0_id = bodyB.edges(edge_id, 0), e1_id = bodyB.edges(edge_id, 1);
+    const VectorMax3I e0 = bodyB.world_vertex(poseB, e0_id);
+    const VectorMax3I e1 = bodyB.world_vertex(poseB, e1_id);
+    const VectorMax3I naive =
+        vertex_trajectory_aabb(bodyA, poseA_t0, poseA_t1, vertex_id, t)
+        - ((e1 - e0) * alpha + e0);
+    if (enclosure == NAIVE_ENCLOSURE) {
+        return naive;
+    }
+
+    const Interval t_mid = midpoint(t), alpha_mid = midpoint(alpha);
+    const VectorMax3I f_mid = edge_vertex_aabb(
+        bodyA, poseA_t0, poseA_t1, vertex_id, bodyB, poseB_t0, poseB_t1,
+        edge_id, t_mid, alpha_mid);
+
+    const VectorMax3I yA = bodyA.vertices.row(vertex_id).cast<Interval>();
+    const VectorMax3I yB0 = bodyB.vertices.row(e0_id).cast<Interval>();
+    const VectorMax3I yB1 = bodyB.vertices.row(e1_id).cast<Interval>();
+    const VectorMax3I df_dt = point_velocity_aabb(poseA_t0, poseA_t1, yA)
+        - point_velocity_aabb(poseB_t0, poseB_t1, (yB1 - yB0) * alpha + yB0);
+
+    return intersect_aabbs(
+        naive,
+        f_mid + df_dt * (t - t_mid) - (e1 - e0) * (alpha - alpha_mid));
 }
 
 VectorMax3I edge_edge_aabb(
@@ -78,10 +141,43 @@ VectorMax3I edge_edge_aabb(
     size_t edgeB_id,        // In bodyB
     const Interval& t,
     const Interval& alpha,
-    const Interval& beta)
+    const Interval& beta,
+    TrajectoryEnclosure enclosure)
 {
-    return edge_trajectory_aabb(bodyA, poseA_t0, poseA_t1, edgeA_id, t, alpha)
-        - edge_trajectory_aabb(bodyB, poseB_t0, poseB_t1, edgeB_id, t, beta);
+    const PoseI poseA = PoseI::interpolate(poseA_t0, poseA_t1, t);
+    const PoseI poseB = PoseI::interpolate(poseB_t0, poseB_t1, t);
+    const long ea0_id = bodyA.edges(edgeA_id, 0);
+    const long ea1_id = bodyA.edges(edgeA_id, 1);
+    const long eb0_id = bodyB.edges(edgeB_id, 0);
+    const long eb1_id = bodyB.edges(edgeB_id, 1);
+    const VectorMax3I ea0 = bodyA.world_vertex(poseA, ea0_id);
+    const VectorMax3I ea1 = bodyA.world_vertex(poseA, ea1_id);
+    const VectorMax3I eb0 = bodyB.world_vertex(poseB, eb0_id);
+    const VectorMax3I eb1 = bodyB.world_vertex(poseB, eb1_id);
+    const VectorMax3I naive =
+        ((ea1 - ea0) * alpha + ea0) - ((eb1 - eb0) * beta + eb0);
+    if (enclosure == NAIVE_ENCLOSURE) {
+        return naive;
+    }
+
+    const Interval t_mid = midpoint(t), alpha_mid = midpoint(alpha),
+                   beta_mid = midpoint(beta);
+    const VectorMax3I f_mid = edge_edge_aabb(
+        bodyA, poseA_t0, poseA_t1, edgeA_id, bodyB, poseB_t0, poseB_t1,
+        edgeB_id, t_mid, alpha_mid, beta_mid);
+
+    const VectorMax3I yA0 = bodyA.vertices.row(ea0_id).cast<Interval>();
+    const VectorMax3I yA1 = bodyA.vertices.row(ea1_id).cast<Interval>();
+    const VectorMax3I yB0 = bodyB.vertices.row(eb0_id).cast<Interval>();
+    const VectorMax3I yB1 = bodyB.vertices.row(eb1_id).cast<Interval>();
+    const VectorMax3I df_dt =
+        point_velocity_aabb(poseA_t0, poseA_t1, (yA1 - yA0) * alpha + yA0)
+        - point_velocity_aabb(poseB_t0, poseB_t1, (yB1 - yB0) * beta + yB0);
+
+    return intersect_aabbs(
+        naive,
+        f_mid + df_dt * (t - t_mid) + (ea1 - ea0) * (alpha - alpha_mid)
+            - (eb1 - eb0) * (beta - beta_mid));
 }
 
 VectorMax3I face_vertex_aabb(
@@ -95,10 +191,41 @@ VectorMax3I face_vertex_aabb(
     size_t face_id,         // In bodyB
     const Interval& t,
     const Interval& u,
-    const Interval& v)
+    const Interval& v,
+    TrajectoryEnclosure enclosure)
 {
-    return vertex_trajectory_aabb(bodyA, poseA_t0, poseA_t1, vertex_id, t)
-        - face_trajectory_aabb(bodyB, poseB_t0, poseB_t1, face_id, t, u, v);
+    const PoseI poseB = PoseI::interpolate(poseB_t0, poseB_t1, t);
+    const long f0_id = bodyB.faces(face_id, 0);
+    const long f1_id = bodyB.faces(face_id, 1);
+    const long f2_id = bodyB.faces(face_id, 2);
+    const VectorMax3I f0 = bodyB.world_vertex(poseB, f0_id);
+    const VectorMax3I f1 = bodyB.world_vertex(poseB, f1_id);
+    const VectorMax3I f2 = bodyB.world_vertex(poseB, f2_id);
+    const VectorMax3I naive =
+        vertex_trajectory_aabb(bodyA, poseA_t0, poseA_t1, vertex_id, t)
+        - ((f1 - f0) * u + (f2 - f0) * v + f0);
+    if (enclosure == NAIVE_ENCLOSURE) {
+        return naive;
+    }
+
+    const Interval t_mid = midpoint(t), u_mid = midpoint(u),
+                   v_mid = midpoint(v);
+    const VectorMax3I f_mid = face_vertex_aabb(
+        bodyA, poseA_t0, poseA_t1, vertex_id, bodyB, poseB_t0, poseB_t1,
+        face_id, t_mid, u_mid, v_mid);
+
+    const VectorMax3I yA = bodyA.vertices.row(vertex_id).cast<Interval>();
+    const VectorMax3I yB0 = bodyB.vertices.row(f0_id).cast<Interval>();
+    const VectorMax3I yB1 = bodyB.vertices.row(f1_id).cast<Interval>();
+    const VectorMax3I yB2 = bodyB.vertices.row(f2_id).cast<Interval>();
+    const VectorMax3I df_dt = point_velocity_aabb(poseA_t0, poseA_t1, yA)
+        - point_velocity_aabb(
+              poseB_t0, poseB_t1, (yB1 - yB0) * u + (yB2 - yB0) * v + yB0);
+
+    return intersect_aabbs(
+        naive,
+        f_mid + df_dt * (t - t_mid) - (f1 - f0) * (u - u_mid)
+            - (f2 - f0) * (v - v_mid));
 }
 
 } // namespace ipc::rigid
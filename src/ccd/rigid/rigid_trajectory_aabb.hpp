@@ -5,6 +5,15 @@
 
 namespace ipc::rigid {
 
+/// @brief How the distance between two rigid trajectories is enclosed.
+enum TrajectoryEnclosure {
+    /// Evaluate the trajectory in plain interval arithmetic.
+    NAIVE_ENCLOSURE,
+    /// Intersect the naive enclosure with the first-order (mean value) form
+    /// f(m) + ∑ ∂f/∂xᵢ(X) (Xᵢ - mᵢ) around the midpoint m of the box X.
+    MEAN_VALUE_ENCLOSURE
+};
+
 VectorMax3I vertex_trajectory_aabb(
     const RigidBody& body,
     const Pose<Interval>& pose_t0, // Pose of body at t=0
@@ -39,7 +48,8 @@ VectorMax3I edge_vertex_aabb(
     const Pose<Interval>& poseB_t1, // Pose of bodyB at t=1
     size_t edge_id,                 // In bodyB
     const Interval& t = Interval(0, 1),
-    const Interval& alpha = Interval(0, 1));
+    const Interval& alpha = Interval(0, 1),
+    TrajectoryEnclosure enclosure = NAIVE_ENCLOSURE);
 
 VectorMax3I edge_edge_aabb(
     const RigidBody& bodyA,         // Body of the first edge
@@ -52,7 +62,8 @@ VectorMax3I edge_edge_aabb(
     size_t edgeB_id,                // In bodyB
     const Interval& t = Interval(0, 1),
     const Interval& alpha = Interval(0, 1),
-    const Interval& beta = Interval(0, 1));
+    const Interval& beta = Interval(0, 1),
+    TrajectoryEnclosure enclosure = NAIVE_ENCLOSURE);
 
 VectorMax3I face_vertex_aabb(
     const RigidBody& bodyA,         // Body of the vertex
@@ -65,6 +76,7 @@ VectorMax3I face_vertex_aabb(
     size_t face_id,                 // In bodyB
     const Interval& t = Interval(0, 1),
     const Interval& u = Interval(0, 1),
-    const Interval& v = Interval(0, 1));
+    const Interval& v = Interval(0, 1),
+    TrajectoryEnclosure enclosure = NAIVE_ENCLOSURE);
 
 } // namespace ipc::rigid
@@ -6,6 +6,7 @@
 #include <igl/Timer.h>
 #endif
 
+#include <ccd/rigid/motion_bound.hpp>
 #include <ccd/rigid/rigid_trajectory_aabb.hpp>
 #include <geometry/distance.hpp>
 #include <geometry/intersection.hpp>
@@ -65,12 +66,23 @@ bool compute_edge_vertex_time_of_impact(
     size_t edge_id,               // In bodyB
     double& toi,
     double earliest_toi, // Only search for collision in [0, earliest_toi]
-    double toi_tolerance)
+    double toi_tolerance,
+    TrajectoryEnclosure enclosure)
 {
     int dim = bodyA.dim();
     assert(bodyB.dim() == dim);
     assert(dim == 2);
 
+    // Reject clearly separated pairs and skip the start of the step that is
+    // certified impact-free before resorting to interval arithmetic.
+    const double toi_lower_bound = edge_vertex_toi_lower_bound(
+        bodyA, poseA_t0, poseA_t1, vertex_id, bodyB, poseB_t0, poseB_t1,
+        edge_id);
+    if (toi_lower_bound >= earliest_toi) {
+        toi = std::numeric_limits<double>::infinity();
+        return false;
+    }
+
     const PoseI poseIA_t0 = poseA_t0.cast<Interval>();
     const PoseI poseIA_t1 = poseA_t1.cast<Interval>();
 
@@ -81,7 +93,7 @@ bool compute_edge_vertex_time_of_impact(
         assert(params.size() == 2);
         return edge_vertex_aabb(
             bodyA, poseIA_t0, poseIA_t1, vertex_id, bodyB, poseIB_t0, poseIB_t1,
-            edge_id, /*t=*/params(0), /*alpha=*/params(1));
+            edge_id, /*t=*/params(0), /*alpha=*/params(1), enclosure);
     };
 
     Eigen::Vector2d tol = compute_edge_vertex_tolerance(
@@ -89,7 +101,8 @@ bool compute_edge_vertex_time_of_impact(
         edge_id);
     tol[0] = toi_tolerance;
 
-    VectorMax3I x0 = Vector2I(Interval(0, earliest_toi), Interval(0, 1));
+    VectorMax3I x0 =
+        Vector2I(Interval(toi_lower_bound, earliest_toi), Interval(0, 1));
     VectorMax3I toi_interval;
     bool is_impacting = interval_root_finder(distance, x0, tol, toi_interval);
 
@@ -166,10 +179,19 @@ bool compute_edge_edge_time_of_impact(
     size_t edgeB_id,              // In bodyB
     double& toi,
     double earliest_toi, // Only search for collision in [0, earliest_toi]
-    double toi_tolerance)
+    double toi_tolerance,
+    TrajectoryEnclosure enclosure)
 {
     assert(bodyA.dim() == 3 && bodyB.dim() == bodyA.dim());
 
+    const double toi_lower_bound = edge_edge_toi_lower_bound(
+        bodyA, poseA_t0, poseA_t1, edgeA_id, //
+        bodyB, poseB_t0, poseB_t1, edgeB_id);
+    if (toi_lower_bound >= earliest_toi) {
+        toi = std::numeric_limits<double>::infinity();
+        return false;
+    }
+
     const PoseI poseIA_t0 = poseA_t0.cast<Interval>();
     const PoseI poseIA_t1 = poseA_t1.cast<Interval>();
     const PoseI poseIB_t0 = poseB_t0.cast<Interval>();
@@ -178,7 +200,8 @@ bool compute_edge_edge_time_of_impact(
         assert(params.size() == 3);
         return edge_edge_aabb(
             bodyA, poseIA_t0, poseIA_t1, edgeA_id, bodyB, poseIB_t0, poseIB_t1,
-            edgeB_id, /*t=*/params(0), /*alpha=*/params(1), /*beta=*/params(2));
+            edgeB_id, /*t=*/params(0), /*alpha=*/params(1), /*beta=*/params(2),
+            enclosure);
     };
 
     Eigen::Vector3d tol = compute_edge_edge_tolerance(
@@ -192,8 +215,9 @@ bool compute_edge_edge_time_of_impact(
 #endif
 
     VectorMax3I toi_interval;
-    VectorMax3I x0 =
-        Vector3I(Interval(0, earliest_toi), Interval(0, 1), Interval(0, 1));
+    VectorMax3I x0 = Vector3I(
+        Interval(toi_lower_bound, earliest_toi), Interval(0, 1),
+        Interval(0, 1));
     bool is_impacting = interval_root_finder(distance, x0, tol, toi_interval);
 
 #ifdef TIME_CCD_QUERIES
@@ -256,10 +280,19 @@ bool compute_face_vertex_time_of_impact(
     size_t face_id,               // In bodyB
     double& toi,
     double earliest_toi, // Only search for collision in [0, earliest_toi]
-    double toi_tolerance)
+    double toi_tolerance,
+    TrajectoryEnclosure enclosure)
 {
     assert(bodyA.dim() == 3 && bodyA.dim() == bodyB.dim());
 
+    const double toi_lower_bound = face_vertex_toi_lower_bound(
+        bodyA, poseA_t0, poseA_t1, vertex_id, //
+        bodyB, poseB_t0, poseB_t1, face_id);
+    if (toi_lower_bound >= earliest_toi) {
+        toi = std::numeric_limits<double>::infinity();
+        return false;
+    }
+
     const PoseI poseIA_t0 = poseA_t0.cast<Interval>();
     const PoseI poseIA_t1 = poseA_t1.cast<Interval>();
     const PoseI poseIB_t0 = poseB_t0.cast<Interval>();
@@ -270,7 +303,7 @@ bool compute_face_vertex_time_of_impact(
         return face_vertex_aabb(
             bodyA, poseIA_t0, poseIA_t1, vertex_id, //
             bodyB, poseIB_t0, poseIB_t1, face_id,   //
-            /*t=*/params(0), /*u=*/params(1), /*v=*/params(2));
+            /*t=*/params(0), /*u=*/params(1), /*v=*/params(2), enclosure);
     };
 
     const auto is_domain_valid = [&](const VectorMax3I& params) {
@@ -290,8 +323,9 @@ bool compute_face_vertex_time_of_impact(
 #endif
 
     VectorMax3I toi_interval;
-    VectorMax3I x0 =
-        Vector3I(Interval(0, earliest_toi), Interval(0, 1), Interval(0, 1));
+    VectorMax3I x0 = Vector3I(
+        Interval(toi_lower_bound, earliest_toi), Interval(0, 1),
+        Interval(0, 1));
     bool is_impacting =
         interval_root_finder(distance, is_domain_valid, x0, tol, toi_interval);
 
@@ -1,6 +1,7 @@
 // Time-of-impact computation for rigid bodies with angular trajectories.
 #pragma once
 
+#include <ccd/rigid/rigid_trajectory_aabb.hpp>
 #include <constants.hpp>
 #include <physics/rigid_body.hpp>
 
@@ -22,7 +23,8 @@ bool compute_edge_vertex_time_of_impact(
     size_t edge_id,                        // In bodyB
     double& toi,
     double earliest_toi = 1, // Only search for collision in [0, earliest_toi]
-    double toi_tolerance = Constants::RIGID_CCD_TOI_TOL);
+    double toi_tolerance = Constants::RIGID_CCD_TOI_TOL,
+    TrajectoryEnclosure enclosure = MEAN_VALUE_ENCLOSURE);
 
 /// Find time-of-impact between two rigid bodies
 bool compute_edge_edge_time_of_impact(
@@ -36,7 +38,8 @@ bool compute_edge_edge_time_of_impact(
     size_t edgeB_id,                       // In bodyB
     double& toi,
     double earliest_toi = 1, // Only search for collision in [0, earliest_toi]
-    double toi_tolerance = Constants::RIGID_CCD_TOI_TOL);
+    double toi_tolerance = Constants::RIGID_CCD_TOI_TOL,
+    TrajectoryEnclosure enclosure = MEAN_VALUE_ENCLOSURE);
 
 /// Find time-of-impact between two rigid bodies
 bool compute_face_vertex_time_of_impact(
@@ -50,6 +53,7 @@ bool compute_face_vertex_time_of_impact(
     size_t face_id,                        // In bodyB
     double& toi,
     double earliest_toi = 1, // Only search for collision in [0, earliest_toi]
-    double toi_tolerance = Constants::RIGID_CCD_TOI_TOL);
+    double toi_tolerance = Constants::RIGID_CCD_TOI_TOL,
+    TrajectoryEnclosure enclosure = MEAN_VALUE_ENCLOSURE);
 
 } // namespace ipc::rigid
@@ -1,12 +1,25 @@
 // A root finder using interval arithmetic.
 #include "interval_root_finder.hpp"
 
+#include <atomic>
 #include <stack>
 
 #include <logger.hpp>
 
 namespace ipc::rigid {
 
+static thread_local size_t num_boxes = 0;
+static std::atomic<size_t> total_num_boxes { 0 };
+
+size_t interval_root_finder_num_boxes() { return num_boxes; }
+
+void reset_interval_root_finder_num_boxes() { num_boxes = 0; }
+
+size_t interval_root_finder_total_num_boxes()
+{
+    return total_num_boxes.load(std::memory_order_relaxed);
+}
+
 bool interval_root_finder(
     const std::function<Interval(const Interval&)>& f,
     const Interval& x0,
@@ -124,6 +137,9 @@ bool interval_root_finder(
         tol(0) /= 1e2;
     }
 
+    // Boxes are counted locally and added to the shared total once
+    size_t call_num_boxes = 0;
+
     // TODO: Enable max_iterations
     for (size_t iter = 0; !xs.empty(); iter++) {
         x = xs.top();
@@ -139,6 +155,7 @@ bool interval_root_finder(
         }
 
         VectorMax3I y = f(x);
+        call_num_boxes++;
 
         // spdlog::critical(
         //     "{} ↦ {}", fmt_eigen_intervals(x),
@@ -198,6 +215,8 @@ bool interval_root_finder(
     //     }
     //     return true; // A conservative answer
     // }
+    num_boxes += call_num_boxes;
+    total_num_boxes.fetch_add(call_num_boxes, std::memory_order_relaxed);
     x = earliest_root;
     return found_root;
 }
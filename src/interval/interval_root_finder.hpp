@@ -52,4 +52,13 @@ bool interval_root_finder(
     VectorMax3I& x,
     int max_iterations = Constants::INTERVAL_ROOT_FINDER_MAX_ITERATIONS);
 
+/// @brief Number of boxes the root finder evaluated on the calling thread
+/// since the last reset (for benchmarking enclosures).
+size_t interval_root_finder_num_boxes();
+/// @brief Reset the count of interval_root_finder_num_boxes().
+void reset_interval_root_finder_num_boxes();
+/// @brief Number of boxes the root finder evaluated on all threads since the
+/// start of the program.
+size_t interval_root_finder_total_num_boxes();
+
 } // namespace ipc::rigid
@@ -0,0 +1,87 @@
+// Small-argument interval enclosures of trigonometric functions.
+#include "interval_trig.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace ipc::rigid {
+
+// Taylor coefficients in x² of sinc(x) = ∑ (-1)ᵏ x²ᵏ / (2k + 1)!
+static const std::array<double, 9> SINC_COEFFS = { {
+    1.0, -1.0 / 6.0, 1.0 / 120.0, -1.0 / 5040.0, 1.0 / 362880.0,
+    -1.0 / 39916800.0, 1.0 / 6227020800.0, -1.0 / 1307674368000.0,
+    1.0 / 355687428096000.0 //
+} };
+
+// Taylor coefficients in x² of (1 - cos(x)) / x² = ∑ (-1)ᵏ x²ᵏ / (2k + 2)!
+static const std::array<double, 9> VERSINE_COEFFS = { {
+    1.0 / 2.0, -1.0 / 24.0, 1.0 / 720.0, -1.0 / 40320.0, 1.0 / 3628800.0,
+    -1.0 / 479001600.0, 1.0 / 87178291200.0, -1.0 / 20922789888000.0,
+    1.0 / 6402373705728000.0 //
+} };
+
+// For |x| ≤ 1 the series are alternating with decreasing terms, so the
+// truncation error is below the first omitted term (≤ 1/19! < 1e-17). The
+// rounding error of the coefficients and of Horner's scheme is below 30 ulp
+// of 1. This bound leaves a wide margin on both.
+static const double SERIES_ERROR = 1e-14;
+
+template <size_t N>
+static double horner(const std::array<double, N>& coeffs, double x2)
+{
+    double y = coeffs[N - 1];
+    for (int i = int(N) - 2; i >= 0; i--) {
+        y = y * x2 + coeffs[i];
+    }
+    return y;
+}
+
+SmallAngleTrig small_angle_trig(const Interval& x)
+{
+    assert(is_small_angle(x));
+
+    // sinc, cos, and (1 - cos) / x² are even and decreasing in |x| on
+    // [0, 1], and sin is increasing on [-1, 1], so the extrema are at the
+    // smallest and largest |x|.
+    const double abs_min = boost::numeric::zero_in(x)
+        ? 0.0
+        : std::min(std::abs(x.lower()), std::abs(x.upper()));
+    const double abs_max = std::max(-x.lower(), x.upper());
+    const double abs_min2 = abs_min * abs_min;
+    const double abs_max2 = abs_max * abs_max;
+
+    SmallAngleTrig y;
+
+    const double sinc_min = horner(SINC_COEFFS, abs_max2);
+    const double sinc_max = horner(SINC_COEFFS, abs_min2);
+    y.sinc = Interval(
+        sinc_min - SERIES_ERROR, std::min(sinc_max + SERIES_ERROR, 1.0));
+
+    const double versine_min = horner(VERSINE_COEFFS, abs_max2);
+    const double versine_max = horner(VERSINE_COEFFS, abs_min2);
+    y.one_minus_cos_over_x2 = Interval(
+        versine_min - SERIES_ERROR, std::min(versine_max + SERIES_ERROR, 0.5));
+
+    // cos(x) = 1 - x² (1 - cos(x)) / x²
+    y.cos = Interval(
+        std::max(1 - abs_max2 * versine_min - SERIES_ERROR, -1.0),
+        std::min(1 - abs_min2 * versine_max + SERIES_ERROR, 1.0));
+
+    // sin(x) = x sinc(x) with an error proportional to |x| (padded by the
+    // smallest subnormal in case the product underflows)
+    const auto sin_error = [](double xi) {
+        return std::abs(xi) * SERIES_ERROR
+            + std::numeric_limits<double>::denorm_min();
+    };
+    const double lower = x.lower(), upper = x.upper();
+    y.sin = Interval(
+        lower * horner(SINC_COEFFS, lower * lower) - sin_error(lower),
+        upper * horner(SINC_COEFFS, upper * upper) + sin_error(upper));
+
+    return y;
+}
+
+} // namespace ipc::rigid
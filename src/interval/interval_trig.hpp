@@ -0,0 +1,34 @@
+// Small-argument interval enclosures of trigonometric functions.
+#pragma once
+
+#include <interval/interval.hpp>
+
+namespace ipc::rigid {
+
+/// @brief Largest |x| handled by small_angle_trig().
+static constexpr double SMALL_ANGLE_BOUND = 1.0;
+
+/// @brief Is x inside the domain of small_angle_trig()?
+inline bool is_small_angle(const Interval& x)
+{
+    return -SMALL_ANGLE_BOUND <= x.lower() && x.upper() <= SMALL_ANGLE_BOUND;
+}
+
+/// @brief Enclosures of trigonometric functions of the same argument.
+struct SmallAngleTrig {
+    Interval sin;                   ///< sin(x)
+    Interval cos;                   ///< cos(x)
+    Interval sinc;                  ///< sin(x) / x
+    Interval one_minus_cos_over_x2; ///< (1 - cos(x)) / x²
+};
+
+/// @brief Enclose sin, cos, sinc, and (1 - cos) / x² of x at once.
+///
+/// Evaluates truncated Taylor series at the endpoints of x in double
+/// precision and pads them with a bound on the truncation and rounding
+/// error, so unlike Boost's interval functions no rounding mode changes are
+/// needed.
+/// @pre is_small_angle(x)
+SmallAngleTrig small_angle_trig(const Interval& x);
+
+} // namespace ipc::rigid
@@ -0,0 +1,144 @@
+#include "asset_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#include <ghc/fs_std.hpp> // filesystem
+
+#include <logger.hpp>
+#include <utils/mapped_file.hpp>
+
+namespace ipc::rigid {
+
+// The version must be bumped whenever the layout of an entry or the
+// preprocessing in RigidBodyAsset changes.
+static const char CACHE_MAGIC[8] = { 'R', 'B', 'A', 'S', 'S', 'E', 'T', '\0' };
+static const uint32_t CACHE_VERSION = 2;
+
+/// @brief 64-bit FNV-1a hash of a byte range.
+static uint64_t fnv1a(const char* begin, const char* end)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (const char* c = begin; c != end; ++c) {
+        hash ^= uint8_t(*c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+bool AssetCache::open(const std::string& directory)
+{
+    close();
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec || !fs::is_directory(directory)) {
+        spdlog::error("Unable to create asset cache directory: {}", directory);
+        return false;
+    }
+    m_directory = directory;
+    spdlog::info("Using rigid body asset cache {}", directory);
+    return true;
+}
+
+std::string AssetCache::key(
+    const std::string& mesh_path, const nlohmann::json& settings)
+{
+    MappedFile mesh(mesh_path);
+    if (!mesh.is_open()) {
+        return "";
+    }
+    const std::string settings_str = settings.dump();
+    return fmt::format(
+        "{:016x}-{:x}-{:016x}", fnv1a(mesh.begin(), mesh.end()), mesh.size(),
+        fnv1a(settings_str.data(), settings_str.data() + settings_str.size()));
+}
+
+std::string AssetCache::entry_path(const std::string& key) const
+{
+    return (fs::path(m_directory) / (key + ".rbasset")).string();
+}
+
+bool AssetCache::load(
+    const std::string& key, std::vector<RigidBodyAsset>& assets) const
+{
+    if (!is_open()) {
+        return false;
+    }
+    MappedFile file(entry_path(key));
+    if (!file.is_open()) {
+        return false; // Not cached
+    }
+
+    BinaryReader in(file.begin(), file.end());
+    char magic[sizeof(CACHE_MAGIC)];
+    uint32_t version;
+    uint64_t num_assets;
+    if (!in.read(magic, sizeof(magic))
+        || std::memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+        || !in.read(version) || version != CACHE_VERSION
+        || !in.read(num_assets)) {
+        spdlog::warn("Ignoring outdated asset cache entry {}", key);
+        return false;
+    }
+    // Every asset takes at least one byte, so a larger count is corrupted
+    if (num_assets > in.remaining()) {
+        spdlog::warn("Ignoring corrupted asset cache entry {}", key);
+        assets.clear();
+        return false;
+    }
+    assets.resize(num_assets);
+    for (RigidBodyAsset& asset : assets) {
+        if (!asset.read(in)) {
+            spdlog::warn("Ignoring corrupted asset cache entry {}", key);
+            assets.clear();
+            return false;
+        }
+    }
+    spdlog::debug("Loaded {:d} assets from the cache ({})", num_assets, key);
+    return true;
+}
+
+bool AssetCache::store(
+    const std::string& key, const std::vector<RigidBodyAsset>& assets) const
+{
+    if (!is_open()) {
+        return false;
+    }
+    const std::string path = entry_path(key);
+    // Unique per writer, so concurrent writers of an entry do not collide
+    std::random_device random;
+    const std::string tmp_path =
+        fmt::format("{}.{:08x}{:08x}.tmp", path, random(), random());
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        write_binary(out, CACHE_VERSION);
+        write_binary(out, uint64_t(assets.size()));
+        for (const RigidBodyAsset& asset : assets) {
+            asset.write(out);
+        }
+        if (!out) {
+            spdlog::warn("Unable to write asset cache entry {}", tmp_path);
+            out.close();
+            fs::remove(tmp_path);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        spdlog::warn("Unable to write asset cache entry {}", path);
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+AssetCache& asset_cache()
+{
+    static AssetCache cache;
+    return cache;
+}
+
+} // namespace ipc::rigid
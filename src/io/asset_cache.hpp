@@ -0,0 +1,51 @@
+// On-disk cache of preprocessed rigid body assets.
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <physics/rigid_body_asset.hpp>
+
+namespace ipc::rigid {
+
+/// @brief Directory of preprocessed rigid body assets keyed by the content of
+/// the mesh file and the settings they were built with.
+///
+/// Each entry is a binary file holding all assets built from one scene entry
+/// (more than one if the mesh is split into components). Entries are written
+/// to a temporary file and renamed, so concurrent runs can share a cache.
+class AssetCache {
+public:
+    /// @brief Use the given directory (created if needed) for the cache.
+    bool open(const std::string& directory);
+
+    void close() { m_directory.clear(); }
+
+    bool is_open() const { return !m_directory.empty(); }
+
+    /// @brief Key of the assets built from a mesh file.
+    /// @param settings Scene settings the preprocessing depends on.
+    /// @return The key or an empty string if the mesh cannot be read.
+    static std::string
+    key(const std::string& mesh_path, const nlohmann::json& settings);
+
+    /// @brief Load the assets of the given key if they are cached.
+    bool load(const std::string& key, std::vector<RigidBodyAsset>& assets) const;
+
+    /// @brief Add the assets of the given key to the cache.
+    bool store(
+        const std::string& key,
+        const std::vector<RigidBodyAsset>& assets) const;
+
+protected:
+    std::string entry_path(const std::string& key) const;
+
+    std::string m_directory;
+};
+
+/// @brief Cache used when reading scenes (closed by default).
+AssetCache& asset_cache();
+
+} // namespace ipc::rigid
@@ -0,0 +1,99 @@
+#include "metrics_log.hpp"
+
+#include <logger.hpp>
+
+namespace ipc::rigid {
+
+bool MetricsLog::open(const std::string& path, MetricsFormat format)
+{
+    close();
+
+    m_file.open(path, std::ios::trunc);
+    if (!m_file) {
+        spdlog::error("Unable to open metrics log: {}", path);
+        return false;
+    }
+    m_format = format;
+    m_csv_columns.clear();
+    m_is_closing = false;
+    m_writer = std::thread(&MetricsLog::write_loop, this);
+    spdlog::info("Logging the metrics of each step to {}", path);
+    return true;
+}
+
+void MetricsLog::close()
+{
+    if (!m_writer.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock lock(m_queue_mutex);
+        m_is_closing = true;
+    }
+    m_queue_cv.notify_one();
+    m_writer.join();
+    m_file.close();
+}
+
+void MetricsLog::append(nlohmann::json record)
+{
+    if (!is_open()) {
+        return;
+    }
+    {
+        std::scoped_lock lock(m_queue_mutex);
+        m_queue.push_back(std::move(record));
+    }
+    m_queue_cv.notify_one();
+}
+
+void MetricsLog::write_loop()
+{
+    std::deque<nlohmann::json> records;
+    while (true) {
+        {
+            std::unique_lock lock(m_queue_mutex);
+            m_queue_cv.wait(
+                lock, [&] { return !m_queue.empty() || m_is_closing; });
+            if (m_queue.empty()) {
+                return; // Closing and everything is written
+            }
+            records.swap(m_queue);
+        }
+        // Write without holding the lock, so append() does not wait
+        for (const nlohmann::json& record : records) {
+            write(record);
+        }
+        records.clear();
+        m_file.flush();
+    }
+}
+
+void MetricsLog::write(const nlohmann::json& record)
+{
+    if (m_format == MetricsFormat::JSON_LINES) {
+        m_file << record.dump() << "\n";
+        return;
+    }
+
+    // The columns are fixed by the first record
+    if (m_csv_columns.empty()) {
+        for (const auto& item : record.items()) {
+            m_csv_columns.push_back(item.key());
+        }
+        for (size_t i = 0; i < m_csv_columns.size(); i++) {
+            m_file << (i ? "," : "") << m_csv_columns[i];
+        }
+        m_file << "\n";
+    }
+    for (size_t i = 0; i < m_csv_columns.size(); i++) {
+        const auto value = record.find(m_csv_columns[i]);
+        m_file << (i ? "," : "");
+        if (value != record.end() && !value->is_null()) {
+            m_file << value->dump();
+        }
+    }
+    m_file << "\n";
+}
+
+} // namespace ipc::rigid
@@ -0,0 +1,60 @@
+// Per-step metrics stream written in the background.
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace ipc::rigid {
+
+enum class MetricsFormat {
+    JSON_LINES, ///< One JSON object per line
+    CSV         ///< Header from the keys of the first record
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(
+    MetricsFormat,
+    { { MetricsFormat::JSON_LINES, "jsonl" }, { MetricsFormat::CSV, "csv" } })
+
+/// @brief Append-only log of flat JSON records (one per time-step).
+///
+/// Records are queued and written by a background thread, so appending
+/// never waits on the file system. Each record is flushed once written, so
+/// the log can be followed while the simulation runs.
+class MetricsLog {
+public:
+    ~MetricsLog() { close(); }
+
+    /// @brief Start logging to the given file (overwritten).
+    bool open(const std::string& path, MetricsFormat format);
+
+    /// @brief Write all queued records and stop logging.
+    void close();
+
+    bool is_open() const { return m_writer.joinable(); }
+
+    /// @brief Queue a record for writing.
+    void append(nlohmann::json record);
+
+protected:
+    void write_loop();
+    void write(const nlohmann::json& record);
+
+    std::ofstream m_file;
+    MetricsFormat m_format;
+    std::vector<std::string> m_csv_columns;
+
+    std::thread m_writer;
+    std::mutex m_queue_mutex;
+    std::condition_variable m_queue_cv;
+    std::deque<nlohmann::json> m_queue;
+    bool m_is_closing = false;
+};
+
+} // namespace ipc::rigid
@@ -9,16 +9,22 @@
 
 #include "read_obj.hpp"
 
+#include <charconv>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 #include <igl/edges.h>
 #include <igl/list_to_matrix.h>
 
 #include <logger.hpp>
+#include <utils/mapped_file.hpp>
 
 namespace ipc::rigid {
 
@@ -253,41 +259,235 @@ bool read_obj(
     return read_obj(obj_file_name, V, TC, N, F, FTC, FN, L);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Fast reader of V, E, and F
+
+namespace {
+    /// @brief Line-by-line cursor over the text of an obj file.
+    class OBJLines {
+    public:
+        OBJLines(const char* begin, const char* end)
+            : m_next(begin)
+            , m_end(end)
+        {
+        }
+
+        /// @brief Advance to the next line.
+        /// @return False at the end of the file.
+        bool next()
+        {
+            if (m_next >= m_end) {
+                return false;
+            }
+            pos = m_next;
+            const char* newline =
+                static_cast<const char*>(std::memchr(pos, '\n', m_end - pos));
+            end = newline ? newline : m_end;
+            m_next = newline ? newline + 1 : m_end;
+            if (end > pos && end[-1] == '\r') {
+                end--;
+            }
+            line_no++;
+            return true;
+        }
+
+        static bool is_space(char c) { return c == ' ' || c == '\t'; }
+
+        void skip_spaces()
+        {
+            while (pos < end && is_space(*pos)) {
+                pos++;
+            }
+        }
+
+        /// @brief Read the next whitespace-separated word.
+        std::string_view word()
+        {
+            skip_spaces();
+            const char* begin = pos;
+            while (pos < end && !is_space(*pos)) {
+                pos++;
+            }
+            return std::string_view(begin, pos - begin);
+        }
+
+        /// @brief Number of words left on the line.
+        int count_words()
+        {
+            const char* begin = pos;
+            int count = 0;
+            while (!word().empty()) {
+                count++;
+            }
+            pos = begin;
+            return count;
+        }
+
+        /// @brief Skip the rest of the current word.
+        void skip_word()
+        {
+            while (pos < end && !is_space(*pos)) {
+                pos++;
+            }
+        }
+
+        /// @brief Parse a number at the start of the next word.
+        template <typename T> bool parse(T& value)
+        {
+            skip_spaces();
+            if (pos < end && *pos == '+') {
+                pos++; // Not accepted by from_chars
+            }
+#ifndef __cpp_lib_to_chars
+            // No floating-point from_chars in this standard library
+            if constexpr (std::is_floating_point_v<T>) {
+                const char* word_end = pos;
+                while (word_end < end && !is_space(*word_end)) {
+                    word_end++;
+                }
+                const std::string word(pos, word_end);
+                char* parse_end;
+                value = std::strtod(word.c_str(), &parse_end);
+                if (parse_end == word.c_str()) {
+                    return false;
+                }
+                pos += parse_end - word.c_str();
+            } else
+#endif
+            {
+                const std::from_chars_result result =
+                    std::from_chars(pos, end, value);
+                if (result.ec != std::errc()) {
+                    return false;
+                }
+                pos = result.ptr;
+            }
+            return pos == end || is_space(*pos) || *pos == '/';
+        }
+
+        const char* pos = nullptr; ///< Current position in the line
+        const char* end = nullptr; ///< End of the line
+        int line_no = 0;
+
+    protected:
+        const char* m_next;
+        const char* m_end;
+    };
+} // namespace
+
 bool read_obj(
     const std::string str,
     Eigen::MatrixXd& V,
     Eigen::MatrixXi& E,
     Eigen::MatrixXi& F)
 {
-    std::vector<std::vector<double>> vV, vTC, vN;
-    std::vector<std::vector<int>> vF, vFTC, vFN, vL;
-    bool success = read_obj(str, vV, vTC, vN, vF, vFTC, vFN, vL);
-    if (!success) {
-        // read_obj(str,vV,vTC,vN,vF,vFTC,vFN) should have already printed
-        // an error message
-        return false;
-    }
-    bool V_rect = igl::list_to_matrix(vV, V);
-    if (!V_rect) {
-        // igl::list_to_matrix(vV,V) already printed error message
+    MappedFile file(str);
+    if (!file.is_open()) {
+        spdlog::error("read_obj: {:s} could not be opened!", str);
         return false;
     }
-    bool F_rect = igl::list_to_matrix(vF, F);
-    if (!F_rect) {
-        // igl::list_to_matrix(vF,F) already printed error message
-        return false;
-    }
-    std::vector<std::vector<int>> vE;
-    for (const std::vector<int>& polyline : vL) {
-        for (int i = 1; i < polyline.size(); i++) {
-            vE.push_back({ { polyline[i - 1], polyline[i] } });
+
+    // First pass: count the elements to allocate the matrices once
+    int num_vertices = 0, vertex_dim = 0;
+    int num_faces = 0, face_degree = 0;
+    int num_polyline_edges = 0;
+    OBJLines lines(file.begin(), file.end());
+    while (lines.next()) {
+        const std::string_view type = lines.word();
+        if (type == "v") {
+            if (num_vertices++ == 0) {
+                vertex_dim = lines.count_words();
+            }
+        } else if (type == "f") {
+            if (num_faces++ == 0) {
+                face_degree = lines.count_words();
+            }
+        } else if (type == "l") {
+            num_polyline_edges += std::max(lines.count_words() - 1, 0);
         }
     }
-    bool E_rect = igl::list_to_matrix(vE, E);
-    if (!E_rect) {
-        spdlog::error("read_obj: edges not rectangular matrix!");
-        return false;
+
+    V.resize(num_vertices, vertex_dim);
+    F.resize(num_faces, face_degree);
+    E.resize(num_polyline_edges, 2);
+
+    // Second pass: fill in the matrices
+    // Negative indices are relative to the vertices read so far
+    int vi = 0, fi = 0, ei = 0;
+    const auto shift = [&vi](long i) -> int {
+        return i < 0 ? i + vi : i - 1;
+    };
+    lines = OBJLines(file.begin(), file.end());
+    while (lines.next()) {
+        const std::string_view type = lines.word();
+        if (type == "v") {
+            for (int j = 0; j < vertex_dim; j++) {
+                if (!lines.parse(V(vi, j))) {
+                    spdlog::error(
+                        "read_obj: vertex on line {:d} should have {:d} "
+                        "coordinates",
+                        lines.line_no, vertex_dim);
+                    return false;
+                }
+            }
+            if (!lines.word().empty()) {
+                spdlog::error(
+                    "read_obj: vertex on line {:d} should have {:d} "
+                    "coordinates",
+                    lines.line_no, vertex_dim);
+                return false;
+            }
+            vi++;
+        } else if (type == "f") {
+            for (int j = 0; j < face_degree; j++) {
+                long i;
+                if (!lines.parse(i)) {
+                    spdlog::error(
+                        "read_obj: face on line {:d} has invalid element "
+                        "format",
+                        lines.line_no);
+                    return false;
+                }
+                F(fi, j) = shift(i);
+                lines.skip_word(); // Skip the texture and normal indices
+            }
+            if (!lines.word().empty()) {
+                spdlog::error(
+                    "read_obj: faces are not all of degree {:d} (line {:d})",
+                    face_degree, lines.line_no);
+                return false;
+            }
+            fi++;
+        } else if (type == "l") {
+            long i;
+            int num_polyline_vertices = 0, prev_vi;
+            while (lines.parse(i)) {
+                if (num_polyline_vertices++ > 0) {
+                    E.row(ei++) << prev_vi, shift(i);
+                }
+                prev_vi = shift(i);
+            }
+            if (num_polyline_vertices < 2 || !lines.word().empty()) {
+                spdlog::error(
+                    "read_obj: line element on line {:d} should have at "
+                    "least 2 vertices",
+                    lines.line_no);
+                return false;
+            }
+        } else if (
+            type.empty() || type[0] == '#' || type[0] == 'g' || type[0] == 's'
+            || type[0] == 'o' || type == "vn" || type == "vt"
+            || type == "usemtl" || type == "mtllib") {
+            // ignore comments or other stuff
+        } else {
+            spdlog::warn(
+                "read_obj: ignored non-comment line {:d}: {:s}", lines.line_no,
+                std::string(type.data(), lines.end));
+        }
     }
+    assert(vi == num_vertices && fi == num_faces);
+    assert(ei == num_polyline_edges);
+
     if (F.size()) {
         Eigen::MatrixXi faceE;
         igl::edges(F, faceE);
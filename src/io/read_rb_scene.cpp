@@ -9,8 +9,10 @@
 #include <igl/PI.h>
 #include <igl/read_triangle_mesh.h>
 #include <igl/remove_unreferenced.h>
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_sort.h>
 
+#include <io/asset_cache.hpp>
 #include <io/read_obj.hpp>
 #include <io/serialize_json.hpp>
 #include <logger.hpp>
@@ -53,67 +55,96 @@ VectorMax3d read_angular_field(const nlohmann::json& field, int dim)
     return v;
 }
 
-bool read_rb_scene(const nlohmann::json& scene, std::vector<RigidBody>& rbs)
+/// @brief Scale and rotate the vertices around the model origin.
+static void transform_vertices(
+    const nlohmann::json& args, int dim, Eigen::MatrixXd& vertices)
+{
+    VectorMax3d scale;
+    // Dimensions overrides a scale argument
+    if (args.contains("dimensions")) {
+        VectorMax3d initial_dimensions =
+            (vertices.colwise().maxCoeff() - vertices.colwise().minCoeff())
+                .cwiseAbs();
+        initial_dimensions =
+            (initial_dimensions.array() == 0).select(1, initial_dimensions);
+        from_json(args["dimensions"], scale);
+        assert(scale.size() >= dim);
+        scale.conservativeResize(dim);
+        scale.array() /= initial_dimensions.array();
+    } else if (args["scale"].is_number()) {
+        scale.setConstant(dim, args["scale"].get<double>());
+    } else {
+        from_json(args["scale"], scale);
+        assert(scale.size() >= dim);
+        scale.conservativeResize(dim);
+    }
+    vertices *= scale.asDiagonal();
+
+    // Rotate around the models origin NOT the rigid bodies center of mass
+    VectorMax3d rotation = read_angular_field(args["rotation"], dim);
+    MatrixMax3d R;
+    if (rotation.size() == 3) {
+        R = (Eigen::AngleAxisd(rotation.z(), Eigen::Vector3d::UnitZ())
+             * Eigen::AngleAxisd(rotation.y(), Eigen::Vector3d::UnitY())
+             * Eigen::AngleAxisd(rotation.x(), Eigen::Vector3d::UnitX()))
+                .toRotationMatrix();
+    } else {
+        R = Eigen::Rotation2Dd(rotation(0)).toRotationMatrix();
+    }
+    vertices = vertices * R.transpose();
+}
+
+/// @brief Settings of a body entry that its preprocessed assets depend on.
+static nlohmann::json
+asset_settings(const nlohmann::json& args, const fs::path& mesh_path)
+{
+    nlohmann::json settings;
+    settings["loader"] = mesh_path.extension() == ".obj" ? "obj" : "igl";
+    for (const char* key :
+         { "scale", "dimensions", "rotation", "density", "is_dof_fixed",
+           "split_components" }) {
+        if (args.contains(key)) {
+            settings[key] = args[key];
+        }
+    }
+    return settings;
+}
+
+/// @brief Load the bodies of one scene entry.
+/// @param args Settings of the entry with the defaults filled in.
+/// @param[out] rbs Bodies of the entry (more than one if split).
+/// @param[out] dim Dimension of the bodies.
+static bool load_rigid_bodies(
+    const nlohmann::json& args, std::vector<RigidBody>& rbs, int& dim)
 {
     using namespace nlohmann;
-    int dim = -1, ndof, angular_dim;
 
-    std::unordered_map<std::string, int> rb_name_to_count;
+    Eigen::MatrixXd vertices;
+    Eigen::MatrixXi faces, edges;
+    std::string rb_name;
 
-    for (auto& jrb : scene["rigid_bodies"]) {
-        // NOTE:
-        // All units by default are expressed in standard SI units
-        // density: units of Kg/m³ (default density of plastic)
-        // position: position of the model origin
-        // rotation: degrees as xyz euler angles around the model origin
-        // scale: scale the vertices around the model origin
-        // linear_velocity: velocity of the body's center
-        // angular_velocity: world coordinates in degrees
-        // force: applied to center of mass
-        // torque: world coordinates in degrees
-        json args = R"({
-                "mesh": "",
-                "vertices": [],
-                "edges": [],
-                "faces": [],
-                "density": 1000.0,
-                "is_dof_fixed": [false, false, false, false, false, false],
-                "oriented": false,
-                "group_id": -1,
-                "position": [0.0, 0.0, 0.0],
-                "rotation": [0.0, 0.0, 0.0],
-                "scale": [1.0, 1.0, 1.0],
-                "linear_velocity": [0.0, 0.0, 0.0],
-                "angular_velocity": [0.0, 0.0, 0.0],
-                "force": [0.0, 0.0, 0.0],
-                "torque": [0.0, 0.0, 0.0],
-                "enabled": true,
-                "type": "dynamic",
-                "kinematic_max_time": -1,
-                "kinematic_poses": [],
-                "split_components": false
-            })"_json;
-        args.merge_patch(jrb);
-        if (args["kinematic_max_time"] < 0) {
-            args["kinematic_max_time"] =
-                std::numeric_limits<double>::infinity();
-        }
+    // Preprocessed geometry of the bodies of this entry
+    std::vector<RigidBodyAsset> assets;
+    std::string cache_key;
 
-        if (!args["enabled"].get<bool>()) {
-            continue;
+    std::string mesh_fname = args["mesh"].get<std::string>();
+    if (mesh_fname != "") {
+        fs::path mesh_path(mesh_fname);
+        if (!exists(mesh_path)) {
+            // TODO: First check a path relative to the input file
+            mesh_path = fs::path(RIGID_IPC_MESHES_DIR) / mesh_path;
         }
+        rb_name = mesh_path.stem().string();
 
-        Eigen::MatrixXd vertices;
-        Eigen::MatrixXi faces, edges;
-        std::string rb_name;
-
-        std::string mesh_fname = args["mesh"].get<std::string>();
-        if (mesh_fname != "") {
-            fs::path mesh_path(mesh_fname);
-            if (!exists(mesh_path)) {
-                // TODO: First check a path relative to the input file
-                mesh_path = fs::path(RIGID_IPC_MESHES_DIR) / mesh_path;
+        if (asset_cache().is_open()) {
+            cache_key = AssetCache::key(
+                mesh_path.string(), asset_settings(args, mesh_path));
+            if (!cache_key.empty() && asset_cache().load(cache_key, assets)) {
+                cache_key.clear(); // Nothing to store
             }
+        }
+
+        if (assets.empty()) {
             spdlog::info("loading mesh: {:s}", mesh_path.string());
             bool success;
             if (mesh_path.extension() == ".obj") {
@@ -130,120 +161,80 @@ bool read_rb_scene(const nlohmann::json& scene, std::vector<RigidBody>& rbs)
             if (!success) {
                 return false;
             }
-
-            rb_name = mesh_path.stem().string();
-        } else {
-            // Assumes that edges contains the edges of the faces too.
-            from_json(args["vertices"], vertices);
-            from_json(args["edges"], edges);
-            from_json(args["faces"], faces);
-            rb_name = "RigidBody";
         }
+    } else {
+        // Assumes that edges contains the edges of the faces too.
+        from_json(args["vertices"], vertices);
+        from_json(args["edges"], edges);
+        from_json(args["faces"], faces);
+        rb_name = "RigidBody";
+    }
 
-        if (dim == -1) {
-            if (vertices.cols() != 0) { // Why would we have an empty body?
-                dim = vertices.cols();
-                ndof = PoseD::dim_to_ndof(dim);
-                angular_dim = dim == 2 ? 1 : 3;
-            }
-        } else if (dim != vertices.cols()) {
-            spdlog::error("Mixing 2D and 3D bodies are not currently allowed.");
-            throw NotImplementedError(
-                "Mixing 2D and 3D bodies are not currently allowed.");
-        }
+    dim = assets.empty() ? int(vertices.cols()) : assets.front().dim();
+    const int ndof = PoseD::dim_to_ndof(dim);
+    const int angular_dim = dim == 2 ? 1 : 3;
 
-        if (dim == 2 && faces.size() != 0) {
-            spdlog::warn("Ignoring faces for 2D rigid body.");
-            // Delete the faces since they will not be uses
-            faces.resize(0, 0);
-        }
+    if (dim == 2 && faces.size() != 0) {
+        spdlog::warn("Ignoring faces for 2D rigid body.");
+        // Delete the faces since they will not be uses
+        faces.resize(0, 0);
+    }
 
-        VectorMax3d position;
-        from_json(args["position"], position);
-        assert(position.size() >= dim);
-        position.conservativeResize(dim);
-
-        VectorMax3d scale;
-        // Dimensions overrides a scale argument
-        if (args.contains("dimensions")) {
-            VectorMax3d initial_dimensions =
-                (vertices.colwise().maxCoeff() - vertices.colwise().minCoeff())
-                    .cwiseAbs();
-            initial_dimensions =
-                (initial_dimensions.array() == 0).select(1, initial_dimensions);
-            from_json(args["dimensions"], scale);
-            assert(scale.size() >= dim);
-            scale.conservativeResize(dim);
-            scale.array() /= initial_dimensions.array();
-        } else if (args["scale"].is_number()) {
-            scale.setConstant(dim, args["scale"].get<double>());
-        } else {
-            from_json(args["scale"], scale);
-            assert(scale.size() >= dim);
-            scale.conservativeResize(dim);
-        }
-        vertices *= scale.asDiagonal();
-
-        // Rotate around the models origin NOT the rigid bodies center of mass
-        VectorMax3d rotation = read_angular_field(args["rotation"], dim);
-        MatrixMax3d R;
-        if (rotation.size() == 3) {
-            R = (Eigen::AngleAxisd(rotation.z(), Eigen::Vector3d::UnitZ())
-                 * Eigen::AngleAxisd(rotation.y(), Eigen::Vector3d::UnitY())
-                 * Eigen::AngleAxisd(rotation.x(), Eigen::Vector3d::UnitX()))
-                    .toRotationMatrix();
-        } else {
-            R = Eigen::Rotation2Dd(rotation(0)).toRotationMatrix();
-        }
-        vertices = vertices * R.transpose();
-        rotation.setZero(angular_dim); // Zero initial body rotation
+    VectorMax3d position;
+    from_json(args["position"], position);
+    assert(position.size() >= dim);
+    position.conservativeResize(dim);
 
-        VectorMax3d linear_velocity;
-        from_json(args["linear_velocity"], linear_velocity);
-        assert(linear_velocity.size() >= dim);
-        linear_velocity.conservativeResize(dim);
+    VectorMax3d linear_velocity;
+    from_json(args["linear_velocity"], linear_velocity);
+    assert(linear_velocity.size() >= dim);
+    linear_velocity.conservativeResize(dim);
 
-        VectorMax3d angular_velocity =
-            read_angular_field(args["angular_velocity"], dim);
+    VectorMax3d angular_velocity =
+        read_angular_field(args["angular_velocity"], dim);
 
-        VectorMax3d force;
-        from_json(args["force"], force);
-        assert(force.size() >= dim);
-        force.conservativeResize(dim);
+    VectorMax3d force;
+    from_json(args["force"], force);
+    assert(force.size() >= dim);
+    force.conservativeResize(dim);
 
-        VectorMax3d torque = read_angular_field(args["torque"], dim);
+    VectorMax3d torque = read_angular_field(args["torque"], dim);
 
-        VectorXb is_dof_fixed;
-        if (args["is_dof_fixed"].is_boolean()) {
-            is_dof_fixed.setConstant(ndof, args["is_dof_fixed"].get<bool>());
-        } else {
-            from_json(args["is_dof_fixed"], is_dof_fixed);
-            assert(is_dof_fixed.size() >= ndof);
-            is_dof_fixed.conservativeResize(ndof);
-        }
+    VectorXb is_dof_fixed;
+    if (args["is_dof_fixed"].is_boolean()) {
+        is_dof_fixed.setConstant(ndof, args["is_dof_fixed"].get<bool>());
+    } else {
+        from_json(args["is_dof_fixed"], is_dof_fixed);
+        assert(is_dof_fixed.size() >= ndof);
+        is_dof_fixed.conservativeResize(ndof);
+    }
 
-        double density = args["density"];
-        bool is_oriented = args["oriented"];
+    double density = args["density"];
+    bool is_oriented = args["oriented"];
 
-        int group_id = args["group_id"];
+    int group_id = args["group_id"];
 
-        RigidBodyType rb_type = args["type"];
-        double kinematic_max_time = args["kinematic_max_time"];
+    RigidBodyType rb_type = args["type"];
+    double kinematic_max_time = args["kinematic_max_time"];
 
-        std::vector<json> json_kinematic_poses = args["kinematic_poses"];
-        std::deque<PoseD> kinematic_poses;
-        for (const auto& json_pose : json_kinematic_poses) {
-            PoseD pose = PoseD::Zero(dim);
-            if (json_pose.contains("position")) {
-                from_json(json_pose["position"], pose.position);
-            }
-            if (json_pose.contains("rotation")) {
-                from_json(json_pose["rotation"], pose.rotation);
-            }
-            kinematic_poses.push_back(pose);
+    std::vector<json> json_kinematic_poses = args["kinematic_poses"];
+    std::deque<PoseD> kinematic_poses;
+    for (const auto& json_pose : json_kinematic_poses) {
+        PoseD pose = PoseD::Zero(dim);
+        if (json_pose.contains("position")) {
+            from_json(json_pose["position"], pose.position);
         }
+        if (json_pose.contains("rotation")) {
+            from_json(json_pose["rotation"], pose.rotation);
+        }
+        kinematic_poses.push_back(pose);
+    }
+
+    const bool split_components = args["split_components"].get<bool>();
+    if (assets.empty()) {
+        transform_vertices(args, dim, vertices);
 
-        if (args["split_components"].get<bool>()) {
+        if (split_components) {
             // TODO: Handle codimensional edges too
             assert(faces.cols() == 3);
             Eigen::VectorXi C;
@@ -265,26 +256,115 @@ bool read_rb_scene(const nlohmann::json& scene, std::vector<RigidBody>& rbs)
                 igl::remove_unreferenced(vertices, F, CV, CF, I);
                 Eigen::MatrixXi CE;
                 igl::edges(CF, CE);
-                // WARNING: angular velocity and torque will be around the
-                // components center of mass not the entire meshes.
-                rbs.emplace_back(
-                    CV, CE, CF, PoseD(position, VectorMax3d::Zero(angular_dim)),
-                    PoseD(linear_velocity, angular_velocity),
-                    PoseD(force, torque), density, is_dof_fixed, is_oriented,
-                    group_id, rb_type, kinematic_max_time, kinematic_poses);
-                rbs.back().name = fmt::format("{}-part{:03d}", rb_name, ci);
+                assets.emplace_back(CV, CE, CF, density, is_dof_fixed);
             }
         } else {
-            rbs.emplace_back(
-                vertices, edges, faces,
-                PoseD(position, VectorMax3d::Zero(angular_dim)),
-                PoseD(linear_velocity, angular_velocity), PoseD(force, torque),
-                density, is_dof_fixed, is_oriented, group_id, rb_type,
-                kinematic_max_time, kinematic_poses);
-            rbs.back().name = rb_name;
+            assets.emplace_back(vertices, edges, faces, density, is_dof_fixed);
+        }
+
+        if (!cache_key.empty()) {
+            asset_cache().store(cache_key, assets);
         }
     }
 
+    for (int ci = 0; ci < assets.size(); ci++) {
+        // WARNING: for split components the angular velocity and torque will
+        // be around the components center of mass not the entire meshes.
+        rbs.emplace_back(
+            assets[ci], PoseD(position, VectorMax3d::Zero(angular_dim)),
+            PoseD(linear_velocity, angular_velocity), PoseD(force, torque),
+            is_dof_fixed, is_oriented, group_id, rb_type, kinematic_max_time,
+            kinematic_poses);
+        rbs.back().name = split_components
+            ? fmt::format("{}-part{:03d}", rb_name, ci)
+            : rb_name;
+    }
+
+    return true;
+}
+
+bool read_rb_scene(const nlohmann::json& scene, std::vector<RigidBody>& rbs)
+{
+    using namespace nlohmann;
+
+    // NOTE:
+    // All units by default are expressed in standard SI units
+    // density: units of Kg/m³ (default density of plastic)
+    // position: position of the model origin
+    // rotation: degrees as xyz euler angles around the model origin
+    // scale: scale the vertices around the model origin
+    // linear_velocity: velocity of the body's center
+    // angular_velocity: world coordinates in degrees
+    // force: applied to center of mass
+    // torque: world coordinates in degrees
+    const json default_args = R"({
+            "mesh": "",
+            "vertices": [],
+            "edges": [],
+            "faces": [],
+            "density": 1000.0,
+            "is_dof_fixed": [false, false, false, false, false, false],
+            "oriented": false,
+            "group_id": -1,
+            "position": [0.0, 0.0, 0.0],
+            "rotation": [0.0, 0.0, 0.0],
+            "scale": [1.0, 1.0, 1.0],
+            "linear_velocity": [0.0, 0.0, 0.0],
+            "angular_velocity": [0.0, 0.0, 0.0],
+            "force": [0.0, 0.0, 0.0],
+            "torque": [0.0, 0.0, 0.0],
+            "enabled": true,
+            "type": "dynamic",
+            "kinematic_max_time": -1,
+            "kinematic_poses": [],
+            "split_components": false
+        })"_json;
+
+    std::vector<json> entries;
+    for (auto& jrb : scene["rigid_bodies"]) {
+        json args = default_args;
+        args.merge_patch(jrb);
+        if (args["kinematic_max_time"] < 0) {
+            args["kinematic_max_time"] =
+                std::numeric_limits<double>::infinity();
+        }
+
+        if (args["enabled"].get<bool>()) {
+            entries.push_back(std::move(args));
+        }
+    }
+
+    // Meshes are loaded and preprocessed in parallel, but the bodies are
+    // gathered in the order of the scene.
+    std::vector<std::vector<RigidBody>> entry_rbs(entries.size());
+    std::vector<int> entry_dims(entries.size(), -1);
+    std::vector<char> entry_success(entries.size(), false);
+    tbb::parallel_for(size_t(0), entries.size(), [&](size_t i) {
+        entry_success[i] =
+            load_rigid_bodies(entries[i], entry_rbs[i], entry_dims[i]);
+    });
+
+    int dim = -1;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (!entry_success[i]) {
+            return false;
+        }
+        if (entry_dims[i] == 0) {
+            continue; // Why would we have an empty body?
+        } else if (dim == -1) {
+            dim = entry_dims[i];
+        } else if (dim != entry_dims[i]) {
+            spdlog::error("Mixing 2D and 3D bodies are not currently allowed.");
+            throw NotImplementedError(
+                "Mixing 2D and 3D bodies are not currently allowed.");
+        }
+    }
+    for (std::vector<RigidBody>& rbs_i : entry_rbs) {
+        rbs.insert(
+            rbs.end(), std::make_move_iterator(rbs_i.begin()),
+            std::make_move_iterator(rbs_i.end()));
+    }
+
     // Adjust the group ids, so the default ones are unique.
     std::unordered_set<int> static_group_ids;
     for (RigidBody& rb : rbs) {
@@ -7,6 +7,15 @@
 #include <nlohmann/json.hpp>
 #include <tiny_gltf.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+#include <logger.hpp>
+#include <profiler.hpp>
+
 namespace ipc::rigid {
 
 bool write_gltf(
@@ -31,6 +40,10 @@ bool write_gltf(
 
     assert(bodies.dim() == 3);
     size_t num_bodies = bodies.num_bodies();
+    // The poses are in the order of the scene file
+    const auto body = [&](size_t i) -> const RigidBody& {
+        return bodies[bodies.body_index(i)];
+    };
     assert(poses.size() > 0);
     size_t num_steps = poses.size();
 
@@ -68,7 +81,7 @@ bool write_gltf(
     for (int i = 0; i < num_bodies; i++) {
         Node& node = model.nodes[i];
         node.mesh = i;
-        node.name = bodies[i].name;
+        node.name = body(i).name;
         node.translation = { { poses[0][i].position.x(),
                                poses[0][i].position.y(),
                                poses[0][i].position.z() } };
@@ -90,37 +103,37 @@ bool write_gltf(
         animation.samplers[2 * i + 1].interpolation = "LINEAR";
 
         Mesh& mesh = model.meshes[i];
-        mesh.name = bodies[i].name;
+        mesh.name = body(i).name;
         Primitive& primitive = mesh.primitives.emplace_back();
         primitive.attributes["POSITION"] = 2 * i;
         primitive.indices = 2 * i + 1;
         primitive.mode = TINYGLTF_MODE_TRIANGLES;
 
         Accessor* accessor = &model.accessors[2 * i];
-        accessor->name = bodies[i].name + "Vertices";
+        accessor->name = body(i).name + "Vertices";
         accessor->bufferView = 2 * i;
         accessor->componentType = float_component_type;
-        accessor->count = bodies[i].num_vertices();
+        accessor->count = body(i).num_vertices();
         // accessor->max = ...;
         // accessor->min = ...;
         accessor->type = TINYGLTF_TYPE_VEC3;
 
         accessor = &model.accessors[2 * i + 1];
-        accessor->name = bodies[i].name + "Faces";
+        accessor->name = body(i).name + "Faces";
         accessor->bufferView = 2 * i + 1;
         accessor->componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
-        accessor->count = 3 * bodies[i].num_faces();
+        accessor->count = 3 * body(i).num_faces();
         accessor->type = TINYGLTF_TYPE_SCALAR;
 
         accessor = &model.accessors[2 * num_bodies + 2 * i + 1];
-        accessor->name = bodies[i].name + "Translations";
+        accessor->name = body(i).name + "Translations";
         accessor->bufferView = 2 * num_bodies + 2 * i + 1;
         accessor->componentType = float_component_type;
         accessor->count = num_steps;
         accessor->type = TINYGLTF_TYPE_VEC3;
 
         accessor = &model.accessors[2 * num_bodies + 2 * i + 2];
-        accessor->name = bodies[i].name + "Rotations";
+        accessor->name = body(i).name + "Rotations";
         accessor->bufferView = 2 * num_bodies + 2 * i + 2;
         accessor->componentType = float_component_type;
         accessor->count = num_steps;
@@ -135,16 +148,16 @@ bool write_gltf(
     size_t byte_offset = 0;
     for (int i = 0; i < num_bodies; i++) {
         BufferView* buffer_view = &model.bufferViews[2 * i];
-        buffer_view->name = bodies[i].name + "Vertices";
+        buffer_view->name = body(i).name + "Vertices";
         buffer_view->buffer = 0;
-        buffer_view->byteLength = sizeof(Float) * bodies[i].vertices.size();
+        buffer_view->byteLength = sizeof(Float) * body(i).vertices.size();
         buffer_view->byteOffset = byte_offset;
         byte_offset += buffer_view->byteLength;
 
         buffer_view = &model.bufferViews[2 * i + 1];
-        buffer_view->name = bodies[i].name + "Faces";
+        buffer_view->name = body(i).name + "Faces";
         buffer_view->buffer = 0;
-        buffer_view->byteLength = sizeof(unsigned int) * bodies[i].faces.size();
+        buffer_view->byteLength = sizeof(unsigned int) * body(i).faces.size();
         buffer_view->byteOffset = byte_offset;
         byte_offset += buffer_view->byteLength;
     }
@@ -159,14 +172,14 @@ bool write_gltf(
     for (int i = 0; i < num_bodies; i++) {
         BufferView* buffer_view =
             &model.bufferViews[2 * num_bodies + 2 * i + 1];
-        buffer_view->name = bodies[i].name + "Translations";
+        buffer_view->name = body(i).name + "Translations";
         buffer_view->buffer = 0;
         buffer_view->byteLength = 3 * sizeof(Float) * num_steps;
         buffer_view->byteOffset = byte_offset;
         byte_offset += buffer_view->byteLength;
 
         buffer_view = &model.bufferViews[2 * num_bodies + 2 * i + 2];
-        buffer_view->name = bodies[i].name + "Rotations";
+        buffer_view->name = body(i).name + "Rotations";
         buffer_view->buffer = 0;
         buffer_view->byteLength = 4 * sizeof(Float) * num_steps;
         buffer_view->byteOffset = byte_offset;
@@ -178,7 +191,7 @@ bool write_gltf(
     std::vector<unsigned char> byte_data(byte_offset);
     size_t byte_i = 0;
     for (int i = 0; i < num_bodies; i++) {
-        Eigen::MatrixXd V = bodies[i].vertices;
+        Eigen::MatrixXd V = body(i).vertices;
         for (int r = 0; r < V.rows(); r++) {
             for (int c = 0; c < V.cols(); c++) {
                 Float v = V(r, c);
@@ -187,7 +200,7 @@ bool write_gltf(
             }
         }
 
-        Eigen::MatrixXi F = bodies[i].faces;
+        Eigen::MatrixXi F = body(i).faces;
         for (int r = 0; r < F.rows(); r++) {
             for (int c = 0; c < F.cols(); c++) {
                 unsigned int fij = F(r, c);
@@ -229,4 +242,389 @@ bool write_gltf(
         /*embedImages=*/true, embed_buffers, prettyPrint, write_binary);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// GLBAnimationWriter
+
+// Sizes of the pose samples
+static const size_t TRANSLATION_SIZE = 3 * sizeof(float);
+static const size_t ROTATION_SIZE = 4 * sizeof(float);
+static const size_t QUANTIZED_ROTATION_SIZE = 4 * sizeof(int16_t);
+
+template <typename T>
+static void write_pod(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static size_t hash_mesh(const Eigen::MatrixXf& V, const Eigen::MatrixXi& F)
+{
+    size_t seed = std::hash<Eigen::Index>()(V.rows());
+    auto hash_combine = [&seed](size_t h) {
+        seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+    for (Eigen::Index i = 0; i < V.size(); i++) {
+        hash_combine(std::hash<float>()(V.data()[i]));
+    }
+    for (Eigen::Index i = 0; i < F.size(); i++) {
+        hash_combine(std::hash<int>()(F.data()[i]));
+    }
+    return seed;
+}
+
+bool GLBAnimationWriter::open(
+    const std::string& filename,
+    const RigidBodyAssembler& bodies,
+    double timestep,
+    bool quantize_rotations,
+    int frames_per_chunk)
+{
+    close();
+    if (bodies.dim() != 3) {
+        spdlog::error("GLB animations are only supported in 3D!");
+        return false;
+    }
+    if (frames_per_chunk <= 0) {
+        spdlog::error(
+            "Invalid number of frames per chunk {:d} (must be positive)!",
+            frames_per_chunk);
+        return false;
+    }
+
+    m_filename = filename;
+    m_samples_filename = filename + ".samples";
+    m_samples_file.open(
+        m_samples_filename,
+        std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_samples_file) {
+        spdlog::error("Unable to open file: {}", m_samples_filename);
+        return false;
+    }
+
+    m_timestep = timestep;
+    m_quantize_rotations = quantize_rotations;
+    m_frames_per_chunk = frames_per_chunk;
+
+    // Bodies loaded from the same mesh share identical body-frame vertices
+    m_meshes.clear();
+    m_body_meshes.resize(bodies.num_bodies());
+    m_body_names.resize(bodies.num_bodies());
+    std::unordered_map<size_t, std::vector<int>> meshes_by_hash;
+    for (size_t i = 0; i < bodies.num_bodies(); i++) {
+        // The poses are in the order of the scene file
+        const RigidBody& body = bodies[bodies.body_index(i)];
+        m_body_names[i] = body.name;
+        if (body.num_faces() == 0) {
+            m_body_meshes[i] = -1; // Nothing to render
+            continue;
+        }
+        Eigen::MatrixXf V = body.vertices.cast<float>();
+        const Eigen::MatrixXi& F = body.faces;
+
+        std::vector<int>& candidates = meshes_by_hash[hash_mesh(V, F)];
+        auto match = std::find_if(
+            candidates.begin(), candidates.end(), [&](int mesh_id) {
+                const Mesh& mesh = m_meshes[mesh_id];
+                return mesh.vertices.rows() == V.rows()
+                    && mesh.faces.rows() == F.rows() && mesh.vertices == V
+                    && mesh.faces == F;
+            });
+        if (match != candidates.end()) {
+            m_body_meshes[i] = *match;
+        } else {
+            m_body_meshes[i] = int(m_meshes.size());
+            candidates.push_back(m_body_meshes[i]);
+            m_meshes.push_back({ body.name, V, F });
+        }
+    }
+    spdlog::debug(
+        "Exporting {:d} distinct meshes for {:d} bodies", m_meshes.size(),
+        bodies.num_bodies());
+
+    m_initial_poses.clear();
+    m_num_frames = 0;
+    m_chunk.assign(
+        m_body_meshes.size() * m_frames_per_chunk * sample_size(), 0);
+    m_chunk_frames = 0;
+    m_is_open = true;
+    return true;
+}
+
+size_t GLBAnimationWriter::sample_size() const
+{
+    return TRANSLATION_SIZE
+        + (m_quantize_rotations ? QUANTIZED_ROTATION_SIZE : ROTATION_SIZE);
+}
+
+void GLBAnimationWriter::append(const PosesD& poses)
+{
+    assert(m_is_open);
+    assert(poses.size() == m_body_meshes.size());
+    if (m_num_frames == 0) {
+        m_initial_poses = poses;
+    }
+
+    // Each body has a block of translations followed by a block of rotations
+    const size_t body_size = m_frames_per_chunk * sample_size();
+    const size_t rotations_offset = m_frames_per_chunk * TRANSLATION_SIZE;
+    for (size_t i = 0; i < poses.size(); i++) {
+        unsigned char* body_data = &m_chunk[i * body_size];
+
+        Eigen::Vector3f p = poses[i].position.cast<float>();
+        std::memcpy(
+            body_data + m_chunk_frames * TRANSLATION_SIZE, p.data(),
+            TRANSLATION_SIZE);
+
+        Eigen::Quaternion<double> quat = poses[i].construct_quaternion();
+        Eigen::Vector4d q(quat.x(), quat.y(), quat.z(), quat.w());
+        if (m_quantize_rotations) {
+            // Normalized signed shorts as allowed for rotation samplers
+            Eigen::Array<int16_t, 4, 1> qi =
+                (32767 * q.array().max(-1).min(1)).round().cast<int16_t>();
+            std::memcpy(
+                body_data + rotations_offset
+                    + m_chunk_frames * QUANTIZED_ROTATION_SIZE,
+                qi.data(), QUANTIZED_ROTATION_SIZE);
+        } else {
+            Eigen::Vector4f qf = q.cast<float>();
+            std::memcpy(
+                body_data + rotations_offset + m_chunk_frames * ROTATION_SIZE,
+                qf.data(), ROTATION_SIZE);
+        }
+    }
+
+    m_num_frames++;
+    if (++m_chunk_frames == m_frames_per_chunk) {
+        flush_chunk();
+    }
+}
+
+void GLBAnimationWriter::flush_chunk()
+{
+    PROFILE_POINT("GLBAnimationWriter::flush_chunk");
+    PROFILE_START();
+
+    // A partial chunk is compacted, so it is laid out like a full chunk of
+    // m_chunk_frames frames.
+    const size_t body_size = m_frames_per_chunk * sample_size();
+    const size_t rotations_offset = m_frames_per_chunk * TRANSLATION_SIZE;
+    const size_t rotation_size = sample_size() - TRANSLATION_SIZE;
+    for (size_t i = 0; i < m_body_meshes.size(); i++) {
+        const char* body_data =
+            reinterpret_cast<const char*>(&m_chunk[i * body_size]);
+        m_samples_file.write(body_data, m_chunk_frames * TRANSLATION_SIZE);
+        m_samples_file.write(
+            body_data + rotations_offset, m_chunk_frames * rotation_size);
+    }
+    m_chunk_frames = 0;
+
+    PROFILE_END();
+}
+
+bool GLBAnimationWriter::close()
+{
+    if (!m_is_open) {
+        return false;
+    }
+    m_is_open = false;
+
+    bool success;
+    if (m_num_frames == 0) {
+        spdlog::error("No frames to write to {}", m_filename);
+        success = false;
+    } else {
+        if (m_chunk_frames > 0) {
+            flush_chunk();
+        }
+        success = write_glb();
+    }
+
+    m_samples_file.close();
+    std::remove(m_samples_filename.c_str());
+    m_chunk.clear();
+    m_chunk.shrink_to_fit();
+    return success;
+}
+
+bool GLBAnimationWriter::write_glb()
+{
+    PROFILE_POINT("GLBAnimationWriter::write_glb");
+    PROFILE_START();
+
+    using json = nlohmann::json;
+    const size_t num_bodies = m_body_meshes.size();
+    const size_t rotation_size = sample_size() - TRANSLATION_SIZE;
+
+    json gltf;
+    gltf["asset"] = { { "version", "2.0" }, { "generator", "RigidIPC" } };
+    gltf["scene"] = 0;
+    json& buffer_views = gltf["bufferViews"] = json::array();
+    json& accessors = gltf["accessors"] = json::array();
+
+    size_t byte_length = 0;
+    auto add_accessor = [&](const std::string& name, size_t view_length,
+                            int component_type, size_t count,
+                            const std::string& type) {
+        buffer_views.push_back({ { "buffer", 0 },
+                                 { "byteOffset", byte_length },
+                                 { "byteLength", view_length },
+                                 { "name", name } });
+        byte_length += view_length;
+        accessors.push_back({ { "bufferView", buffer_views.size() - 1 },
+                              { "componentType", component_type },
+                              { "count", count },
+                              { "type", type },
+                              { "name", name } });
+        return accessors.size() - 1;
+    };
+
+    json& meshes = gltf["meshes"] = json::array();
+    for (const Mesh& mesh : m_meshes) {
+        size_t vertices_accessor = add_accessor(
+            mesh.name + "Vertices", sizeof(float) * mesh.vertices.size(),
+            TINYGLTF_COMPONENT_TYPE_FLOAT, mesh.vertices.rows(), "VEC3");
+        Eigen::RowVector3f min = mesh.vertices.colwise().minCoeff();
+        Eigen::RowVector3f max = mesh.vertices.colwise().maxCoeff();
+        accessors[vertices_accessor]["min"] = { min.x(), min.y(), min.z() };
+        accessors[vertices_accessor]["max"] = { max.x(), max.y(), max.z() };
+
+        size_t faces_accessor = add_accessor(
+            mesh.name + "Faces", sizeof(unsigned int) * mesh.faces.size(),
+            TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, mesh.faces.size(),
+            "SCALAR");
+
+        meshes.push_back(
+            { { "name", mesh.name },
+              { "primitives",
+                { { { "attributes", { { "POSITION", vertices_accessor } } },
+                    { "indices", faces_accessor },
+                    { "mode", TINYGLTF_MODE_TRIANGLES } } } } });
+    }
+
+    size_t times_accessor = add_accessor(
+        "Times", sizeof(float) * m_num_frames, TINYGLTF_COMPONENT_TYPE_FLOAT,
+        m_num_frames, "SCALAR");
+    accessors[times_accessor]["min"] = { 0.0f };
+    accessors[times_accessor]["max"] = { float(
+        (m_num_frames - 1) * m_timestep) };
+
+    json& nodes = gltf["nodes"] = json::array();
+    json channels = json::array(), samplers = json::array();
+    for (size_t i = 0; i < num_bodies; i++) {
+        json node;
+        node["name"] = m_body_names[i];
+        if (m_body_meshes[i] >= 0) {
+            node["mesh"] = m_body_meshes[i];
+        }
+        const PoseD& pose = m_initial_poses[i];
+        node["translation"] = { pose.position.x(), pose.position.y(),
+                                pose.position.z() };
+        Eigen::Quaternion<double> q = pose.construct_quaternion();
+        node["rotation"] = { q.x(), q.y(), q.z(), q.w() };
+        nodes.push_back(node);
+
+        size_t translations_accessor = add_accessor(
+            m_body_names[i] + "Translations", TRANSLATION_SIZE * m_num_frames,
+            TINYGLTF_COMPONENT_TYPE_FLOAT, m_num_frames, "VEC3");
+        size_t rotations_accessor = add_accessor(
+            m_body_names[i] + "Rotations", rotation_size * m_num_frames,
+            m_quantize_rotations ? TINYGLTF_COMPONENT_TYPE_SHORT
+                                 : TINYGLTF_COMPONENT_TYPE_FLOAT,
+            m_num_frames, "VEC4");
+        if (m_quantize_rotations) {
+            accessors[rotations_accessor]["normalized"] = true;
+        }
+
+        samplers.push_back({ { "input", times_accessor },
+                             { "output", translations_accessor },
+                             { "interpolation", "LINEAR" } });
+        channels.push_back(
+            { { "sampler", samplers.size() - 1 },
+              { "target", { { "node", i }, { "path", "translation" } } } });
+        samplers.push_back({ { "input", times_accessor },
+                             { "output", rotations_accessor },
+                             { "interpolation", "LINEAR" } });
+        channels.push_back(
+            { { "sampler", samplers.size() - 1 },
+              { "target", { { "node", i }, { "path", "rotation" } } } });
+    }
+    std::vector<size_t> scene_nodes(num_bodies);
+    std::iota(scene_nodes.begin(), scene_nodes.end(), 0);
+    gltf["scenes"] = { { { "name", "RigidIPCSimulation" },
+                         { "nodes", scene_nodes } } };
+    gltf["animations"] = { { { "name", "Simulation" },
+                             { "channels", channels },
+                             { "samplers", samplers } } };
+    gltf["buffers"] = { { { "byteLength", byte_length } } };
+
+    // GLB chunks are padded to four bytes (all views are multiples of four)
+    assert(byte_length % 4 == 0);
+    std::string json_chunk = gltf.dump();
+    json_chunk.resize(4 * ((json_chunk.size() + 3) / 4), ' ');
+
+    std::ofstream out(m_filename, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        spdlog::error("Unable to open file: {}", m_filename);
+        PROFILE_END();
+        return false;
+    }
+    write_pod(out, uint32_t(0x46546C67)); // "glTF"
+    write_pod(out, uint32_t(2));
+    write_pod(out, uint32_t(12 + 8 + json_chunk.size() + 8 + byte_length));
+    write_pod(out, uint32_t(json_chunk.size()));
+    write_pod(out, uint32_t(0x4E4F534A)); // "JSON"
+    out.write(json_chunk.data(), json_chunk.size());
+    write_pod(out, uint32_t(byte_length));
+    write_pod(out, uint32_t(0x004E4942)); // "BIN"
+
+    for (const Mesh& mesh : m_meshes) {
+        Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor> V =
+            mesh.vertices;
+        out.write(
+            reinterpret_cast<const char*>(V.data()), sizeof(float) * V.size());
+        Eigen::Matrix<unsigned int, Eigen::Dynamic, 3, Eigen::RowMajor> F =
+            mesh.faces.cast<unsigned int>();
+        out.write(
+            reinterpret_cast<const char*>(F.data()),
+            sizeof(unsigned int) * F.size());
+    }
+    for (size_t i = 0; i < m_num_frames; i++) {
+        write_pod(out, float(i * m_timestep));
+    }
+
+    // Gather the samples of each body from all chunks
+    const size_t num_chunks =
+        (m_num_frames + m_frames_per_chunk - 1) / m_frames_per_chunk;
+    const size_t chunk_size =
+        num_bodies * m_frames_per_chunk * sample_size();
+    std::vector<char> buffer(m_frames_per_chunk * sample_size());
+    m_samples_file.flush();
+    for (size_t i = 0; i < num_bodies; i++) {
+        for (int block = 0; block < 2; block++) {
+            for (size_t c = 0; c < num_chunks; c++) {
+                const size_t chunk_frames = std::min<size_t>(
+                    m_frames_per_chunk, m_num_frames - c * m_frames_per_chunk);
+                size_t offset =
+                    c * chunk_size + i * chunk_frames * sample_size();
+                size_t length;
+                if (block == 0) {
+                    length = chunk_frames * TRANSLATION_SIZE;
+                } else {
+                    offset += chunk_frames * TRANSLATION_SIZE;
+                    length = chunk_frames * rotation_size;
+                }
+                m_samples_file.seekg(offset);
+                m_samples_file.read(buffer.data(), length);
+                out.write(buffer.data(), length);
+            }
+        }
+    }
+
+    bool success = bool(m_samples_file) && bool(out);
+    if (!success) {
+        spdlog::error("Unable to write animation to {}", m_filename);
+    }
+    PROFILE_END();
+    return success;
+}
+
 } // namespace ipc::rigid
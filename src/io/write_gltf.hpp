@@ -1,6 +1,8 @@
 #pragma once
 
+#include <fstream>
 #include <string>
+#include <vector>
 
 #include <physics/rigid_body_assembler.hpp>
 
@@ -15,4 +17,70 @@ bool write_gltf(
     bool write_binary = true,
     bool prettyPrint = true);
 
+/// @brief Streaming writer of a rigid body animation to a binary glTF file.
+///
+/// Each distinct mesh is stored once and instanced by the nodes of all bodies
+/// sharing it. The pose samples are written to a temporary file in chunks as
+/// frames are appended, so the whole animation is never held in memory. The
+/// GLB is assembled from the temporary file on close().
+class GLBAnimationWriter {
+public:
+    ~GLBAnimationWriter() { close(); }
+
+    /// @brief Start writing an animation of the given bodies.
+    /// @param filename Output GLB file (overwritten).
+    /// @param timestep Time between two frames.
+    /// @param quantize_rotations Store the rotations as normalized shorts.
+    /// @param frames_per_chunk Number of frames buffered in memory.
+    bool open(
+        const std::string& filename,
+        const RigidBodyAssembler& bodies,
+        double timestep,
+        bool quantize_rotations = false,
+        int frames_per_chunk = 64);
+
+    /// @brief Append the poses of all bodies (in the order of the scene file)
+    /// at the next frame.
+    void append(const PosesD& poses);
+
+    /// @brief Assemble the GLB file and remove the temporary file.
+    bool close();
+
+    bool is_open() const { return m_is_open; }
+
+    size_t num_frames() const { return m_num_frames; }
+
+protected:
+    /// @brief Bytes of the samples of one body and one frame.
+    size_t sample_size() const;
+    /// @brief Write the buffered frames to the temporary file.
+    void flush_chunk();
+    bool write_glb();
+
+    bool m_is_open = false;
+    std::string m_filename;
+    std::string m_samples_filename;
+    std::fstream m_samples_file;
+
+    double m_timestep;
+    bool m_quantize_rotations;
+    int m_frames_per_chunk;
+
+    /// @brief Mesh data of the distinct meshes.
+    struct Mesh {
+        std::string name;
+        Eigen::MatrixXf vertices;
+        Eigen::MatrixXi faces;
+    };
+    std::vector<Mesh> m_meshes;
+    std::vector<int> m_body_meshes; ///< Mesh of each body (-1 if none)
+    std::vector<std::string> m_body_names;
+
+    PosesD m_initial_poses;
+    size_t m_num_frames;
+    /// @brief Samples of the current chunk grouped by body.
+    std::vector<unsigned char> m_chunk;
+    int m_chunk_frames; ///< Number of frames in the current chunk
+};
+
 } // namespace ipc::rigid
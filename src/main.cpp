@@ -9,6 +9,8 @@
 #include <ghc/fs_std.hpp> // filesystem
 
 #include <SimState.hpp>
+#include <ccd/query_log.hpp>
+#include <io/asset_cache.hpp>
 #ifdef RIGID_IPC_WITH_OPENGL
 #include <viewer/UISimState.hpp>
 #endif
@@ -69,6 +71,35 @@ int main(int argc, char* argv[])
     app.add_option("--patch", patch, "patch to input file (ngui only)")
         ->default_val(patch);
 
+    std::string ccd_query_log_path = "";
+    app.add_option(
+        "--ccd-query-log", ccd_query_log_path,
+        "binary file to record the narrow-phase CCD queries in");
+
+    double ccd_query_sample_rate = 1;
+    app.add_option(
+           "--ccd-query-sample-rate", ccd_query_sample_rate,
+           "fraction of the CCD queries to record")
+        ->default_val(ccd_query_sample_rate);
+
+    std::string asset_cache_dir = "";
+    app.add_option(
+        "--asset-cache", asset_cache_dir,
+        "directory to cache the preprocessed body meshes in");
+
+    std::string metrics_path = "";
+    app.add_option(
+        "--metrics", metrics_path,
+        "file to append the metrics of each step to (ngui only)");
+
+    MetricsFormat metrics_format = MetricsFormat::JSON_LINES;
+    app.add_option("--metrics-format", metrics_format, "format of the metrics")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, MetricsFormat>(
+                { { "jsonl", MetricsFormat::JSON_LINES },
+                  { "csv", MetricsFormat::CSV } }),
+            CLI::ignore_case));
+
     CLI11_PARSE(app, argc, argv);
 
     set_logger_level(loglevel);
@@ -86,8 +117,17 @@ int main(int argc, char* argv[])
     tbb::global_control thread_limiter(
         tbb::global_control::max_allowed_parallelism, nthreads);
 
+    if (!asset_cache_dir.empty() && !asset_cache().open(asset_cache_dir)) {
+        return 1;
+    }
+
     if (with_viewer) {
 #ifdef RIGID_IPC_WITH_OPENGL
+        if (!ccd_query_log_path.empty()
+            && !ccd_query_log().open(
+                ccd_query_log_path, ccd_query_sample_rate)) {
+            return 1;
+        }
         UISimState ui;
         ui.launch(scene_path);
 #else
@@ -119,6 +159,17 @@ int main(int argc, char* argv[])
             return 1;
         }
 
+        // Overrides the log of the scene settings
+        if (!ccd_query_log_path.empty()
+            && !ccd_query_log().open(
+                ccd_query_log_path, ccd_query_sample_rate)) {
+            return 1;
+        }
+        if (!metrics_path.empty()
+            && !sim.open_metrics_log(metrics_path, metrics_format)) {
+            return 1;
+        }
+
         if (num_steps > 0) {
             sim.m_max_simulation_steps = num_steps;
         }
@@ -23,6 +23,15 @@ nlohmann::json CollisionConstraint::settings() const
     return json;
 }
 
+nlohmann::json CollisionConstraint::stats() const
+{
+    return { { "broad_phase_time", m_broad_phase_time },
+             { "narrow_phase_time", m_narrow_phase_time },
+             { "count_ev_candidates", m_num_ev_candidates },
+             { "count_ee_candidates", m_num_ee_candidates },
+             { "count_fv_candidates", m_num_fv_candidates } };
+}
+
 void CollisionConstraint::construct_collision_set(
     const RigidBodyAssembler& bodies,
     const PosesD poses_t0,
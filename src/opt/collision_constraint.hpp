@@ -19,6 +19,9 @@ public:
 
     virtual void initialize() {};
 
+    /// @brief Running totals of the collision detection work.
+    virtual nlohmann::json stats() const;
+
     void construct_collision_set(
         const RigidBodyAssembler& bodies,
         const PosesD poses_t0,
@@ -31,6 +34,13 @@ public:
     TrajectoryType trajectory_type;
     double m_ccd_time;
 
+    // Running totals reported by stats()
+    mutable double m_broad_phase_time = 0;  ///< Seconds finding candidates
+    mutable double m_narrow_phase_time = 0; ///< Seconds in CCD and distances
+    mutable size_t m_num_ev_candidates = 0;
+    mutable size_t m_num_ee_candidates = 0;
+    mutable size_t m_num_fv_candidates = 0;
+
 protected:
     inline static int dim_to_collision_type(int dim)
     {
@@ -2,8 +2,13 @@
 
 #include "distance_barrier_constraint.hpp"
 
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <tuple>
+
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
+#include <tbb/parallel_sort.h>
 
 #include <igl/slice_mask.h>
 #include <ipc/ipc.hpp>
@@ -24,11 +29,15 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
       { BarrierType::POLY_LOG, "poly_log" },
       { BarrierType::SPLINE, "spline" } })
 
+// Candidates tested in parallel before the earliest TOI bound is tightened.
+static const size_t NARROW_PHASE_WAVE_SIZE = 4096;
+
 DistanceBarrierConstraint::DistanceBarrierConstraint(const std::string& name)
     : CollisionConstraint(name)
     , initial_barrier_activation_distance(1e-3)
     , barrier_type(BarrierType::IPC)
     , minimum_separation_distance(0.0)
+    , deterministic(true)
     , m_barrier_activation_distance(0.0)
 {
     m_ccd_time = 0.0;
@@ -41,6 +50,7 @@ void DistanceBarrierConstraint::settings(const nlohmann::json& json)
         json["initial_barrier_activation_distance"];
     minimum_separation_distance = json["minimum_separation_distance"];
     barrier_type = json["barrier_type"];
+    deterministic = json["deterministic"];
 }
 
 nlohmann::json DistanceBarrierConstraint::settings() const
@@ -50,6 +60,7 @@ nlohmann::json DistanceBarrierConstraint::settings() const
         initial_barrier_activation_distance;
     json["minimum_separation_distance"] = minimum_separation_distance;
     json["barrier_type"] = barrier_type;
+    json["deterministic"] = deterministic;
     return json;
 }
 
@@ -59,6 +70,14 @@ void DistanceBarrierConstraint::initialize()
     CollisionConstraint::initialize();
 }
 
+void DistanceBarrierConstraint::count_candidates(
+    const Candidates& candidates) const
+{
+    m_num_ev_candidates += candidates.ev_candidates.size();
+    m_num_ee_candidates += candidates.ee_candidates.size();
+    m_num_fv_candidates += candidates.fv_candidates.size();
+}
+
 bool DistanceBarrierConstraint::has_active_collisions(
     const RigidBodyAssembler& bodies,
     const PosesD& poses_t0,
@@ -70,17 +89,23 @@ bool DistanceBarrierConstraint::has_active_collisions(
         NARROW_PHASE);
 
     PROFILE_START();
+    igl::Timer timer;
+    timer.start();
     // This function will profile itself
     Candidates candidates;
     detect_collision_candidates(
         bodies, poses_t0, poses_t1, dim_to_collision_type(bodies.dim()),
         candidates, detection_method, trajectory_type,
         /*inflation_radius=*/minimum_separation_distance / 2.0);
+    m_broad_phase_time += timer.getElapsedTime();
+    count_candidates(candidates);
 
+    timer.start();
     PROFILE_START(NARROW_PHASE)
     bool has_collisions = has_active_collisions_narrow_phase(
         bodies, poses_t0, poses_t1, candidates);
     PROFILE_END(NARROW_PHASE)
+    m_narrow_phase_time += timer.getElapsedTime();
     PROFILE_END();
 
     return has_collisions;
@@ -145,12 +170,20 @@ double DistanceBarrierConstraint::compute_earliest_toi(
         bodies, poses_t0, poses_t1, dim_to_collision_type(bodies.dim()),
         candidates, detection_method, trajectory_type,
         /*inflation_radius=*/minimum_separation_distance / 2.0);
+    if (deterministic) {
+        // The waves of the narrow phase depend on the candidate order
+        sort_candidates(candidates);
+    }
+    const double broad_phase_time = timer.getElapsedTime();
+    m_broad_phase_time += broad_phase_time;
+    count_candidates(candidates);
 
     double earliest_toi = compute_earliest_toi_narrow_phase(
         bodies, poses_t0, poses_t1, candidates);
     PROFILE_END();
     timer.stop();
     m_ccd_time += timer.getElapsedTime();
+    m_narrow_phase_time += timer.getElapsedTime() - broad_phase_time;
 
     return earliest_toi;
 }
@@ -182,75 +215,108 @@ double DistanceBarrierConstraint::compute_earliest_toi_narrow_phase(
 
     int collision_count = 0;
     double earliest_toi = 1;
-    std::mutex earliest_toi_mutex;
 
     const size_t num_ev = candidates.ev_candidates.size();
     const size_t num_ee = candidates.ee_candidates.size();
     const size_t num_fv = candidates.fv_candidates.size();
 
-    // Do a single block range over all three candidate vectors
-    tbb::parallel_for(
-        tbb::blocked_range<int>(0, candidates.size()),
-        [&](tbb::blocked_range<int> r) {
-            for (int i = r.begin(); i < r.end(); i++) {
-                double toi = std::numeric_limits<double>::infinity();
-                bool are_colliding;
-
-                if (i < num_ev) {
-                    // PROFILE_START(EV_NARROW_PHASE);
-                    are_colliding = edge_vertex_ccd(
-                        bodies, poses_t0, poses_t1, candidates.ev_candidates[i],
-                        toi, trajectory_type, earliest_toi,
-                        minimum_separation_distance);
-                    // PROFILE_END(EV_NARROW_PHASE);
-                } else if (i - num_ev < num_ee) {
-                    // PROFILE_START(EE_NARROW_PHASE);
-                    are_colliding = edge_edge_ccd(
-                        bodies, poses_t0, poses_t1,
-                        candidates.ee_candidates[i - num_ev], toi,
-                        trajectory_type, earliest_toi,
-                        minimum_separation_distance);
-                    // PROFILE_END(EE_NARROW_PHASE);
-                } else {
-                    assert(i - num_ev - num_ee < num_fv);
-                    // PROFILE_START(FV_NARROW_PHASE);
-                    are_colliding = face_vertex_ccd(
-                        bodies, poses_t0, poses_t1,
-                        candidates.fv_candidates[i - num_ev - num_ee], toi,
-                        trajectory_type, earliest_toi,
-                        minimum_separation_distance);
-                    // PROFILE_END(FV_NARROW_PHASE);
-                }
+    // In deterministic mode the candidates are tested in fixed-size waves.
+    // All queries of a wave are bounded by the earliest TOI of the previous
+    // waves, so the result does not depend on the number of threads or their
+    // scheduling. Otherwise, all candidates are tested at once and each query
+    // is bounded by the earliest TOI found so far by any thread.
+    const size_t wave_size = deterministic
+        ? NARROW_PHASE_WAVE_SIZE
+        : std::max(candidates.size(), size_t(1));
+    std::atomic<double> shared_earliest_toi(earliest_toi);
+    std::vector<double> wave_tois;
+    for (size_t wave_start = 0; wave_start < candidates.size();
+         wave_start += wave_size) {
+        const size_t wave_end =
+            std::min(wave_start + wave_size, candidates.size());
+        const double wave_earliest_toi = earliest_toi;
+        wave_tois.assign(
+            wave_end - wave_start, std::numeric_limits<double>::infinity());
+
+        // Do a single block range over all three candidate vectors
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(wave_start, wave_end),
+            [&](const tbb::blocked_range<size_t>& r) {
+                for (size_t i = r.begin(); i < r.end(); i++) {
+                    double toi = std::numeric_limits<double>::infinity();
+                    bool are_colliding;
+                    const double query_earliest_toi = deterministic
+                        ? wave_earliest_toi
+                        : shared_earliest_toi.load(std::memory_order_relaxed);
 
-                if (are_colliding && toi == 0) {
                     if (i < num_ev) {
-                        spdlog::error("Edge-vertex CCD resulted in toi=0!");
-                        save_ccd_candidate(
+                        // PROFILE_START(EV_NARROW_PHASE);
+                        are_colliding = edge_vertex_ccd(
                             bodies, poses_t0, poses_t1,
-                            candidates.ev_candidates[i]);
+                            candidates.ev_candidates[i], toi, trajectory_type,
+                            query_earliest_toi, minimum_separation_distance);
+                        // PROFILE_END(EV_NARROW_PHASE);
                     } else if (i - num_ev < num_ee) {
-                        spdlog::error("Edge-edge CCD resulted in toi=0!");
-                        save_ccd_candidate(
+                        // PROFILE_START(EE_NARROW_PHASE);
+                        are_colliding = edge_edge_ccd(
                             bodies, poses_t0, poses_t1,
-                            candidates.ee_candidates[i - num_ev]);
+                            candidates.ee_candidates[i - num_ev], toi,
+                            trajectory_type, query_earliest_toi,
+                            minimum_separation_distance);
+                        // PROFILE_END(EE_NARROW_PHASE);
                     } else {
                         assert(i - num_ev - num_ee < num_fv);
-                        spdlog::error("Face-vertex CCD resulted in toi=0!");
-                        save_ccd_candidate(
+                        // PROFILE_START(FV_NARROW_PHASE);
+                        are_colliding = face_vertex_ccd(
                             bodies, poses_t0, poses_t1,
-                            candidates.fv_candidates[i - num_ev - num_ee]);
+                            candidates.fv_candidates[i - num_ev - num_ee], toi,
+                            trajectory_type, query_earliest_toi,
+                            minimum_separation_distance);
+                        // PROFILE_END(FV_NARROW_PHASE);
                     }
-                }
 
-                if (are_colliding) {
-                    std::scoped_lock lock(earliest_toi_mutex);
-                    collision_count++;
-                    if (toi < earliest_toi) {
-                        earliest_toi = toi;
+                    if (are_colliding && toi == 0) {
+                        if (i < num_ev) {
+                            spdlog::error("Edge-vertex CCD resulted in toi=0!");
+                            save_ccd_candidate(
+                                bodies, poses_t0, poses_t1,
+                                candidates.ev_candidates[i]);
+                        } else if (i - num_ev < num_ee) {
+                            spdlog::error("Edge-edge CCD resulted in toi=0!");
+                            save_ccd_candidate(
+                                bodies, poses_t0, poses_t1,
+                                candidates.ee_candidates[i - num_ev]);
+                        } else {
+                            assert(i - num_ev - num_ee < num_fv);
+                            spdlog::error("Face-vertex CCD resulted in toi=0!");
+                            save_ccd_candidate(
+                                bodies, poses_t0, poses_t1,
+                                candidates.fv_candidates[i - num_ev - num_ee]);
+                        }
+                    }
+
+                    if (are_colliding) {
+                        wave_tois[i - wave_start] = toi;
+                        if (!deterministic) {
+                            // Tighten the bound of the remaining queries
+                            double current_toi = shared_earliest_toi;
+                            while (toi < current_toi
+                                   && !shared_earliest_toi
+                                           .compare_exchange_weak(
+                                               current_toi, toi)) { }
+                        }
                     }
                 }
+            });
+
+        // Reduce the wave in candidate order
+        for (const double toi : wave_tois) {
+            if (toi != std::numeric_limits<double>::infinity()) {
+                collision_count++;
+                earliest_toi = std::min(earliest_toi, toi);
             }
-        });
+        }
+    }
 
     double percent_correct = candidates.size() == 0
         ? 100
@@ -271,21 +337,54 @@ double DistanceBarrierConstraint::compute_earliest_toi_narrow_phase(
                            : std::numeric_limits<double>::infinity();
 }
 
+/// @brief Sort the constraints by their primitive ids.
+///
+/// The constraints are built in parallel, so their order depends on the
+/// scheduling. Sorting them fixes the order of all sums over constraints.
+static void sort_constraints(CollisionConstraints& constraint_set)
+{
+    tbb::parallel_sort(
+        constraint_set.vv_constraints.begin(),
+        constraint_set.vv_constraints.end(),
+        [](const VertexVertexConstraint& c0, const VertexVertexConstraint& c1) {
+            return std::tie(c0.vertex0_id, c0.vertex1_id)
+                < std::tie(c1.vertex0_id, c1.vertex1_id);
+        });
+    tbb::parallel_sort(
+        constraint_set.ev_constraints.begin(),
+        constraint_set.ev_constraints.end(),
+        [](const EdgeVertexConstraint& c0, const EdgeVertexConstraint& c1) {
+            return std::tie(c0.edge_id, c0.vertex_id)
+                < std::tie(c1.edge_id, c1.vertex_id);
+        });
+    tbb::parallel_sort(
+        constraint_set.ee_constraints.begin(),
+        constraint_set.ee_constraints.end(),
+        [](const EdgeEdgeConstraint& c0, const EdgeEdgeConstraint& c1) {
+            return std::tie(c0.edge0_id, c0.edge1_id)
+                < std::tie(c1.edge0_id, c1.edge1_id);
+        });
+    tbb::parallel_sort(
+        constraint_set.fv_constraints.begin(),
+        constraint_set.fv_constraints.end(),
+        [](const FaceVertexConstraint& c0, const FaceVertexConstraint& c1) {
+            return std::tie(c0.face_id, c0.vertex_id)
+                < std::tie(c1.face_id, c1.vertex_id);
+        });
+}
+
 void DistanceBarrierConstraint::construct_constraint_set(
     const CollisionMesh& collision_mesh,
     const RigidBodyAssembler& bodies,
     const PosesD& poses,
     CollisionConstraints& constraint_set) const
 {
-    static PosesD cached_poses;
-    static CollisionConstraints cached_constraint_set;
-
     if (bodies.num_bodies() <= 1) {
         return;
     }
 
-    if (poses == cached_poses) {
-        constraint_set = cached_constraint_set;
+    if (poses == m_cached_poses) {
+        constraint_set = m_cached_constraint_set;
         return;
     }
 
@@ -296,14 +395,23 @@ void DistanceBarrierConstraint::construct_constraint_set(
     double dmin = this->minimum_separation_distance;
     const double inflation_radius = (dhat + dmin) / 2.0;
 
+    igl::Timer timer;
+    timer.start();
     Candidates candidates;
     detect_collision_candidates_rigid(
         bodies, poses, dim_to_collision_type(bodies.dim()), candidates,
         detection_method, inflation_radius);
+    const double broad_phase_time = timer.getElapsedTime();
+    m_broad_phase_time += broad_phase_time;
+    count_candidates(candidates);
 
-    Eigen::MatrixXd V = bodies.world_vertices(poses);
+    const Eigen::MatrixXd& V = bodies.world_vertices_buffered(poses);
 
     constraint_set.build(candidates, collision_mesh, V, dhat, dmin);
+    if (deterministic) {
+        sort_constraints(constraint_set);
+    }
+    m_narrow_phase_time += timer.getElapsedTime() - broad_phase_time;
     // ipc::construct_constraint_set(
     //    candidates, /*V_rest=*/V, V, bodies.m_edges, bodies.m_faces,
     //    /*dhat=*/dhat, constraint_set, bodies.m_faces_to_edges,
@@ -311,8 +419,8 @@ void DistanceBarrierConstraint::construct_constraint_set(
 
     PROFILE_END();
 
-    cached_poses = poses;
-    cached_constraint_set = constraint_set;
+    m_cached_poses = poses;
+    m_cached_constraint_set = constraint_set;
 }
 
 double DistanceBarrierConstraint::compute_minimum_distance(
@@ -323,7 +431,7 @@ double DistanceBarrierConstraint::compute_minimum_distance(
     PROFILE_POINT("DistanceBarrierConstraint::compute_minimum_distance");
     PROFILE_START();
 
-    Eigen::MatrixXd V = bodies.world_vertices(poses);
+    const Eigen::MatrixXd& V = bodies.world_vertices_buffered(poses);
     CollisionConstraints constraint_set;
     construct_constraint_set(collision_mesh, bodies, poses, constraint_set);
     double minimum_distance =
@@ -54,6 +54,14 @@ public:
         const PosesD& poses,
         CollisionConstraints& constraint_set) const;
 
+    /// @brief Forget the last constraint set (e.g., after the global vertex
+    /// ids changed).
+    void clear_constraint_set_cache() const
+    {
+        m_cached_poses.clear();
+        m_cached_constraint_set = CollisionConstraints();
+    }
+
     template <typename T>
     T distance_barrier(const T& distance, const double dhat) const;
 
@@ -85,7 +93,14 @@ public:
 
     double minimum_separation_distance;
 
+    /// @brief Make the earliest TOI, the constraint set, and the sums over
+    /// constraints independent of the number of threads.
+    bool deterministic;
+
 protected:
+    /// @brief Add the candidates of a broad-phase to the running totals.
+    void count_candidates(const Candidates& candidates) const;
+
     bool has_active_collisions_narrow_phase(
         const RigidBodyAssembler& bodies,
         const PosesD& poses_t0,
@@ -100,6 +115,11 @@ protected:
 
     /// @brief Max distance, d̂, at which the barrier forces are activate.
     double m_barrier_activation_distance;
+
+    /// @brief Poses of the last constraint set built
+    mutable PosesD m_cached_poses;
+    /// @brief Last constraint set built
+    mutable CollisionConstraints m_cached_constraint_set;
 };
 
 } // namespace ipc::rigid
@@ -6,6 +6,7 @@
 #include <tbb/parallel_for.h>
 
 #include <autodiff/autodiff.h>
+#include <interval/interval_trig.hpp>
 #include <logger.hpp>
 #include <profiler.hpp>
 #include <utils/is_zero.hpp>
@@ -203,9 +204,29 @@ template <typename T>
 MatrixMax3<T> construct_rotation_matrix(const VectorMax3<T>& r)
 {
     if (r.size() == 1) {
+        if constexpr (std::is_same<T, Interval>::value) {
+            if (is_small_angle(r(0))) {
+                const SmallAngleTrig trig = small_angle_trig(r(0));
+                Matrix2<T> R;
+                R << trig.cos, -trig.sin, trig.sin, trig.cos;
+                return R;
+            }
+        }
         return Eigen::Rotation2D<T>(r(0)).toRotationMatrix();
     } else {
         assert(r.size() == 3);
+        if constexpr (std::is_same<T, Interval>::value) {
+            // Rodrigues' formula with fused enclosures of the coefficients
+            const T angle = norm(r);
+            if (is_small_angle(angle)) {
+                const SmallAngleTrig trig = small_angle_trig(angle);
+                Matrix3<T> K = Hat(r);
+                Matrix3<T> R =
+                    trig.sinc * K + trig.one_minus_cos_over_x2 * (K * K);
+                R.diagonal().array() += T(1.0);
+                return R;
+            }
+        }
         T sinc_angle = sinc_normx(r);
         T sinc_half_angle = sinc_normx((r / T(2.0)).eval());
         Matrix3<T> K = Hat(r);
@@ -1,12 +1,10 @@
 ﻿#include "rigid_body.hpp"
 
-#include <Eigen/Eigenvalues>
 #include <Eigen/Geometry>
 
 #include <autodiff/autodiff_types.hpp>
 #include <finitediff.hpp>
 #include <logger.hpp>
-#include <physics/mass.hpp>
 #include <profiler.hpp>
 #include <utils/eigen_ext.hpp>
 #include <utils/flatten.hpp>
@@ -14,41 +12,39 @@
 
 namespace ipc::rigid {
 
-void center_vertices(
-    Eigen::MatrixXd& vertices,
+RigidBody::RigidBody(
+    const Eigen::MatrixXd& vertices,
     const Eigen::MatrixXi& edges,
     const Eigen::MatrixXi& faces,
-    PoseD& pose)
+    const PoseD& pose,
+    const PoseD& velocity,
+    const PoseD& force,
+    const double density,
+    const VectorMax6b& is_dof_fixed,
+    const bool oriented,
+    const int group_id,
+    const RigidBodyType type,
+    const double kinematic_max_time,
+    const std::deque<PoseD>& kinematic_poses)
+    : RigidBody(
+          RigidBodyAsset(vertices, edges, faces, density, is_dof_fixed),
+          pose,
+          velocity,
+          force,
+          is_dof_fixed,
+          oriented,
+          group_id,
+          type,
+          kinematic_max_time,
+          kinematic_poses)
 {
-    int dim = vertices.cols();
-
-    vertices.rowwise() += pose.position.transpose();
-
-    // compute the center of mass several times to get more accurate
-    pose.position.setZero(dim);
-    for (int i = 0; i < 10; i++) {
-        double mass;
-        VectorMax3d com;
-        MatrixMax3d inertia;
-        compute_mass_properties(
-            vertices, dim == 2 || faces.size() == 0 ? edges : faces, mass, com,
-            inertia);
-        vertices.rowwise() -= com.transpose();
-        pose.position += com;
-        if (com.squaredNorm() < 1e-8) {
-            break;
-        }
-    }
 }
 
 RigidBody::RigidBody(
-    const Eigen::MatrixXd& vertices,
-    const Eigen::MatrixXi& edges,
-    const Eigen::MatrixXi& faces,
+    const RigidBodyAsset& asset,
     const PoseD& pose,
     const PoseD& velocity,
     const PoseD& force,
-    const double density,
     const VectorMax6b& is_dof_fixed,
     const bool oriented,
     const int group_id,
@@ -57,12 +53,20 @@ RigidBody::RigidBody(
     const std::deque<PoseD>& kinematic_poses)
     : group_id(group_id)
     , type(type)
-    , vertices(vertices)
-    , edges(edges)
-    , faces(faces)
+    , vertices(asset.vertices)
+    , edges(asset.edges)
+    , faces(asset.faces)
+    , average_edge_length(asset.average_edge_length)
+    , mass(asset.mass)
+    , moment_of_inertia(asset.moment_of_inertia)
+    , R0(asset.R0)
+    , r_max(asset.r_max)
+    , local_box_min(asset.local_box_min)
+    , local_box_max(asset.local_box_max)
     , is_dof_fixed(is_dof_fixed)
     , is_oriented(oriented)
-    , mesh_selector(vertices.rows(), edges, faces)
+    , bvh(asset.bvh)
+    , mesh_selector(asset.mesh_selector)
     , pose(pose)
     , velocity(velocity)
     , force(force)
@@ -72,8 +76,6 @@ RigidBody::RigidBody(
     assert(dim() == pose.dim());
     assert(dim() == velocity.dim());
     assert(dim() == force.dim());
-    assert(edges.size() == 0 || edges.cols() == 2);
-    assert(faces.size() == 0 || faces.cols() == 3);
 
     if (type == RigidBodyType::STATIC) {
         this->is_dof_fixed.setOnes(this->is_dof_fixed.size());
@@ -81,60 +83,13 @@ RigidBody::RigidBody(
         this->type = RigidBodyType::STATIC;
     }
 
-    center_vertices(this->vertices, edges, faces, this->pose);
-    VectorMax3d center_of_mass;
-    MatrixMax3d I;
-    compute_mass_properties(
-        this->vertices,
-        dim() == 2 || faces.size() == 0 ? edges : faces, //
-        mass, center_of_mass, I);
-    // assert(center_of_mass.squaredNorm() < 1e-8);
-
-    // Mass above is actually volume in m³ and density is Kg/m³
-    mass *= density;
+    // The asset is centered at its center of mass
+    this->pose.position += asset.center_of_mass;
     if (dim() == 3) {
-        // Got this from Chrono: https://bit.ly/2RpbTl1
-        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
-        double threshold = I.lpNorm<Eigen::Infinity>() * 1e-16;
-        I = (threshold < I.array().abs()).select(I, 0.0);
-        es.compute(I);
-        if (es.info() != Eigen::Success) {
-            spdlog::error("Eigen decompostion of the inertia tensor failed!");
-        }
-        moment_of_inertia = density * es.eigenvalues();
-        if ((moment_of_inertia.array() < 0).any()) {
-            spdlog::warn(
-                "Negative moment of inertia ({}), inverting.",
-                fmt_eigen(moment_of_inertia));
-            // Avoid negative epsilon inertias
-            moment_of_inertia =
-                (moment_of_inertia.array() < 0)
-                    .select(-moment_of_inertia, moment_of_inertia);
-        }
-        R0 = es.eigenvectors();
-        // Ensure that we have an orientation preserving transform
-        if (R0.determinant() < 0.0) {
-            R0.col(0) *= -1.0;
-        }
-        assert(R0.isUnitary(1e-9));
-        assert(fabs(R0.determinant() - 1.0) <= 1.0e-9);
-        int num_rot_dof_fixed =
-            is_dof_fixed.tail(PoseD::dim_to_rot_ndof(dim())).count();
-        if (num_rot_dof_fixed == 2) {
-            // Convert moment of inertia to world coordinates
-            // https://physics.stackexchange.com/a/268812
-            moment_of_inertia = -I.diagonal().array() + I.diagonal().sum();
-            R0.setIdentity();
-        } else if (num_rot_dof_fixed == 1) {
-            spdlog::warn("Rigid body dynamics with two rotational DoF has "
-                         "not been tested thoroughly.");
-        }
         // R = RᵢR₀
         Eigen::AngleAxisd r = Eigen::AngleAxisd(
             Eigen::Matrix3d(this->pose.construct_rotation_matrix() * R0));
         this->pose.rotation = r.angle() * r.axis();
-        // v = Rv₀ + p = RᵢR₀v₀ + p = RᵢR₀R₀ᵀv₀ + p
-        this->vertices = this->vertices * R0; // R₀ᵀ * V₀ᵀ = V₀ * R₀
         // ω = R₀ᵀω₀ (ω₀ expressed in body coordinates)
         this->velocity.rotation = R0.transpose() * this->velocity.rotation;
         Eigen::Matrix3d Q_t0 = this->pose.construct_rotation_matrix();
@@ -142,9 +97,6 @@ RigidBody::RigidBody(
         // τ = R₀ᵀτ₀ (τ₀ expressed in body coordinates)
         // NOTE: this transformation will be done later
         // this->force.rotation = R0.transpose() * this->force.rotation;
-    } else {
-        moment_of_inertia = density * I.diagonal();
-        R0 = Eigen::Matrix<double, 1, 1>::Identity();
     }
 
     // Zero out the velocity and forces of fixed dof
@@ -164,68 +116,20 @@ RigidBody::RigidBody(
     mass_matrix.diagonal().head(pos_ndof()).setConstant(mass);
     mass_matrix.diagonal().tail(rot_ndof()) = moment_of_inertia;
 
-    r_max = this->vertices.rowwise().norm().maxCoeff();
-
-    average_edge_length = 0;
-    for (long i = 0; i < edges.rows(); i++) {
-        average_edge_length +=
-            (this->vertices.row(edges(i, 0)) - this->vertices.row(edges(i, 1)))
-                .norm();
-    }
-    if (edges.rows() > 0) {
-        average_edge_length /= edges.rows();
-    }
-    assert(std::isfinite(average_edge_length));
-
-    init_bvh();
+    update_world_cache();
 }
 
-void RigidBody::init_bvh()
+void RigidBody::update_world_cache()
 {
-    PROFILE_POINT("RigidBody::init_bvh");
-    PROFILE_START();
-
-    // heterogenous bounding boxes
-    std::vector<std::array<Eigen::Vector3d, 2>> aabbs(
-        num_codim_vertices() + num_codim_edges() + num_faces());
-
-    for (size_t i = 0; i < num_codim_vertices(); i++) {
-        size_t vi = mesh_selector.codim_vertices_to_vertices(i);
-        if (dim() == 2) {
-            aabbs[i][0][2] = 0;
-            aabbs[i][1][2] = 0;
-        }
-        aabbs[i][0].head(dim()) = vertices.row(i);
-        aabbs[i][1].head(dim()) = vertices.row(i);
-    }
-
-    size_t start_i = num_codim_vertices();
-    for (size_t i = 0; i < num_codim_edges(); i++) {
-        size_t ei = mesh_selector.codim_edges_to_edges(i);
-        const auto& e0 = vertices.row(edges(ei, 0));
-        const auto& e1 = vertices.row(edges(ei, 1));
-
-        if (dim() == 2) {
-            aabbs[start_i + i][0][2] = 0;
-            aabbs[start_i + i][1][2] = 0;
-        }
-        aabbs[start_i + i][0].head(dim()) = e0.cwiseMin(e1);
-        aabbs[start_i + i][1].head(dim()) = e0.cwiseMax(e1);
+    m_has_world_cache = false;
+    if (!is_dof_fixed.array().all()) {
+        return;
     }
-
-    start_i += num_codim_edges();
-    for (size_t i = 0; i < num_faces(); i++) {
-        assert(dim() == 3);
-        const auto& f0 = vertices.row(faces(i, 0));
-        const auto& f1 = vertices.row(faces(i, 1));
-        const auto& f2 = vertices.row(faces(i, 2));
-        aabbs[start_i + i][0] = f0.cwiseMin(f1).cwiseMin(f2);
-        aabbs[start_i + i][1] = f0.cwiseMax(f1).cwiseMax(f2);
-    }
-
-    bvh.init(aabbs);
-
-    PROFILE_END();
+    m_world_cache_vertices = world_vertices<double>(
+        pose.construct_rotation_matrix(), pose.position);
+    compute_bounding_box(pose, m_world_cache_box_min, m_world_cache_box_max);
+    m_world_cache_pose = pose;
+    m_has_world_cache = true;
 }
 
 Eigen::MatrixXd RigidBody::world_velocities() const
@@ -248,23 +152,50 @@ void RigidBody::compute_bounding_box(
     VectorMax3d& box_min,
     VectorMax3d& box_max) const
 {
+    if (has_world_cache(pose_t0) && has_world_cache(pose_t1)) {
+        box_min = m_world_cache_box_min;
+        box_max = m_world_cache_box_max;
+        return;
+    }
+
     PROFILE_POINT("RigidBody::compute_bounding_box");
     PROFILE_START();
 
-    // If the body is not rotating then just use the linearized
-    // trajectory
-    if (type == RigidBodyType::STATIC
-        || (pose_t0.rotation.array() == pose_t1.rotation.array()).all()) {
-        Eigen::MatrixXd V0 = world_vertices(pose_t0);
-        box_min = V0.colwise().minCoeff();
-        box_max = V0.colwise().maxCoeff();
-        Eigen::MatrixXd V1 = world_vertices(pose_t1);
-        box_min = box_min.cwiseMin(V1.colwise().minCoeff().transpose());
-        box_max = box_max.cwiseMax(V1.colwise().maxCoeff().transpose());
-    } else {
-        // Use the maximum radius of the body to bound all rotations
-        box_min = pose_t0.position.cwiseMin(pose_t1.position).array() - r_max;
-        box_max = pose_t0.position.cwiseMax(pose_t1.position).array() + r_max;
+    // Transform the cached body-space box instead of every vertex:
+    // world center = R c and world half extents = |R| h.
+    const VectorMax3d center = (local_box_min + local_box_max) / 2;
+    const VectorMax3d half_extents = (local_box_max - local_box_min) / 2;
+
+    const MatrixMax3d R_t0 = pose_t0.construct_rotation_matrix();
+    const MatrixMax3d R_t1 = pose_t1.construct_rotation_matrix();
+    const VectorMax3d c_t0 = R_t0 * center, c_t1 = R_t1 * center;
+    const VectorMax3d h_t0 = R_t0.cwiseAbs() * half_extents;
+    const VectorMax3d h_t1 = R_t1.cwiseAbs() * half_extents;
+
+    // Both rotated boxes swept along the linearized translation
+    box_min = (c_t0 - h_t0).cwiseMin(c_t1 - h_t1)
+        + pose_t0.position.cwiseMin(pose_t1.position);
+    box_max = (c_t0 + h_t0).cwiseMax(c_t1 + h_t1)
+        + pose_t0.position.cwiseMax(pose_t1.position);
+
+    if (type != RigidBodyType::STATIC
+        && (pose_t0.rotation.array() != pose_t1.rotation.array()).any()) {
+        // The rotation vector is interpolated linearly and the exponential
+        // map is 1-Lipschitz, so every intermediate orientation is within an
+        // angle of ‖Δθ‖/2 of one of the end orientations. A vertex at
+        // distance r from the CM moves at most min(‖Δθ‖/2, 2) r from there.
+        const double angle = (pose_t1.rotation - pose_t0.rotation).norm();
+        const double deviation = std::min(angle / 2, 2.0) * r_max;
+        box_min.array() -= deviation;
+        box_max.array() += deviation;
+
+        // The sphere of radius r_max also bounds all rotations
+        box_min = box_min.cwiseMax(
+            (pose_t0.position.cwiseMin(pose_t1.position).array() - r_max)
+                .matrix());
+        box_max = box_max.cwiseMin(
+            (pose_t0.position.cwiseMax(pose_t1.position).array() + r_max)
+                .matrix());
     }
 
     PROFILE_END();
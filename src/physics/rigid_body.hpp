@@ -1,15 +1,18 @@
 #pragma once
 
 #include <deque>
+#include <type_traits>
 
 #include <Eigen/Core>
 #include <nlohmann/json.hpp>
 
 #include <physics/pose.hpp>
+#include <physics/rigid_body_asset.hpp>
 #include <utils/eigen_ext.hpp>
 
 #include <BVH.hpp>
 #include <utils/mesh_selector.hpp>
+#include <utils/primitive_bvh.hpp>
 
 namespace ipc::rigid {
 
@@ -46,6 +49,21 @@ public:
             std::numeric_limits<double>::infinity(),
         const std::deque<PoseD>& kinematic_poses = std::deque<PoseD>());
 
+    /// @brief Create a rigid body from a preprocessed asset.
+    /// @param pose Pose of the input coordinates of the asset's mesh.
+    RigidBody(
+        const RigidBodyAsset& asset,
+        const PoseD& pose,
+        const PoseD& velocity,
+        const PoseD& force,
+        const VectorMax6b& is_dof_fixed,
+        const bool oriented,
+        const int group_id,
+        const RigidBodyType type = RigidBodyType::DYNAMIC,
+        const double kinematic_max_time =
+            std::numeric_limits<double>::infinity(),
+        const std::deque<PoseD>& kinematic_poses = std::deque<PoseD>());
+
     // Faceless version for convienence (useful for 2D)
     RigidBody(
         const Eigen::MatrixXd& vertices,
@@ -109,11 +127,31 @@ public:
     template <typename T>
     MatrixX<T>
     world_vertices(const MatrixMax3<T>& R, const VectorMax3<T>& p) const;
+    /// @note Returns a copy even if the vertices are cached (see below).
     template <typename T> MatrixX<T> world_vertices(const Pose<T>& _pose) const
     {
+        if constexpr (std::is_same<T, double>::value) {
+            if (has_world_cache(_pose)) {
+                return m_world_cache_vertices;
+            }
+        }
         return world_vertices<T>(
             _pose.construct_rotation_matrix(), _pose.position);
     }
+    /// @brief Computes vertices position for given pose without copying the
+    ///        cached vertices of a fixed body.
+    /// @param buffer Storage for the vertices if they are not cached.
+    /// @return The cached world-space vertices or buffer.
+    const Eigen::MatrixXd&
+    world_vertices(const PoseD& _pose, Eigen::MatrixXd& buffer) const
+    {
+        if (has_world_cache(_pose)) {
+            return m_world_cache_vertices;
+        }
+        buffer = world_vertices<double>(
+            _pose.construct_rotation_matrix(), _pose.position);
+        return buffer;
+    }
     template <typename T>
     MatrixX<T> world_vertices(const VectorMax6<T>& dof) const
     {
@@ -128,6 +166,11 @@ public:
     template <typename T>
     VectorMax3<T> world_vertex(const Pose<T>& _pose, const int vertex_idx) const
     {
+        if constexpr (std::is_same<T, double>::value) {
+            if (has_world_cache(_pose)) {
+                return m_world_cache_vertices.row(vertex_idx).transpose();
+            }
+        }
         return world_vertex<T>(
             _pose.construct_rotation_matrix(), _pose.position, vertex_idx);
     }
@@ -190,6 +233,16 @@ public:
         // Zero out the velocity and forces of fixed dof
         velocity.zero_dof(is_dof_fixed, R0);
         force.zero_dof(is_dof_fixed, R0);
+        update_world_cache();
+    }
+
+    /// @brief Cache the world-space vertices and bounding box at the current
+    /// pose if all DoF are fixed (i.e., the body never moves).
+    void update_world_cache();
+    /// @brief Are the cached world-space vertices valid for the given pose?
+    bool has_world_cache(const PoseD& _pose) const
+    {
+        return m_has_world_cache && _pose == m_world_cache_pose;
     }
 
     // --------------------------------------------------------------------
@@ -221,6 +274,10 @@ public:
     MatrixMax3d R0;
     /// @brief maximum distance from CM to a vertex
     double r_max;
+    /// @brief minimum corner of the vertices' bounding box in body space
+    VectorMax3d local_box_min;
+    /// @brief maximum corner of the vertices' bounding box in body space
+    VectorMax3d local_box_max;
     /// @brief the mass matrix of the rigid body
     DiagonalMatrixMax6d mass_matrix;
 
@@ -231,7 +288,7 @@ public:
     bool is_oriented;
 
     /// @brief Local space BVH initalized at construction
-    BVH::BVH bvh;
+    PrimitiveBVH bvh;
     MeshSelector mesh_selector;
 
     // --------------------------------------------------------------------
@@ -261,7 +318,25 @@ public:
     std::deque<PoseD> kinematic_poses;
 
 protected:
-    void init_bvh();
+    /// @brief Is the world-space cache of a fixed body initialized?
+    bool m_has_world_cache = false;
+    /// @brief Pose the world-space cache was computed at
+    PoseD m_world_cache_pose;
+    /// @brief Cached world-space vertices of a fixed body
+    Eigen::MatrixXd m_world_cache_vertices;
+    /// @brief Cached world-space bounding box of a fixed body
+    VectorMax3d m_world_cache_box_min, m_world_cache_box_max;
+
+    /// @brief Fixed-size kernel of world_vertices() for a known dimension.
+    template <int Dim, typename T>
+    MatrixX<T>
+    world_vertices_fixed(const MatrixMax3<T>& R, const VectorMax3<T>& p) const;
+    /// @brief Fixed-size kernel of world_vertex() for a known dimension.
+    template <int Dim, typename T>
+    VectorMax3<T> world_vertex_fixed(
+        const MatrixMax3<T>& R,
+        const VectorMax3<T>& p,
+        const int vertex_idx) const;
 };
 
 } // namespace ipc::rigid
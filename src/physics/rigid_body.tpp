@@ -12,15 +12,41 @@ template <typename T>
 MatrixX<T>
 RigidBody::world_vertices(const MatrixMax3<T>& R, const VectorMax3<T>& p) const
 {
-    return (vertices * R.transpose()).rowwise() + p.transpose();
+    // Dispatch once on the dimension so the products use fixed-size kernels
+    // instead of the runtime sized MatrixMax3.
+    return dim() == 3 ? world_vertices_fixed<3, T>(R, p)
+                      : world_vertices_fixed<2, T>(R, p);
+}
+
+template <int Dim, typename T>
+MatrixX<T> RigidBody::world_vertices_fixed(
+    const MatrixMax3<T>& R, const VectorMax3<T>& p) const
+{
+    assert(vertices.cols() == Dim && R.rows() == Dim && p.size() == Dim);
+    const Eigen::Matrix<T, Dim, Dim> R_fixed = R;
+    const Eigen::Matrix<T, 1, Dim> p_fixed = p.transpose();
+    return (vertices.leftCols<Dim>() * R_fixed.transpose()).rowwise()
+        + p_fixed;
 }
 
 template <typename T>
 VectorMax3<T> RigidBody::world_vertex(
     const MatrixMax3<T>& R, const VectorMax3<T>& p, const int vertex_idx) const
 {
+    return dim() == 3 ? world_vertex_fixed<3, T>(R, p, vertex_idx)
+                      : world_vertex_fixed<2, T>(R, p, vertex_idx);
+}
+
+template <int Dim, typename T>
+VectorMax3<T> RigidBody::world_vertex_fixed(
+    const MatrixMax3<T>& R, const VectorMax3<T>& p, const int vertex_idx) const
+{
+    assert(vertices.cols() == Dim && R.rows() == Dim && p.size() == Dim);
+    const Eigen::Matrix<T, Dim, Dim> R_fixed = R;
+    const Eigen::Matrix<T, Dim, 1> p_fixed = p;
     // compute X[i] = R(θ) * rᵢ + X
-    return (vertices.row(vertex_idx) * R.transpose()) + p.transpose();
+    const Eigen::Matrix<double, 1, Dim> r = vertices.row(vertex_idx);
+    return (r * R_fixed.transpose()).transpose() + p_fixed;
 }
 
 template <typename DScalar>
@@ -1,11 +1,15 @@
 #include "rigid_body_assembler.hpp"
 
+#include <numeric>
+
 #include <Eigen/Geometry>
 #include <finitediff.hpp>
 #include <igl/PI.h>
 #include <ipc/broad_phase/hash_grid.hpp>
 #include <ipc/distance/edge_edge.hpp>
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_sort.h>
+#include <tbb/task_arena.h>
 
 #include <logger.hpp>
 #include <physics/mass.hpp>
@@ -13,14 +17,75 @@
 #include <utils/eigen_ext.hpp>
 #include <utils/flatten.hpp>
 #include <utils/not_implemented_error.hpp>
+#include <utils/space_filling_curve.hpp>
 
 namespace ipc::rigid {
 
 void RigidBodyAssembler::init(const std::vector<RigidBody>& rigid_bodies)
 {
     m_rbs = rigid_bodies;
+    m_body_ids.resize(m_rbs.size());
+    std::iota(m_body_ids.begin(), m_body_ids.end(), 0);
+    init_indices();
+}
+
+bool RigidBodyAssembler::reorder_bodies(BodyOrder order)
+{
+    std::vector<size_t> new_order;
+    if (order == BodyOrder::SCENE) {
+        new_order = m_body_indices;
+    } else {
+        Eigen::MatrixXd centers(num_bodies(), dim());
+        for (size_t i = 0; i < num_bodies(); i++) {
+            centers.row(i) = m_rbs[i].pose.position.transpose();
+        }
+        new_order = space_filling_curve_order(
+            centers,
+            order == BodyOrder::HILBERT ? SpaceFillingCurve::HILBERT
+                                        : SpaceFillingCurve::MORTON);
+    }
+
+    bool is_identity = true;
+    for (size_t i = 0; i < new_order.size() && is_identity; i++) {
+        is_identity = new_order[i] == i;
+    }
+    if (is_identity) {
+        return false;
+    }
+
+    std::vector<RigidBody> rbs;
+    std::vector<size_t> body_ids;
+    rbs.reserve(num_bodies());
+    body_ids.reserve(num_bodies());
+    for (size_t i : new_order) {
+        rbs.push_back(std::move(m_rbs[i]));
+        body_ids.push_back(m_body_ids[i]);
+    }
+    m_rbs = std::move(rbs);
+    m_body_ids = std::move(body_ids);
+    init_indices();
+    return true;
+}
+
+PosesD RigidBodyAssembler::to_scene_order(const PosesD& poses) const
+{
+    assert(poses.size() == num_bodies());
+    PosesD scene_poses(poses.size());
+    for (size_t i = 0; i < poses.size(); i++) {
+        scene_poses[m_body_ids[i]] = poses[i];
+    }
+    return scene_poses;
+}
+
+void RigidBodyAssembler::init_indices()
+{
+    const std::vector<RigidBody>& rigid_bodies = m_rbs;
 
     size_t num_bodies = rigid_bodies.size();
+    m_body_indices.resize(num_bodies);
+    for (size_t i = 0; i < num_bodies; i++) {
+        m_body_indices[m_body_ids[i]] = i;
+    }
     m_body_vertex_id.resize(num_bodies + 1);
     m_body_face_id.resize(num_bodies + 1);
     m_body_edge_id.resize(num_bodies + 1);
@@ -34,6 +99,14 @@ void RigidBodyAssembler::init(const std::vector<RigidBody>& rigid_bodies)
         m_body_edge_id[i + 1] = m_body_edge_id[i] + rb.edges.rows();
     }
 
+    // Starting position of each RB vertex with the bodies in scene order
+    m_scene_vertex_id.resize(num_bodies + 1);
+    m_scene_vertex_id[0] = 0;
+    for (size_t id = 0; id < num_bodies; ++id) {
+        m_scene_vertex_id[id + 1] = m_scene_vertex_id[id]
+            + rigid_bodies[m_body_indices[id]].num_vertices();
+    }
+
     // global edges and faces
     m_edges.resize(m_body_edge_id.back(), 2);
     m_faces.resize(m_body_face_id.back(), 3);
@@ -111,6 +184,14 @@ void RigidBodyAssembler::init(const std::vector<RigidBody>& rigid_bodies)
     if (num_free_dof) {
         average_mass /= num_free_dof;
     }
+
+    for (WorldVertexCache& cache : m_world_vertex_caches) {
+        cache = WorldVertexCache();
+    }
+    m_world_vertex_cache_clock = 0;
+
+    update_pose_buffers();
+    update_world_vertex_buffer();
 }
 
 size_t RigidBodyAssembler::count_kinematic_bodies() const
@@ -174,6 +255,94 @@ void RigidBodyAssembler::set_rb_poses(const PosesD& poses)
     }
 }
 
+void RigidBodyAssembler::save_body_states(BodyStates& states) const
+{
+    // Resizing to the same size does not reallocate, so a snapshot can be
+    // taken every sub-step without allocating.
+    states.poses.resize(num_bodies());
+    states.velocities.resize(num_bodies());
+    states.accelerations.resize(num_bodies());
+    states.Qdots.resize(num_bodies());
+    states.Qddots.resize(num_bodies());
+    for (size_t i = 0; i < num_bodies(); i++) {
+        const RigidBody& rb = m_rbs[i];
+        const size_t id = m_body_ids[i];
+        states.poses[id] = rb.pose;
+        states.velocities[id] = rb.velocity;
+        states.accelerations[id] = rb.acceleration;
+        states.Qdots[id] = rb.Qdot;
+        states.Qddots[id] = rb.Qddot;
+    }
+}
+
+void RigidBodyAssembler::restore_body_states(const BodyStates& states)
+{
+    assert(states.poses.size() == num_bodies());
+    for (size_t i = 0; i < num_bodies(); i++) {
+        RigidBody& rb = m_rbs[i];
+        const size_t id = m_body_ids[i];
+        rb.pose = states.poses[id];
+        rb.velocity = states.velocities[id];
+        rb.acceleration = states.accelerations[id];
+        rb.Qdot = states.Qdots[id];
+        rb.Qddot = states.Qddots[id];
+    }
+}
+
+void RigidBodyAssembler::update_pose_buffers()
+{
+    int ndof = PoseD::dim_to_ndof(dim());
+    // Resizing to the same size does not reallocate, so existing views of
+    // the buffers stay valid between updates.
+    m_pose_buffer.resize(num_bodies(), ndof);
+    m_velocity_buffer.resize(num_bodies(), ndof);
+    for (size_t i = 0; i < num_bodies(); i++) {
+        m_pose_buffer.row(m_body_ids[i]) = m_rbs[i].pose.dof().transpose();
+        m_velocity_buffer.row(m_body_ids[i]) =
+            m_rbs[i].velocity.dof().transpose();
+    }
+}
+
+void RigidBodyAssembler::update_world_vertex_buffer()
+{
+    m_world_vertex_buffer.resize(num_vertices(), dim());
+    tbb::parallel_for(size_t(0), num_bodies(), [&](size_t i) {
+        const RigidBody& rb = m_rbs[i];
+        Eigen::MatrixXd buffer;
+        m_world_vertex_buffer.block(
+            m_scene_vertex_id[m_body_ids[i]], 0, rb.num_vertices(), dim()) =
+            rb.world_vertices(rb.pose, buffer);
+    });
+}
+
+void RigidBodyAssembler::set_kinematic_targets(
+    const Eigen::Ref<const Eigen::VectorXi>& body_ids,
+    const Eigen::Ref<const StateBuffer>& poses,
+    const double timestep)
+{
+    int ndof = PoseD::dim_to_ndof(dim());
+    assert(poses.rows() == body_ids.size() && poses.cols() == ndof);
+    for (int i = 0; i < body_ids.size(); i++) {
+        if (body_ids(i) < 0 || body_ids(i) >= int(num_bodies())) {
+            spdlog::error(
+                "Invalid body id for kinematic target (id={:d})", body_ids(i));
+            continue;
+        }
+        RigidBody& rb = m_rbs[body_index(body_ids(i))];
+        if (rb.type != RigidBodyType::KINEMATIC) {
+            spdlog::warn(
+                "Ignoring the kinematic target of a non-kinematic body "
+                "(id={:d})",
+                body_ids(i));
+            continue;
+        }
+        rb.kinematic_poses.clear();
+        rb.kinematic_poses.emplace_back(VectorMax6d(poses.row(i).transpose()));
+        // Keep the body kinematic for at least the next step
+        rb.kinematic_max_time = std::max(rb.kinematic_max_time, timestep);
+    }
+}
+
 Eigen::MatrixXd
 RigidBodyAssembler::world_vertices(const RigidBody::Step step) const
 {
@@ -186,6 +355,68 @@ RigidBodyAssembler::world_vertices(const RigidBody::Step step) const
     return V;
 }
 
+const Eigen::MatrixXd&
+RigidBodyAssembler::world_vertices_buffered(const PosesD& poses) const
+{
+    assert(poses.size() == num_bodies());
+
+    std::scoped_lock lock(m_world_vertex_cache_mutex);
+
+    // Use the cache with the most bodies already at the given poses,
+    // breaking ties by the least recently used.
+    std::array<size_t, 2> num_matches;
+    for (size_t ci = 0; ci < m_world_vertex_caches.size(); ci++) {
+        const WorldVertexCache& cache = m_world_vertex_caches[ci];
+        num_matches[ci] = 0;
+        if (cache.poses.size() != num_bodies()) {
+            continue;
+        }
+        for (size_t i = 0; i < num_bodies(); i++) {
+            num_matches[ci] += cache.poses[i] == poses[i];
+        }
+    }
+    const WorldVertexCache& cache0 = m_world_vertex_caches[0];
+    const WorldVertexCache& cache1 = m_world_vertex_caches[1];
+    size_t ci = num_matches[0] != num_matches[1]
+        ? size_t(num_matches[1] > num_matches[0])
+        : size_t(cache1.last_used < cache0.last_used);
+    WorldVertexCache& cache = m_world_vertex_caches[ci];
+    cache.last_used = ++m_world_vertex_cache_clock;
+
+    if (num_matches[ci] == num_bodies()) {
+        return cache.vertices;
+    }
+
+    PROFILE_POINT("RigidBodyAssembler::world_vertices_buffered");
+    PROFILE_START();
+
+    const bool is_initialized = cache.poses.size() == num_bodies();
+    if (!is_initialized) {
+        cache.poses.resize(num_bodies());
+        cache.vertices.resize(num_vertices(), dim());
+    }
+
+    // Isolate the loop so that a thread waiting for it cannot steal a task
+    // that calls this function again while the lock is held.
+    tbb::this_task_arena::isolate([&] {
+        tbb::parallel_for(size_t(0), num_bodies(), [&](size_t i) {
+            if (is_initialized && cache.poses[i] == poses[i]) {
+                return;
+            }
+            const RigidBody& rb = m_rbs[i];
+            Eigen::MatrixXd buffer;
+            cache.vertices.block(
+                m_body_vertex_id[i], 0, rb.num_vertices(), dim()) =
+                rb.world_vertices(poses[i], buffer);
+            cache.poses[i] = poses[i];
+        });
+    });
+
+    PROFILE_END();
+
+    return cache.vertices;
+}
+
 Eigen::MatrixXd RigidBodyAssembler::world_velocities() const
 {
     Eigen::MatrixXd V(num_vertices(), dim());
@@ -244,6 +475,10 @@ Eigen::MatrixXd RigidBodyAssembler::world_vertices_diff(
                 // Index of rigid bodies first vertex in the global vertices
                 long rb_v0_i = m_body_vertex_id[rb_i];
 
+                // NOTE: The second derivatives of a body whose DoF are all
+                // fixed are still needed. The hessian of a constraint couples
+                // both bodies before it is projected to PSD, so the fixed
+                // body's terms change the free body's block.
                 if (compute_hess) {
                     rb.world_vertices_diff<Diff::DDouble2>(
                         poses[rb_i], rb_v0_i, V, jac, hess);
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <array>
+#include <mutex>
 #include <vector>
 
 #include <Eigen/Core>
 #include <Eigen/Sparse>
+#include <nlohmann/json.hpp>
 
 #include <autodiff/autodiff_types.hpp>
 #include <physics/rigid_body.hpp>
@@ -11,6 +14,19 @@
 
 namespace ipc::rigid {
 
+/// @brief Order of the bodies in the assembler (and the DoF).
+enum class BodyOrder {
+    SCENE,  ///< Order of the scene file
+    MORTON, ///< Morton order of the centers of mass
+    HILBERT ///< Hilbert order of the centers of mass
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(
+    BodyOrder,
+    { { BodyOrder::SCENE, "scene" },
+      { BodyOrder::MORTON, "morton" },
+      { BodyOrder::HILBERT, "hilbert" } })
+
 class RigidBodyAssembler {
 public:
     RigidBodyAssembler() {}
@@ -19,6 +35,25 @@ public:
     /// @brief inits assembler to use this set of rigid-bodies
     void init(const std::vector<RigidBody>& rbs);
 
+    // Body Order
+    // --------------------------------------------------------------------
+
+    /// @brief Sort the bodies by the position of their center of mass along
+    /// a space-filling curve, so bodies close in space are close in memory,
+    /// in the DoF, and in the Hessian.
+    ///
+    /// The global vertex, edge, and face ids follow the new order, but the
+    /// scene ids of the bodies (see body_id()) are unchanged.
+    /// @return True if the order changed.
+    bool reorder_bodies(BodyOrder order);
+
+    /// @brief Scene id (index in the scene file) of the ith body.
+    size_t body_id(size_t i) const { return m_body_ids[i]; }
+    /// @brief Index of the body with the given scene id.
+    size_t body_index(size_t body_id) const { return m_body_indices[body_id]; }
+    /// @brief Permute poses of the bodies to the order of the scene file.
+    PosesD to_scene_order(const PosesD& poses) const;
+
     // World Vertices Functions
     // --------------------------------------------------------------------
 
@@ -45,6 +80,17 @@ public:
         return world_vertices(RigidBody::CURRENT_STEP);
     }
 
+    /// @brief World vertices at the given poses from a persistent buffer.
+    ///
+    /// Only the bodies whose pose changed since the buffer was last filled
+    /// are transformed. Concurrent calls are serialized.
+    ///
+    /// @warning The returned reference aliases the buffer. It is valid until
+    /// the next call with different poses (from any thread) or until the
+    /// bodies are initialized or reordered. Copy it if such a call can
+    /// happen while it is in use.
+    const Eigen::MatrixXd& world_vertices_buffered(const PosesD& poses) const;
+
     template <typename T>
     VectorMax3<T> world_vertex(const Pose<T>& pose, const int vertex_idx) const;
     template <typename T>
@@ -108,6 +154,55 @@ public:
     /// @brief set rigid body poses
     void set_rb_poses(const PosesD& poses);
 
+    /// @brief Dynamic state of the bodies (in the order of the scene file).
+    struct BodyStates {
+        PosesD poses;
+        PosesD velocities;
+        PosesD accelerations;
+        std::vector<Eigen::Matrix3d> Qdots;
+        std::vector<Eigen::Matrix3d> Qddots;
+    };
+    /// @brief Copy the dynamic state of every body (e.g., to retry a step).
+    void save_body_states(BodyStates& states) const;
+    /// @brief Restore the dynamic state copied by save_body_states().
+    void restore_body_states(const BodyStates& states);
+
+    // Contiguous State Buffers
+    // --------------------------------------------------------------------
+    typedef Eigen::
+        Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+            StateBuffer;
+
+    /// @brief Copy the body poses and velocities into the contiguous
+    /// \f$n_{bodies} \times n_{dof}\f$ buffers (one row per body in the
+    /// order of the scene file).
+    void update_pose_buffers();
+    /// @brief Copy the world vertices into the contiguous
+    /// \f$n_{vertices} \times {2, 3}\f$ buffer (with the bodies in the order
+    /// of the scene file, like the pose buffers).
+    void update_world_vertex_buffer();
+
+    /// @brief Poses owned by the assembler (valid until the next update).
+    const StateBuffer& pose_buffer() const { return m_pose_buffer; }
+    /// @brief Velocities owned by the assembler (valid until the next update).
+    const StateBuffer& velocity_buffer() const { return m_velocity_buffer; }
+    /// @brief World vertices owned by the assembler.
+    const StateBuffer& world_vertex_buffer() const
+    {
+        return m_world_vertex_buffer;
+    }
+
+    /// @brief Set the next kinematic target pose of several bodies at once.
+    ///
+    /// Targets of bodies that are not kinematic are ignored.
+    /// @param body_ids Scene ids of the kinematic bodies to update.
+    /// @param poses \f$|body\_ids| \times n_{dof}\f$ matrix of target poses.
+    /// @param timestep Time step the targets should be reached in.
+    void set_kinematic_targets(
+        const Eigen::Ref<const Eigen::VectorXi>& body_ids,
+        const Eigen::Ref<const StateBuffer>& poses,
+        const double timestep);
+
     // --------------------------------------------------------------------
 
     long num_vertices() const { return m_body_vertex_id.back(); }
@@ -208,8 +303,40 @@ public:
     MatrixXb is_dof_fixed;
 
 protected:
+    /// @brief Build the global indices and buffers from m_rbs.
+    void init_indices();
+
+    /// @brief Scene id of each body in m_rbs
+    std::vector<size_t> m_body_ids;
+    /// @brief Index in m_rbs of each scene id (inverse of m_body_ids)
+    std::vector<size_t> m_body_indices;
+    /// @brief Starting index of each scene id in the world vertex buffer
+    std::vector<long> m_scene_vertex_id;
+
     /// @brief Group ids per vertex
     Eigen::VectorXi m_vertex_group_ids;
+
+    /// @brief Contiguous copy of the body poses (see update_pose_buffers())
+    StateBuffer m_pose_buffer;
+    /// @brief Contiguous copy of the body velocities
+    StateBuffer m_velocity_buffer;
+    /// @brief Contiguous copy of the world vertices
+    StateBuffer m_world_vertex_buffer;
+
+    /// @brief World vertices of every body at the pose they were computed at
+    struct WorldVertexCache {
+        PosesD poses;
+        Eigen::MatrixXd vertices;
+        size_t last_used = 0;
+    };
+    /// @brief Buffers of world_vertices_buffered(). Two are kept so that
+    /// alternating between the start-of-step and the trial poses does not
+    /// retransform every moving body.
+    mutable std::array<WorldVertexCache, 2> m_world_vertex_caches;
+    /// @brief Counter used to find the least recently used cache
+    mutable size_t m_world_vertex_cache_clock = 0;
+    /// @brief Guards the buffers of world_vertices_buffered()
+    mutable std::mutex m_world_vertex_cache_mutex;
 };
 
 } // namespace ipc::rigid
@@ -8,10 +8,16 @@ MatrixX<T> RigidBodyAssembler::world_vertices(const Poses<T>& poses) const
 {
     assert(poses.size() == num_bodies());
     MatrixX<T> V(num_vertices(), dim());
+    Eigen::MatrixXd buffer;
     for (size_t i = 0; i < num_bodies(); ++i) {
         const RigidBody& rb = m_rbs[i];
-        V.block(m_body_vertex_id[i], 0, rb.vertices.rows(), rb.dim()) =
-            rb.world_vertices(poses[i]);
+        auto block =
+            V.block(m_body_vertex_id[i], 0, rb.vertices.rows(), rb.dim());
+        if constexpr (std::is_same<T, double>::value) {
+            block = rb.world_vertices(poses[i], buffer);
+        } else {
+            block = rb.world_vertices(poses[i]);
+        }
     }
     return V;
 }
@@ -0,0 +1,222 @@
+#include "rigid_body_asset.hpp"
+
+#include <Eigen/Eigenvalues>
+
+#include <logger.hpp>
+#include <physics/mass.hpp>
+#include <physics/pose.hpp>
+#include <profiler.hpp>
+
+namespace ipc::rigid {
+
+/// @brief Move the center of mass of the vertices to the origin.
+/// @return The center of mass of the input vertices.
+static VectorMax3d center_vertices(
+    Eigen::MatrixXd& vertices,
+    const Eigen::MatrixXi& edges,
+    const Eigen::MatrixXi& faces)
+{
+    int dim = vertices.cols();
+
+    // compute the center of mass several times to get more accurate
+    VectorMax3d center = VectorMax3d::Zero(dim);
+    for (int i = 0; i < 10; i++) {
+        double mass;
+        VectorMax3d com;
+        MatrixMax3d inertia;
+        compute_mass_properties(
+            vertices, dim == 2 || faces.size() == 0 ? edges : faces, mass, com,
+            inertia);
+        vertices.rowwise() -= com.transpose();
+        center += com;
+        if (com.squaredNorm() < 1e-8) {
+            break;
+        }
+    }
+    return center;
+}
+
+RigidBodyAsset::RigidBodyAsset(
+    const Eigen::MatrixXd& vertices,
+    const Eigen::MatrixXi& edges,
+    const Eigen::MatrixXi& faces,
+    const double density,
+    const VectorMax6b& is_dof_fixed)
+    : vertices(vertices)
+    , edges(edges)
+    , faces(faces)
+    , mesh_selector(vertices.rows(), edges, faces)
+{
+    assert(edges.size() == 0 || edges.cols() == 2);
+    assert(faces.size() == 0 || faces.cols() == 3);
+
+    center_of_mass = center_vertices(this->vertices, edges, faces);
+    VectorMax3d com;
+    MatrixMax3d I;
+    compute_mass_properties(
+        this->vertices,
+        dim() == 2 || faces.size() == 0 ? edges : faces, //
+        mass, com, I);
+    // assert(com.squaredNorm() < 1e-8);
+
+    // Mass above is actually volume in m³ and density is Kg/m³
+    mass *= density;
+    if (dim() == 3) {
+        // Got this from Chrono: https://bit.ly/2RpbTl1
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
+        double threshold = I.lpNorm<Eigen::Infinity>() * 1e-16;
+        I = (threshold < I.array().abs()).select(I, 0.0);
+        es.compute(I);
+        if (es.info() != Eigen::Success) {
+            spdlog::error("Eigen decompostion of the inertia tensor failed!");
+        }
+        moment_of_inertia = density * es.eigenvalues();
+        if ((moment_of_inertia.array() < 0).any()) {
+            spdlog::warn(
+                "Negative moment of inertia ({}), inverting.",
+                fmt_eigen(moment_of_inertia));
+            // Avoid negative epsilon inertias
+            moment_of_inertia =
+                (moment_of_inertia.array() < 0)
+                    .select(-moment_of_inertia, moment_of_inertia);
+        }
+        R0 = es.eigenvectors();
+        // Ensure that we have an orientation preserving transform
+        if (R0.determinant() < 0.0) {
+            R0.col(0) *= -1.0;
+        }
+        assert(R0.isUnitary(1e-9));
+        assert(fabs(R0.determinant() - 1.0) <= 1.0e-9);
+        int num_rot_dof_fixed =
+            is_dof_fixed.tail(PoseD::dim_to_rot_ndof(dim())).count();
+        if (num_rot_dof_fixed == 2) {
+            // Convert moment of inertia to world coordinates
+            // https://physics.stackexchange.com/a/268812
+            moment_of_inertia = -I.diagonal().array() + I.diagonal().sum();
+            R0.setIdentity();
+        } else if (num_rot_dof_fixed == 1) {
+            spdlog::warn("Rigid body dynamics with two rotational DoF has "
+                         "not been tested thoroughly.");
+        }
+        // v = Rv₀ + p = RᵢR₀v₀ + p = RᵢR₀R₀ᵀv₀ + p
+        this->vertices = this->vertices * R0; // R₀ᵀ * V₀ᵀ = V₀ * R₀
+    } else {
+        moment_of_inertia = density * I.diagonal();
+        R0 = Eigen::Matrix<double, 1, 1>::Identity();
+    }
+
+    r_max = this->vertices.rowwise().norm().maxCoeff();
+    local_box_min = this->vertices.colwise().minCoeff();
+    local_box_max = this->vertices.colwise().maxCoeff();
+
+    average_edge_length = 0;
+    for (long i = 0; i < edges.rows(); i++) {
+        average_edge_length +=
+            (this->vertices.row(edges(i, 0)) - this->vertices.row(edges(i, 1)))
+                .norm();
+    }
+    if (edges.rows() > 0) {
+        average_edge_length /= edges.rows();
+    }
+    assert(std::isfinite(average_edge_length));
+
+    init_bvh();
+}
+
+void RigidBodyAsset::init_bvh()
+{
+    PROFILE_POINT("RigidBodyAsset::init_bvh");
+    PROFILE_START();
+
+    const size_t num_codim_vertices = mesh_selector.num_codim_vertices();
+    const size_t num_codim_edges = mesh_selector.num_codim_edges();
+    const size_t num_faces = faces.rows();
+
+    // heterogenous bounding boxes
+    std::vector<std::array<Eigen::Vector3d, 2>> aabbs(
+        num_codim_vertices + num_codim_edges + num_faces);
+
+    for (size_t i = 0; i < num_codim_vertices; i++) {
+        size_t vi = mesh_selector.codim_vertices_to_vertices(i);
+        if (dim() == 2) {
+            aabbs[i][0][2] = 0;
+            aabbs[i][1][2] = 0;
+        }
+        aabbs[i][0].head(dim()) = vertices.row(vi);
+        aabbs[i][1].head(dim()) = vertices.row(vi);
+    }
+
+    size_t start_i = num_codim_vertices;
+    for (size_t i = 0; i < num_codim_edges; i++) {
+        size_t ei = mesh_selector.codim_edges_to_edges(i);
+        const auto& e0 = vertices.row(edges(ei, 0));
+        const auto& e1 = vertices.row(edges(ei, 1));
+
+        if (dim() == 2) {
+            aabbs[start_i + i][0][2] = 0;
+            aabbs[start_i + i][1][2] = 0;
+        }
+        aabbs[start_i + i][0].head(dim()) = e0.cwiseMin(e1);
+        aabbs[start_i + i][1].head(dim()) = e0.cwiseMax(e1);
+    }
+
+    start_i += num_codim_edges;
+    for (size_t i = 0; i < num_faces; i++) {
+        assert(dim() == 3);
+        const auto& f0 = vertices.row(faces(i, 0));
+        const auto& f1 = vertices.row(faces(i, 1));
+        const auto& f2 = vertices.row(faces(i, 2));
+        aabbs[start_i + i][0] = f0.cwiseMin(f1).cwiseMin(f2);
+        aabbs[start_i + i][1] = f0.cwiseMax(f1).cwiseMax(f2);
+    }
+
+    bvh.init(aabbs);
+
+    PROFILE_END();
+}
+
+void RigidBodyAsset::write(std::ostream& out) const
+{
+    write_binary(out, vertices);
+    write_binary(out, edges);
+    write_binary(out, faces);
+    write_binary(out, center_of_mass);
+    write_binary(out, R0);
+    write_binary(out, mass);
+    write_binary(out, moment_of_inertia);
+    write_binary(out, average_edge_length);
+    write_binary(out, r_max);
+    write_binary(out, local_box_min);
+    write_binary(out, local_box_max);
+    mesh_selector.write(out);
+    bvh.write(out);
+}
+
+/// @brief Are all indices of the elements less than the count?
+static bool are_indices_valid(
+    const Eigen::MatrixXi& elements, int num_indices, long count)
+{
+    return elements.size() == 0
+        || (elements.cols() == num_indices && elements.minCoeff() >= 0
+            && elements.maxCoeff() < count);
+}
+
+bool RigidBodyAsset::read(BinaryReader& in)
+{
+    if (!in.read(vertices) || !in.read(edges) || !in.read(faces)
+        || (vertices.cols() != 2 && vertices.cols() != 3)
+        || !are_indices_valid(edges, 2, vertices.rows())
+        || !are_indices_valid(faces, 3, vertices.rows())) {
+        return false;
+    }
+    return in.read(center_of_mass) && in.read(R0) && in.read(mass)
+        && in.read(moment_of_inertia) && in.read(average_edge_length)
+        && in.read(r_max) && in.read(local_box_min) && in.read(local_box_max)
+        && mesh_selector.read(in, vertices.rows(), edges.rows(), faces.rows())
+        && bvh.read(in)
+        && bvh.num_primitives()
+        == mesh_selector.num_codim_vertices()
+            + mesh_selector.num_codim_edges() + faces.rows();
+}
+
+} // namespace ipc::rigid
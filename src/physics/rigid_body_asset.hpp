@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ostream>
+
+#include <Eigen/Core>
+
+#include <utils/binary_io.hpp>
+#include <utils/eigen_ext.hpp>
+#include <utils/mesh_selector.hpp>
+#include <utils/primitive_bvh.hpp>
+
+namespace ipc::rigid {
+
+/// @brief Geometry and mass properties of a rigid body in its principal frame.
+///
+/// This is the part of a RigidBody that only depends on its mesh, density,
+/// and fixed rotational DoF, so it can be shared between bodies and cached on
+/// disk (see AssetCache).
+struct RigidBodyAsset {
+    RigidBodyAsset() = default;
+
+    /// @brief Preprocess a mesh given in input coordinates.
+    /// @param is_dof_fixed Fixed DoF of the bodies using this asset.
+    RigidBodyAsset(
+        const Eigen::MatrixXd& vertices,
+        const Eigen::MatrixXi& edges,
+        const Eigen::MatrixXi& faces,
+        const double density,
+        const VectorMax6b& is_dof_fixed);
+
+    int dim() const { return vertices.cols(); }
+
+    Eigen::MatrixXd vertices; ///< Vertices positions in body space
+    Eigen::MatrixXi edges;    ///< Vertices connectivity
+    Eigen::MatrixXi faces;    ///< Vertices connectivity
+
+    /// @brief center of mass in input coordinates
+    VectorMax3d center_of_mass;
+    /// @brief rotation from the principal axes to the input orientation
+    MatrixMax3d R0;
+    /// @brief total mass (M) of the rigid body
+    double mass;
+    /// @brief moment of inertia measured with respect to the principal axes
+    VectorMax3d moment_of_inertia;
+
+    double average_edge_length; ///< Average edge length
+    /// @brief maximum distance from CM to a vertex
+    double r_max;
+    /// @brief minimum corner of the vertices' bounding box in body space
+    VectorMax3d local_box_min;
+    /// @brief maximum corner of the vertices' bounding box in body space
+    VectorMax3d local_box_max;
+
+    MeshSelector mesh_selector;
+    /// @brief BVH of the primitives in body space
+    PrimitiveBVH bvh;
+
+    /// @brief Serialize the asset (see BinaryReader).
+    void write(std::ostream& out) const;
+    bool read(BinaryReader& in);
+
+protected:
+    void init_bvh();
+};
+
+} // namespace ipc::rigid
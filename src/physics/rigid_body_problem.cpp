@@ -1,5 +1,6 @@
 #include "rigid_body_problem.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 #include <tbb/parallel_for_each.h>
@@ -26,8 +27,12 @@ RigidBodyProblem::RigidBodyProblem()
     : coefficient_restitution(0)
     , coefficient_friction(0)
     , collision_eps(2)
+    , body_order(BodyOrder::SCENE)
+    , body_reorder_frequency(0)
     , m_timestep(0.01)
     , do_intersection_check(false)
+    , incremental_intersection_check(true)
+    , m_num_steps_since_reorder(0)
 {
     gravity.setZero(3);
 }
@@ -47,6 +52,9 @@ bool RigidBodyProblem::settings(const nlohmann::json& params)
             "Disabling friction because coefficient of friction is zero");
     }
 
+    body_order = params["body_order"].get<BodyOrder>();
+    body_reorder_frequency = params["body_reorder_frequency"];
+
     std::vector<RigidBody> rbs;
     bool success = read_rb_scene(params, rbs);
     if (!success) {
@@ -61,6 +69,8 @@ bool RigidBodyProblem::settings(const nlohmann::json& params)
     gravity.conservativeResize(dim());
 
     do_intersection_check = params["do_intersection_check"];
+    incremental_intersection_check =
+        params["incremental_intersection_check"];
     return true;
 }
 
@@ -73,15 +83,19 @@ nlohmann::json RigidBodyProblem::settings() const
     json["coefficient_friction"] = coefficient_friction;
     json["gravity"] = to_json(gravity);
     json["do_intersection_check"] = do_intersection_check;
+    json["incremental_intersection_check"] = incremental_intersection_check;
+    json["body_order"] = body_order;
+    json["body_reorder_frequency"] = body_reorder_frequency;
     return json;
 }
 
 void RigidBodyProblem::init(const std::vector<RigidBody>& rbs)
 {
     m_assembler.init(rbs);
+    m_assembler.reorder_bodies(body_order);
+    m_num_steps_since_reorder = 0;
 
-    m_collision_mesh = CollisionMesh(
-        m_assembler.world_vertices(), m_assembler.m_edges, m_assembler.m_faces);
+    init_collision_meshes();
 
     update_constraints();
 
@@ -109,6 +123,45 @@ void RigidBodyProblem::init(const std::vector<RigidBody>& rbs)
     }
 }
 
+void RigidBodyProblem::init_collision_meshes()
+{
+    m_collision_mesh = CollisionMesh(
+        m_assembler.world_vertices(), m_assembler.m_edges, m_assembler.m_faces);
+
+    if (dim() == 2) {
+        // Segments of the same body (or group) cannot intersect
+        m_intersection_mesh = m_collision_mesh;
+        m_intersection_mesh.can_collide =
+            [group_ids = m_assembler.group_ids()](size_t vi, size_t vj) {
+                return group_ids[vi] != group_ids[vj];
+            };
+    }
+    m_intersection_free_poses.clear();
+}
+
+void RigidBodyProblem::update_body_order()
+{
+    if (body_order == BodyOrder::SCENE || body_reorder_frequency <= 0
+        || ++m_num_steps_since_reorder < body_reorder_frequency) {
+        return;
+    }
+    m_num_steps_since_reorder = 0;
+    if (reorder_bodies()) {
+        spdlog::debug(
+            "Re-sorted the bodies in {} order",
+            nlohmann::json(body_order).get<std::string>());
+    }
+}
+
+bool RigidBodyProblem::reorder_bodies()
+{
+    if (!m_assembler.reorder_bodies(body_order)) {
+        return false;
+    }
+    init_collision_meshes();
+    return true;
+}
+
 nlohmann::json RigidBodyProblem::state() const
 {
     nlohmann::json json;
@@ -120,7 +173,9 @@ nlohmann::json RigidBodyProblem::state() const
     double T = 0.0;                     // Kinetic energy
     double G = 0.0;                     // Potential energy
 
-    for (auto& rb : m_assembler.m_rbs) {
+    // Bodies are saved in the order of the scene file
+    for (size_t i = 0; i < num_bodies(); i++) {
+        const RigidBody& rb = m_assembler[m_assembler.body_index(i)];
         nlohmann::json jrb;
         jrb["position"] = to_json(Eigen::VectorXd(rb.pose.position));
         jrb["rotation"] = to_json(Eigen::VectorXd(rb.pose.rotation));
@@ -161,22 +216,23 @@ void RigidBodyProblem::state(const nlohmann::json& args)
     assert(rbs.size() == num_bodies());
     size_t i = 0;
     for (auto& jrb : args["rigid_bodies"]) {
-        from_json(jrb["position"], m_assembler[i].pose.position);
-        from_json(jrb["rotation"], m_assembler[i].pose.rotation);
-        from_json(jrb["linear_velocity"], m_assembler[i].velocity.position);
-        from_json(jrb["angular_velocity"], m_assembler[i].velocity.rotation);
+        RigidBody& rb = m_assembler[m_assembler.body_index(i)];
+        from_json(jrb["position"], rb.pose.position);
+        from_json(jrb["rotation"], rb.pose.rotation);
+        from_json(jrb["linear_velocity"], rb.velocity.position);
+        from_json(jrb["angular_velocity"], rb.velocity.rotation);
         if (dim() == 3) {
             if (jrb.contains("Qdot")) {
-                from_json(jrb["Qdot"], m_assembler[i].Qdot);
+                from_json(jrb["Qdot"], rb.Qdot);
             } else {
                 spdlog::warn("Missing field \"Qdot\" in rigid body state!");
-                m_assembler[i].Qdot.setZero();
+                rb.Qdot.setZero();
             }
             if (jrb.contains("Qddot")) {
-                from_json(jrb["Qddot"], m_assembler[i].Qddot);
+                from_json(jrb["Qddot"], rb.Qddot);
             } else {
                 spdlog::warn("Missing field \"Qddot\" in rigid body state!");
-                m_assembler[i].Qddot.setZero();
+                rb.Qddot.setZero();
             }
         }
         i++;
@@ -300,77 +356,73 @@ bool RigidBodyProblem::detect_intersections(const PosesD& poses) const
     PROFILE_POINT("RigidBodyProblem::detect_intersections");
     PROFILE_START();
 
-    const Eigen::MatrixXd vertices = m_assembler.world_vertices(poses);
-    const Eigen::MatrixXi& edges = this->edges();
-    const Eigen::MatrixXi& faces = this->faces();
+    // Bodies that have not moved since the last intersection-free check
+    std::vector<bool> is_unmoved(num_bodies(), false);
+    if (incremental_intersection_check
+        && m_intersection_free_poses.size() == poses.size()) {
+        for (size_t i = 0; i < num_bodies(); i++) {
+            is_unmoved[i] =
+                poses[i].position == m_intersection_free_poses[i].position
+                && poses[i].rotation == m_intersection_free_poses[i].rotation;
+        }
+    }
+    if (std::find(is_unmoved.begin(), is_unmoved.end(), false)
+        == is_unmoved.end()) {
+        PROFILE_END();
+        return false;
+    }
 
     bool is_intersecting = false;
     if (dim() == 2) { // Need to check segment-segment intersections in 2D
+        const Eigen::MatrixXd& vertices =
+            m_assembler.world_vertices_buffered(poses);
         assert(vertices.cols() == 2);
 
         double inflation_radius = 1e-8; // Conservative broad phase
         std::vector<std::pair<int, int>> close_bodies =
             m_assembler.close_bodies(poses, poses, inflation_radius);
-        if (close_bodies.size() == 0) {
-            PROFILE_END();
-            return false;
+        if (close_bodies.size() != 0) {
+            is_intersecting = ipc::has_intersections(
+                m_intersection_mesh, vertices, BroadPhaseMethod::HASH_GRID,
+                inflation_radius);
         }
 
-        // RigidBodyHashGrid hashgrid;
-        // hashgrid.resize(m_assembler, poses, close_bodies, inflation_radius);
-        // hashgrid.addBodies(m_assembler, poses, close_bodies,
-        // inflation_radius);
-
-        const Eigen::VectorXi& vertex_group_ids = group_ids();
-        auto can_vertices_collide = [&vertex_group_ids](size_t vi, size_t vj) {
-            return vertex_group_ids[vi] != vertex_group_ids[vj];
-        };
-
-        // std::vector<EdgeEdgeCandidate> ee_candidates;
-        // hashgrid.getEdgeEdgePairs(edges, ee_candidates,
-        // can_vertices_collide);
-
-        // for (const EdgeEdgeCandidate& ee_candidate : ee_candidates) {
-        //    if (igl::predicates::segment_segment_intersect(
-        //            vertices.row(edges(ee_candidate.edge0_id,
-        //            0)).head<2>(),
-        //            vertices.row(edges(ee_candidate.edge0_id,
-        //            1)).head<2>(),
-        //            vertices.row(edges(ee_candidate.edge1_id,
-        //            0)).head<2>(),
-        //            vertices.row(edges(ee_candidate.edge1_id,
-        //            1)).head<2>())
-        //        ) {
-        //        is_intersecting = true;
-        //        break;
-        //    }
-        //}
-
-        CollisionMesh collision_mesh(vertices, edges, faces);
-        collision_mesh.can_collide = can_vertices_collide;
-
-        is_intersecting = ipc::has_intersections(
-            collision_mesh, vertices, BroadPhaseMethod::HASH_GRID,
-            inflation_radius);
-
     } else { // Need to check segment-triangle intersections in 3D
         assert(dim() == 3);
 
-        std::vector<EdgeFaceCandidate> ef_candidates;
-        detect_intersection_candidates_rigid_bvh(
-            m_assembler, poses, ef_candidates);
-
-        for (const EdgeFaceCandidate& ef_candidate : ef_candidates) {
-            if (is_edge_intersecting_triangle(
+        // Only pairs with a moved body can have become intersecting
+        std::vector<std::pair<int, int>> body_pairs =
+            m_assembler.close_bodies(poses, poses, /*inflation_radius=*/0);
+        body_pairs.erase(
+            std::remove_if(
+                body_pairs.begin(), body_pairs.end(),
+                [&](const std::pair<int, int>& body_pair) {
+                    return is_unmoved[body_pair.first]
+                        && is_unmoved[body_pair.second];
+                }),
+            body_pairs.end());
+
+        const Eigen::MatrixXd& vertices =
+            m_assembler.world_vertices_buffered(poses);
+        const Eigen::MatrixXi& edges = this->edges();
+        const Eigen::MatrixXi& faces = this->faces();
+
+        is_intersecting = find_intersection_rigid_bvh(
+            m_assembler, poses, body_pairs,
+            [&](const EdgeFaceCandidate& ef_candidate) {
+                return is_edge_intersecting_triangle(
                     vertices.row(edges(ef_candidate.edge_id, 0)),
                     vertices.row(edges(ef_candidate.edge_id, 1)),
                     vertices.row(faces(ef_candidate.face_id, 0)),
                     vertices.row(faces(ef_candidate.face_id, 1)),
-                    vertices.row(faces(ef_candidate.face_id, 2)))) {
-                is_intersecting = true;
-                break;
-            }
-        }
+                    vertices.row(faces(ef_candidate.face_id, 2)));
+            });
+    }
+
+    if (is_intersecting) {
+        m_intersection_free_poses.clear();
+    } else {
+        m_intersection_free_poses = poses;
     }
 
     PROFILE_END();
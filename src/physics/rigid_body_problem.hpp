@@ -49,7 +49,7 @@ public:
     /// World vertices at the END of step (current).
     Eigen::MatrixXd vertices() const override
     {
-        return m_assembler.world_vertices_t1();
+        return m_assembler.world_vertices_buffered(m_assembler.rb_poses_t1());
     }
 
     const Eigen::MatrixXi& edges() const override
@@ -130,6 +130,9 @@ public:
     double coefficient_friction;    ///< Coefficent of friction
     VectorMax3d gravity;            ///< Acceleration due to gravity
     double collision_eps;           ///< Scale trajectory for early collision
+    BodyOrder body_order;           ///< Order of the bodies in the DoF
+    /// Time-steps between re-sorting the bodies (0 to only sort initially)
+    int body_reorder_frequency;
 
     RigidBodyAssembler m_assembler;
 
@@ -150,6 +153,16 @@ protected:
 
     virtual void update_dof();
 
+    /// @brief Re-sort the bodies every body_reorder_frequency time-steps.
+    /// Must be called at the start of a time-step.
+    void update_body_order();
+    /// @brief Sort the bodies by body_order and rebuild what depends on the
+    /// global vertex ids.
+    /// @return True if the order changed.
+    virtual bool reorder_bodies();
+    /// @brief Build the collision meshes from the assembler.
+    void init_collision_meshes();
+
     /// @returns \f$x_0\f$: the starting point for the optimization.
     const Eigen::VectorXd& starting_point() const { return x0; }
 
@@ -165,6 +178,15 @@ protected:
     double init_bbox_diagonal;
 
     bool do_intersection_check;
+    /// Only check body pairs with a body moved since the last check found no
+    /// intersections.
+    bool incremental_intersection_check;
+    /// Poses of the last intersection-free check (empty if none)
+    mutable PosesD m_intersection_free_poses;
+    /// Collision mesh for the 2D intersection check
+    CollisionMesh m_intersection_mesh;
+    /// Time-steps taken since the bodies were last sorted
+    int m_num_steps_since_reorder;
 };
 
 } // namespace ipc::rigid
@@ -139,6 +139,10 @@ public:
     virtual double barrier_stiffness() const = 0;
     virtual void barrier_stiffness(const double kappa) = 0;
 
+    /// Number of active barriers at the start of the time-step (negative if
+    /// unknown).
+    virtual int num_active_barriers_t0() const { return -1; }
+
 protected:
     bool m_use_barriers = true;
 };
@@ -1,5 +1,7 @@
 #include "distance_barrier_rb_problem.hpp"
 
+#include <iterator>
+
 #include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
 
@@ -26,6 +28,9 @@ DistanceBarrierRBProblem::DistanceBarrierRBProblem()
     : m_barrier_stiffness(1)
     , min_distance(-1)
     , m_had_collisions(false)
+    , m_num_active_barriers_t0(-1)
+    , warm_start(false)
+    , barrier_hessian_projection(EIGEN_PROJECTION)
     , static_friction_speed_bound(1e-3)
     , friction_iterations(1)
     , body_energy_integration_method(DEFAULT_BODY_ENERGY_INTEGRATION_METHOD)
@@ -53,6 +58,10 @@ bool DistanceBarrierRBProblem::settings(const nlohmann::json& params)
     body_energy_integration_method =
         params["rigid_body_problem"]["time_stepper"]
             .get<BodyEnergyIntegrationMethod>();
+    warm_start = params["rigid_body_problem"]["warm_start"];
+    barrier_hessian_projection =
+        params["rigid_body_problem"]["barrier_hessian_projection"]
+            .get<BarrierHessianProjection>();
     bool success = RigidBodyProblem::settings(params["rigid_body_problem"]);
 
     if (!success) {
@@ -86,6 +95,8 @@ nlohmann::json DistanceBarrierRBProblem::settings() const
     json["friction_iterations"] = friction_iterations;
     json["static_friction_speed_bound"] = static_friction_speed_bound;
     json["time_stepper"] = body_energy_integration_method;
+    json["warm_start"] = warm_start;
+    json["barrier_hessian_projection"] = barrier_hessian_projection;
     return json;
 }
 
@@ -119,6 +130,8 @@ Eigen::VectorXi DistanceBarrierRBProblem::free_dof() const
 void DistanceBarrierRBProblem::simulation_step(
     bool& had_collisions, bool& _has_intersections, bool solve_collisions)
 {
+    update_body_order();
+
     // Advance the poses, but leave the current pose unchanged for now.
     for (size_t i = 0; i < num_bodies(); i++) {
         m_assembler[i].pose_prev = m_assembler[i].pose;
@@ -143,6 +156,20 @@ void DistanceBarrierRBProblem::simulation_step(
     had_collisions = m_had_collisions;
 }
 
+bool DistanceBarrierRBProblem::reorder_bodies()
+{
+    if (!RigidBodyProblem::reorder_bodies()) {
+        return false;
+    }
+    // The cached constraints refer to the old global vertex ids
+    m_constraint.clear_constraint_set_cache();
+    // The last factorization of the hessian is in the old order of the DoF
+    if (m_opt_solver) {
+        m_opt_solver->clear_factorization();
+    }
+    return true;
+}
+
 void DistanceBarrierRBProblem::update_constraints()
 {
     PROFILE_POINT("DistanceBarrierRBProblem::update_constraints");
@@ -153,6 +180,7 @@ void DistanceBarrierRBProblem::update_constraints()
     CollisionConstraints collision_constraints;
     m_constraint.construct_constraint_set(
         m_collision_mesh, m_assembler, poses_t0, collision_constraints);
+    m_num_active_barriers_t0 = collision_constraints.size();
 
     Eigen::SparseMatrix<double> hess;
     compute_barrier_term(
@@ -179,8 +207,8 @@ void DistanceBarrierRBProblem::update_friction_constraints(
     // The fricition constraints are constant through out the entire
     // lagging iteration.
     friction_constraints.clear();
-    Eigen::MatrixXd V0 =
-        m_collision_mesh.displace_vertices(m_assembler.world_vertices(poses));
+    Eigen::MatrixXd V0 = m_collision_mesh.displace_vertices(
+        m_assembler.world_vertices_buffered(poses));
     friction_constraints.build(
         m_collision_mesh, V0, collision_constraints,
         barrier_activation_distance(), barrier_stiffness(),
@@ -195,25 +223,31 @@ void DistanceBarrierRBProblem::init_augmented_lagrangian()
     int pos_ndof = PoseD::dim_to_pos_ndof(dim());
     int rot_ndof = PoseD::dim_to_rot_ndof(dim());
 
+    // Compact the kinematic bodies, so the AL loops skip every other body
+    kinematic_bodies.clear();
+    for (size_t i = 0; i < num_bodies(); i++) {
+        if (m_assembler[i].type == RigidBodyType::KINEMATIC) {
+            if (m_assembler[i].kinematic_max_time < 0) {
+                m_assembler[i].convert_to_static();
+            } else {
+                kinematic_bodies.push_back(i);
+            }
+        }
+    }
+
     linear_augmented_lagrangian_penalty = 1e3;
     angular_augmented_lagrangian_penalty = 1e3;
-    size_t num_kinematic_bodies = m_assembler.count_kinematic_bodies();
     linear_augmented_lagrangian_multiplier.setZero(
-        pos_ndof * num_kinematic_bodies);
+        pos_ndof * kinematic_bodies.size());
     angular_augmented_lagrangian_multiplier.setZero(
-        rot_ndof * num_kinematic_bodies, rot_ndof);
-
-    for (int i = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].type == RigidBodyType::KINEMATIC
-            && m_assembler[i].kinematic_max_time < 0) {
-            m_assembler[i].convert_to_static();
-        }
-    }
+        rot_ndof * kinematic_bodies.size(), rot_ndof);
 
     x_pred = x0;
-    for (int i = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].kinematic_poses.size()) {
-            const PoseD& pose = m_assembler[i].kinematic_poses.front();
+    is_dof_satisfied.setZero(x0.size());
+    tbb::parallel_for(size_t(0), num_bodies(), [&](size_t i) {
+        const RigidBody& body = m_assembler[i];
+        if (body.kinematic_poses.size()) {
+            const PoseD& pose = body.kinematic_poses.front();
             // Kinematic position
             x_pred.segment(ndof * i, pos_ndof) = pose.position;
             // Kinematic rotation
@@ -221,35 +255,38 @@ void DistanceBarrierRBProblem::init_augmented_lagrangian()
         } else {
             // Kinematic position
             x_pred.segment(ndof * i, pos_ndof) +=
-                timestep() * m_assembler[i].velocity.position;
+                timestep() * body.velocity.position;
             // Kinematic rotation
             x_pred.segment(ndof * i + pos_ndof, rot_ndof) +=
-                timestep() * m_assembler[i].velocity.rotation;
+                timestep() * body.velocity.rotation;
         }
-    }
-
-    is_dof_satisfied.setZero(x0.size());
-    for (int i = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].type == RigidBodyType::STATIC) {
+        if (body.type == RigidBodyType::STATIC) {
             is_dof_satisfied.segment(ndof * i, ndof).setOnes();
         }
-    }
+    });
+
+    // The predicted rotations are constant throughout the solve
+    kinematic_Q_pred.resize(dim() == 3 ? kinematic_bodies.size() : 0);
+    tbb::parallel_for(size_t(0), kinematic_Q_pred.size(), [&](size_t ki) {
+        size_t ri = ndof * kinematic_bodies[ki] + pos_ndof;
+        kinematic_Q_pred[ki] = construct_rotation_matrix(
+            VectorMax3d(x_pred.segment(ri, rot_ndof)));
+    });
 }
 
 void DistanceBarrierRBProblem::step_kinematic_bodies()
 {
-    for (int i = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].type == RigidBodyType::KINEMATIC) {
-            if (m_assembler[i].kinematic_max_time < 0) {
-                m_assembler[i].convert_to_static();
-            } else {
-                m_assembler[i].kinematic_max_time -= timestep();
-                if (m_assembler[i].kinematic_poses.size()) {
-                    m_assembler[i].kinematic_poses.pop_front();
-                }
+    tbb::parallel_for(size_t(0), kinematic_bodies.size(), [&](size_t ki) {
+        RigidBody& body = m_assembler[kinematic_bodies[ki]];
+        if (body.kinematic_max_time < 0) {
+            body.convert_to_static();
+        } else {
+            body.kinematic_max_time -= timestep();
+            if (body.kinematic_poses.size()) {
+                body.kinematic_poses.pop_front();
             }
         }
-    }
+    });
 }
 
 inline DiagonalMatrix3d compute_J(const VectorMax3d& I)
@@ -279,31 +316,37 @@ inline DiagonalMatrix3d compute_Jsqrt(const VectorMax3d& I)
         sqrt(std::max(0.5 * (I.x() + I.y() - I.z()), 0.0)));
 }
 
-double DistanceBarrierRBProblem::compute_linear_augment_lagrangian_progress(
-    const Eigen::VectorXd& x) const
+/// @brief Progress 1 - √(∑aᵢ / ∑bᵢ) from per-body terms (summed in order).
+static double
+augmented_lagrangian_progress(const Eigen::MatrixX2d& per_body_terms)
 {
-    int ndof = PoseD::dim_to_ndof(dim());
-    int pos_ndof = PoseD::dim_to_pos_ndof(dim());
-
     double a = 0, b = 0;
-
-    for (size_t i = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].type == RigidBodyType::KINEMATIC) {
-            a += (x_pred.segment(ndof * i, pos_ndof)
-                  - x.segment(ndof * i, pos_ndof))
-                     .squaredNorm();
-            b += (x_pred.segment(ndof * i, pos_ndof)
-                  - x0.segment(ndof * i, pos_ndof))
-                     .squaredNorm();
-        }
+    for (int i = 0; i < per_body_terms.rows(); i++) {
+        a += per_body_terms(i, 0);
+        b += per_body_terms(i, 1);
     }
-
     if (a == 0 && b == 0) {
         return 1;
     }
     return 1 - sqrt(a / (b == 0 ? 1 : b));
 }
 
+double DistanceBarrierRBProblem::compute_linear_augment_lagrangian_progress(
+    const Eigen::VectorXd& x) const
+{
+    int ndof = PoseD::dim_to_ndof(dim());
+    int pos_ndof = PoseD::dim_to_pos_ndof(dim());
+
+    Eigen::MatrixX2d terms(kinematic_bodies.size(), 2);
+    tbb::parallel_for(size_t(0), kinematic_bodies.size(), [&](size_t ki) {
+        size_t i = kinematic_bodies[ki];
+        const auto& q_pred = x_pred.segment(ndof * i, pos_ndof);
+        terms(ki, 0) = (q_pred - x.segment(ndof * i, pos_ndof)).squaredNorm();
+        terms(ki, 1) = (q_pred - x0.segment(ndof * i, pos_ndof)).squaredNorm();
+    });
+    return augmented_lagrangian_progress(terms);
+}
+
 double DistanceBarrierRBProblem::compute_angular_augment_lagrangian_progress(
     const Eigen::VectorXd& x) const
 {
@@ -311,31 +354,27 @@ double DistanceBarrierRBProblem::compute_angular_augment_lagrangian_progress(
     int rot_ndof = PoseD::dim_to_rot_ndof(dim());
     int pos_ndof = PoseD::dim_to_pos_ndof(dim());
 
-    double a = 0, b = 0;
-    for (size_t i = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].type == RigidBodyType::KINEMATIC) {
-            size_t ri = ndof * i + pos_ndof;
-            if (dim() == 2) {
-                a += (x_pred.segment(ri, rot_ndof) - x.segment(ri, rot_ndof))
-                         .squaredNorm();
-                b += (x_pred.segment(ri, rot_ndof) - x0.segment(ri, rot_ndof))
-                         .squaredNorm();
-            } else {
-                auto Q_pred = construct_rotation_matrix(
-                    VectorMax3d(x_pred.segment(ri, rot_ndof)));
-                auto Q = construct_rotation_matrix(
-                    VectorMax3d(x.segment(ri, rot_ndof)));
-                auto Q0 = construct_rotation_matrix(
-                    VectorMax3d(x0.segment(ri, rot_ndof)));
-                a += (Q - Q_pred).squaredNorm();
-                b += (Q0 - Q_pred).squaredNorm();
-            }
+    Eigen::MatrixX2d terms(kinematic_bodies.size(), 2);
+    tbb::parallel_for(size_t(0), kinematic_bodies.size(), [&](size_t ki) {
+        size_t ri = ndof * kinematic_bodies[ki] + pos_ndof;
+        if (dim() == 2) {
+            terms(ki, 0) =
+                (x_pred.segment(ri, rot_ndof) - x.segment(ri, rot_ndof))
+                    .squaredNorm();
+            terms(ki, 1) =
+                (x_pred.segment(ri, rot_ndof) - x0.segment(ri, rot_ndof))
+                    .squaredNorm();
+        } else {
+            const Eigen::Matrix3d& Q_pred = kinematic_Q_pred[ki];
+            auto Q =
+                construct_rotation_matrix(VectorMax3d(x.segment(ri, rot_ndof)));
+            auto Q0 = construct_rotation_matrix(
+                VectorMax3d(x0.segment(ri, rot_ndof)));
+            terms(ki, 0) = (Q - Q_pred).squaredNorm();
+            terms(ki, 1) = (Q0 - Q_pred).squaredNorm();
         }
-    }
-    if (a == 0 && b == 0) {
-        return 1;
-    }
-    return 1 - sqrt(a / (b == 0 ? 1 : b));
+    });
+    return augmented_lagrangian_progress(terms);
 }
 
 void DistanceBarrierRBProblem::update_augmented_lagrangian(
@@ -350,65 +389,53 @@ void DistanceBarrierRBProblem::update_augmented_lagrangian(
 
     if (eta_q >= 0.999) {
         // Fix the kinematic DoF that have converged
-        for (size_t i = 0; i < num_bodies(); i++) {
-            if (m_assembler[i].type == RigidBodyType::KINEMATIC) {
-                is_dof_satisfied.segment(ndof * i, pos_ndof).setOnes();
-            }
+        for (size_t i : kinematic_bodies) {
+            is_dof_satisfied.segment(ndof * i, pos_ndof).setOnes();
         }
     } else if (eta_q < 0.99 && linear_augmented_lagrangian_penalty < 1e8) {
         // Increase the κ_q
         linear_augmented_lagrangian_penalty *= 2;
     } else {
         // Increase the λ
-        for (size_t i = 0, ki = 0; i < num_bodies(); i++) {
-            if (m_assembler[i].type == RigidBodyType::KINEMATIC) {
-                linear_augmented_lagrangian_multiplier.segment(
-                    ki * pos_ndof, pos_ndof) -=
-                    linear_augmented_lagrangian_penalty
-                    * sqrt(m_assembler[i].mass)
-                    * (x.segment(ndof * i, pos_ndof)
-                       - x_pred.segment(ndof * i, pos_ndof));
-                ki++;
-            }
-        }
+        tbb::parallel_for(size_t(0), kinematic_bodies.size(), [&](size_t ki) {
+            size_t i = kinematic_bodies[ki];
+            linear_augmented_lagrangian_multiplier.segment(
+                ki * pos_ndof, pos_ndof) -= linear_augmented_lagrangian_penalty
+                * sqrt(m_assembler[i].mass)
+                * (x.segment(ndof * i, pos_ndof)
+                   - x_pred.segment(ndof * i, pos_ndof));
+        });
     }
 
     if (eta_Q >= 0.999) {
         // Fix the kinematic DoF that have converged
-        for (size_t i = 0; i < num_bodies(); i++) {
-            if (m_assembler[i].type == RigidBodyType::KINEMATIC) {
-                is_dof_satisfied.segment(ndof * i + pos_ndof, rot_ndof)
-                    .setOnes();
-            }
+        for (size_t i : kinematic_bodies) {
+            is_dof_satisfied.segment(ndof * i + pos_ndof, rot_ndof).setOnes();
         }
     } else if (eta_Q < 0.99 && angular_augmented_lagrangian_penalty < 1e8) {
         // Increase the κ_Q
         angular_augmented_lagrangian_penalty *= 2;
     } else {
         // Increase the Λ
-        for (size_t i = 0, ki = 0; i < num_bodies(); i++) {
-            if (m_assembler[i].type == RigidBodyType::KINEMATIC) {
-                size_t ri = ndof * i + pos_ndof;
-                if (dim() == 2) {
-                    angular_augmented_lagrangian_multiplier.middleRows(
-                        ki * rot_ndof, rot_ndof) -=
-                        angular_augmented_lagrangian_penalty
-                        * sqrt(m_assembler[i].moment_of_inertia[0])
-                        * (x.segment(ri, rot_ndof)
-                           - x_pred.segment(ri, rot_ndof));
-                } else {
-                    auto Q_pred = construct_rotation_matrix(
-                        VectorMax3d(x_pred.segment(ri, rot_ndof)));
-                    auto Q = construct_rotation_matrix(
-                        VectorMax3d(x.segment(ri, rot_ndof)));
-                    angular_augmented_lagrangian_multiplier.middleRows(
-                        rot_ndof * ki, rot_ndof) -=
-                        angular_augmented_lagrangian_penalty * (Q - Q_pred)
-                        * compute_Jsqrt(m_assembler[i].moment_of_inertia);
-                }
-                ki++;
+        tbb::parallel_for(size_t(0), kinematic_bodies.size(), [&](size_t ki) {
+            size_t i = kinematic_bodies[ki];
+            size_t ri = ndof * i + pos_ndof;
+            if (dim() == 2) {
+                angular_augmented_lagrangian_multiplier.middleRows(
+                    ki * rot_ndof, rot_ndof) -=
+                    angular_augmented_lagrangian_penalty
+                    * sqrt(m_assembler[i].moment_of_inertia[0])
+                    * (x.segment(ri, rot_ndof) - x_pred.segment(ri, rot_ndof));
+            } else {
+                auto Q = construct_rotation_matrix(
+                    VectorMax3d(x.segment(ri, rot_ndof)));
+                angular_augmented_lagrangian_multiplier.middleRows(
+                    rot_ndof * ki, rot_ndof) -=
+                    angular_augmented_lagrangian_penalty
+                    * (Q - kinematic_Q_pred[ki])
+                    * compute_Jsqrt(m_assembler[i].moment_of_inertia);
             }
-        }
+        });
     }
 
     if (eta_q < 0.999 || eta_Q < 0.999) {
@@ -426,17 +453,42 @@ void DistanceBarrierRBProblem::update_augmented_lagrangian(
 bool DistanceBarrierRBProblem::are_equality_constraints_satisfied(
     const Eigen::VectorXd& x) const
 {
-    if (m_assembler.count_kinematic_bodies()) {
+    if (!kinematic_bodies.empty()) {
         return compute_linear_augment_lagrangian_progress(x) >= 0.999
             && compute_angular_augment_lagrangian_progress(x) >= 0.999;
     }
     return true;
 }
 
+Eigen::VectorXd DistanceBarrierRBProblem::compute_warm_start()
+{
+    // x_pred extrapolates the previous step's velocity (or uses the
+    // kinematic targets), so start from it as far as CCD allows.
+    Eigen::VectorXd x = is_dof_fixed().select(x0, x_pred);
+    if (!m_use_barriers) {
+        return x;
+    }
+
+    bool had_collisions = m_had_collisions;
+    double toi = compute_earliest_toi(x0, x);
+    m_had_collisions = had_collisions; // Only the solve should set this
+
+    if (toi < 1) {
+        // Stay well away from the contact so the barrier is well behaved
+        double alpha = 0.5 * toi;
+        if (alpha < 1e-3) {
+            return x0;
+        }
+        x = x0 + alpha * (x - x0);
+    }
+    spdlog::debug("warm_start toi={:g}", toi);
+    return x;
+}
+
 OptimizationResults DistanceBarrierRBProblem::solve_constraints()
 {
     OptimizationResults opt_result;
-    opt_result.x = starting_point();
+    opt_result.x = warm_start ? compute_warm_start() : starting_point();
     double momentum_balance, eps_d = 1e-2 * world_bbox_diagonal();
     int i = 0;
     int total_newton_iterations = 0;
@@ -954,22 +1006,19 @@ double DistanceBarrierRBProblem::compute_augmented_lagrangian(
     int ndof = PoseD::dim_to_ndof(dim());
     int pos_ndof = PoseD::dim_to_pos_ndof(dim());
     int rot_ndof = PoseD::dim_to_rot_ndof(dim());
-    size_t num_kinematic_bodies = m_assembler.count_kinematic_bodies();
+    size_t num_kinematic_bodies = kinematic_bodies.size();
 
     double potential = 0;
     if (compute_grad) {
         grad.setZero(x.size());
     }
-    std::vector<Eigen::Triplet<double>> hess_triplets;
     if (compute_hess) {
         hess.resize(x.size(), x.size());
-        hess_triplets.reserve(num_kinematic_bodies * ndof);
     }
 
     bool all_kinematic_dof_satisfied = true;
-    for (size_t i = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].type == RigidBodyType::KINEMATIC
-            && !is_dof_satisfied.segment(ndof * i, ndof).all()) {
+    for (size_t i : kinematic_bodies) {
+        if (!is_dof_satisfied.segment(ndof * i, ndof).all()) {
             all_kinematic_dof_satisfied = false;
             break;
         }
@@ -982,101 +1031,119 @@ double DistanceBarrierRBProblem::compute_augmented_lagrangian(
     PROFILE_POINT("DistanceBarrierRBProblem::compute_augmented_lagrangian");
     PROFILE_START();
 
-    // Compute the linear AL potential
-    const double& kappa_q = linear_augmented_lagrangian_penalty;
-    for (size_t i = 0, ki = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].type != RigidBodyType::KINEMATIC) {
-            continue;
-        }
+    // Each kinematic body writes its own DoF of the gradient and a fixed
+    // number of Hessian entries, so the bodies are independent.
+    const int num_hess_entries = pos_ndof + rot_ndof * rot_ndof;
+    std::vector<Eigen::Triplet<double>> hess_triplets;
+    if (compute_hess) {
+        hess_triplets.resize(num_kinematic_bodies * num_hess_entries);
+    }
+    Eigen::VectorXd potentials(num_kinematic_bodies);
 
-        double m = m_assembler[i].mass;
-        const auto& lambda = linear_augmented_lagrangian_multiplier.segment(
-            ki * pos_ndof, pos_ndof);
+    typedef AutodiffType<Eigen::Dynamic, /*maxN=*/3> Diff;
 
-        const auto& q = x.segment(i * ndof, pos_ndof);
-        const auto& q_pred = x_pred.segment(i * ndof, pos_ndof);
+    const double& kappa_q = linear_augmented_lagrangian_penalty;
+    const double& kappa_Q = angular_augmented_lagrangian_penalty;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(size_t(0), num_kinematic_bodies),
+        [&](const tbb::blocked_range<size_t>& range) {
+            // Activate autodiff with the correct number of variables
+            Diff::activate(rot_ndof);
 
-        potential += kappa_q / 2 * m * (q - q_pred).squaredNorm()
-            - sqrt(m) * lambda.dot(q - q_pred);
-        if (compute_grad) {
-            grad.segment(i * ndof, pos_ndof) =
-                kappa_q * m * (q - q_pred) - sqrt(m) * lambda;
-        }
-        if (compute_hess) {
-            for (int j = 0; j < pos_ndof; j++) {
-                hess_triplets.emplace_back(
-                    ndof * i + j, ndof * i + j, kappa_q * m);
-            }
-        }
+            for (size_t ki = range.begin(); ki != range.end(); ++ki) {
+                const size_t i = kinematic_bodies[ki];
+                size_t ti = ki * num_hess_entries; // First Hessian entry
 
-        ki++;
-    }
+                // Compute the linear AL potential
+                double m = m_assembler[i].mass;
+                const auto& lambda =
+                    linear_augmented_lagrangian_multiplier.segment(
+                        ki * pos_ndof, pos_ndof);
 
-    typedef AutodiffType<Eigen::Dynamic, /*maxN=*/3> Diff;
-    Diff::activate(rot_ndof);
+                const auto& q = x.segment(i * ndof, pos_ndof);
+                const auto& q_pred = x_pred.segment(i * ndof, pos_ndof);
 
-    // Compute the angular AL potential
-    const double& kappa_Q = angular_augmented_lagrangian_penalty;
-    for (size_t i = 0, ki = 0; i < num_bodies(); i++) {
-        if (m_assembler[i].type != RigidBodyType::KINEMATIC) {
-            continue;
-        }
+                potentials[ki] = kappa_q / 2 * m * (q - q_pred).squaredNorm()
+                    - sqrt(m) * lambda.dot(q - q_pred);
+                if (compute_grad) {
+                    grad.segment(i * ndof, pos_ndof) =
+                        kappa_q * m * (q - q_pred) - sqrt(m) * lambda;
+                }
+                if (compute_hess) {
+                    for (int j = 0; j < pos_ndof; j++) {
+                        hess_triplets[ti++] = Eigen::Triplet<double>(
+                            ndof * i + j, ndof * i + j, kappa_q * m);
+                    }
+                }
 
-        const VectorMax3d& moment_of_inertia = m_assembler[i].moment_of_inertia;
-        MatrixMax3d lambda = angular_augmented_lagrangian_multiplier.middleRows(
-            rot_ndof * ki, rot_ndof);
+                // Compute the angular AL potential
+                const VectorMax3d& moment_of_inertia =
+                    m_assembler[i].moment_of_inertia;
+                MatrixMax3d Lambda =
+                    angular_augmented_lagrangian_multiplier.middleRows(
+                        rot_ndof * ki, rot_ndof);
 
-        VectorMax3d theta = x.segment(i * ndof + pos_ndof, rot_ndof);
-        VectorMax3d theta_pred = x_pred.segment(i * ndof + pos_ndof, rot_ndof);
+                VectorMax3d theta = x.segment(i * ndof + pos_ndof, rot_ndof);
+                VectorMax3d theta_pred =
+                    x_pred.segment(i * ndof + pos_ndof, rot_ndof);
 
-        if (dim() == 2) {
-            double I = moment_of_inertia(0);
-            double Isqrt = sqrt(I);
+                if (dim() == 2) {
+                    double I = moment_of_inertia(0);
+                    double Isqrt = sqrt(I);
 
-            potential += kappa_Q / 2 * I * (theta - theta_pred).squaredNorm()
-                - (Isqrt * lambda.transpose() * (theta - theta_pred)).trace();
+                    potentials[ki] += kappa_Q / 2 * I
+                            * (theta - theta_pred).squaredNorm()
+                        - (Isqrt * Lambda.transpose() * (theta - theta_pred))
+                              .trace();
 
-            if (compute_grad) {
-                grad.segment(i * ndof + pos_ndof, rot_ndof) =
-                    kappa_Q * I * (theta - theta_pred) - Isqrt * lambda;
-            }
-            if (compute_hess) {
-                for (int j = 0; j < rot_ndof; j++) {
-                    hess_triplets.emplace_back(
-                        ndof * i + pos_ndof + j, ndof * i + pos_ndof + j,
-                        kappa_Q * I);
-                }
-            }
-        } else {
-            VectorMax3<Diff::DDouble2> theta_diff = Diff::d2vars(0, theta);
+                    if (compute_grad) {
+                        grad.segment(i * ndof + pos_ndof, rot_ndof) =
+                            kappa_Q * I * (theta - theta_pred) - Isqrt * Lambda;
+                    }
+                    if (compute_hess) {
+                        for (int j = 0; j < rot_ndof; j++) {
+                            hess_triplets[ti++] = Eigen::Triplet<double>(
+                                ndof * i + pos_ndof + j,
+                                ndof * i + pos_ndof + j, kappa_Q * I);
+                        }
+                    }
+                } else {
+                    VectorMax3<Diff::DDouble2> theta_diff =
+                        Diff::d2vars(0, theta);
 
-            DiagonalMatrix3d J = compute_J(moment_of_inertia);
-            DiagonalMatrix3d Jsqrt = compute_Jsqrt(moment_of_inertia);
+                    DiagonalMatrix3d J = compute_J(moment_of_inertia);
+                    DiagonalMatrix3d Jsqrt = compute_Jsqrt(moment_of_inertia);
 
-            const auto& Q = construct_rotation_matrix(theta_diff);
-            const auto& Q_pred = construct_rotation_matrix(theta_pred);
+                    const auto& Q = construct_rotation_matrix(theta_diff);
+                    const Eigen::Matrix3d& Q_pred = kinematic_Q_pred[ki];
 
-            Diff::DDouble2 dAL = kappa_Q / 2
-                    * ((Q - Q_pred) * J * (Q - Q_pred).transpose()).trace()
-                - (lambda.transpose() * (Q - Q_pred) * Jsqrt).trace();
+                    Diff::DDouble2 dAL = kappa_Q / 2
+                            * ((Q - Q_pred) * J * (Q - Q_pred).transpose())
+                                  .trace()
+                        - (Lambda.transpose() * (Q - Q_pred) * Jsqrt).trace();
 
-            potential += dAL.getValue();
-            if (compute_grad) {
-                grad.segment(i * ndof + pos_ndof, rot_ndof) = dAL.getGradient();
-            }
-            if (compute_hess) {
-                Eigen::Matrix3d H = dAL.getHessian();
-                for (int hi = 0; hi < H.rows(); hi++) {
-                    for (int hj = 0; hj < H.cols(); hj++) {
-                        hess_triplets.emplace_back(
-                            ndof * i + pos_ndof + hi, ndof * i + pos_ndof + hj,
-                            H(hi, hj));
+                    potentials[ki] += dAL.getValue();
+                    if (compute_grad) {
+                        grad.segment(i * ndof + pos_ndof, rot_ndof) =
+                            dAL.getGradient();
+                    }
+                    if (compute_hess) {
+                        Eigen::Matrix3d H = dAL.getHessian();
+                        for (int hi = 0; hi < H.rows(); hi++) {
+                            for (int hj = 0; hj < H.cols(); hj++) {
+                                hess_triplets[ti++] = Eigen::Triplet<double>(
+                                    ndof * i + pos_ndof + hi,
+                                    ndof * i + pos_ndof + hj, H(hi, hj));
+                            }
+                        }
                     }
                 }
             }
-        }
+        });
 
-        ki++;
+    // Sum in body order, so the potential does not depend on the scheduling
+    for (size_t ki = 0; ki < num_kinematic_bodies; ki++) {
+        potential += potentials[ki];
     }
 
     if (compute_hess) {
@@ -1141,18 +1208,22 @@ double DistanceBarrierRBProblem::compute_barrier_term(
     return Bx;
 }
 
-// Convert from a local hessian to the triplets in the global hessian
+// Convert from a local gradient to the sparse entries of the global gradient
+// (stored as triplets with a column of zero)
 template <typename DerivedLocalGradient>
-void local_gradient_to_global(
+void local_gradient_to_global_triplets(
     const Eigen::MatrixBase<DerivedLocalGradient>& local_gradient,
     const std::array<long, 2>& body_ids,
     int ndof,
-    Eigen::VectorXd& grad)
+    std::vector<Eigen::Triplet<double>>& triplets)
 {
     assert(local_gradient.size() == 2 * ndof);
     for (int b_i = 0; b_i < body_ids.size(); b_i++) {
-        grad.segment(ndof * body_ids[b_i], ndof) +=
-            local_gradient.segment(ndof * b_i, ndof);
+        for (int dof_i = 0; dof_i < ndof; dof_i++) {
+            triplets.emplace_back(
+                ndof * body_ids[b_i] + dof_i, 0,
+                local_gradient(ndof * b_i + dof_i));
+        }
     }
 }
 
@@ -1180,6 +1251,83 @@ void local_hessian_to_global_triplets(
     }
 }
 
+// Fixed-size version of apply_chain_rule() for constraints between four
+// vertices in 3D (edge-edge and point-triangle).
+void apply_chain_rule_fixed_3d(
+    const VectorMax12d& grad_f,
+    const Eigen::MatrixXd& jac_V,
+    const MatrixMax12d& hess_f,
+    const Eigen::MatrixXd& hess_V,
+    const std::array<long, 4>& vertex_ids,
+    const std::vector<uint8_t>& local_body_ids,
+    const std::array<long, 2>& body_ids,
+    std::vector<Eigen::Triplet<double>>& grad_triplets,
+    std::vector<Eigen::Triplet<double>>& hess_triplets,
+    bool compute_grad,
+    bool compute_hess,
+    BarrierHessianProjection projection)
+{
+    constexpr int Dim = 3;
+    constexpr int rb_ndof = 6;
+    constexpr int n = 4 * Dim;
+    typedef Eigen::Matrix<double, 2 * rb_ndof, 1> LocalGradient;
+    typedef Eigen::Matrix<double, 2 * rb_ndof, 2 * rb_ndof> LocalHessian;
+    assert(grad_f.size() == n);
+
+    const Eigen::Matrix<double, n, 1> grad_f_fixed = grad_f;
+
+    const bool gauss_newton =
+        compute_hess && projection == GAUSS_NEWTON_PROJECTION;
+
+    LocalGradient local_grad = LocalGradient::Zero();
+    if (compute_grad || gauss_newton) {
+        for (int i = 0; i < vertex_ids.size(); i++) {
+            local_grad.segment<rb_ndof>(rb_ndof * local_body_ids[i]) +=
+                jac_V.middleRows<Dim>(vertex_ids[i] * Dim).transpose()
+                * grad_f_fixed.segment<Dim>(i * Dim);
+        }
+    }
+
+    if (compute_grad) {
+        local_gradient_to_global_triplets(
+            local_grad, body_ids, rb_ndof, grad_triplets);
+    }
+
+    if (gauss_newton) {
+        const LocalHessian hess = rank_one_psd_curvature(grad_f, hess_f)
+            * local_grad * local_grad.transpose();
+        local_hessian_to_global_triplets(
+            hess, body_ids, rb_ndof, hess_triplets);
+    } else if (compute_hess) {
+        // jac_Vi ∈ R^{4n × 2m}
+        Eigen::Matrix<double, n, 2 * rb_ndof> jac_Vi;
+        jac_Vi.setZero();
+        for (int i = 0; i < vertex_ids.size(); i++) {
+            jac_Vi.block<Dim, rb_ndof>(i * Dim, local_body_ids[i] * rb_ndof) =
+                jac_V.middleRows<Dim>(vertex_ids[i] * Dim);
+        }
+
+        // hess ∈ R^{2m × 2m}
+        const Eigen::Matrix<double, n, n> hess_f_fixed = hess_f;
+        LocalHessian hess = jac_Vi.transpose() * hess_f_fixed * jac_Vi;
+        for (int i = 0; i < vertex_ids.size(); i++) {
+            for (int j = 0; j < Dim; j++) {
+                hess.block<rb_ndof, rb_ndof>(
+                    local_body_ids[i] * rb_ndof,
+                    local_body_ids[i] * rb_ndof) +=
+                    hess_V.middleRows<rb_ndof>(
+                        rb_ndof * (vertex_ids[i] * Dim + j))
+                    * grad_f_fixed[i * Dim + j];
+            }
+        }
+
+        hess = project_to_psd(hess);
+
+        local_hessian_to_global_triplets(
+            hess, body_ids, rb_ndof, hess_triplets);
+    }
+}
+
 // Apply the chain rule of f(V(x)) given ∇ᵥf(V) and ∇ₓV(x)
 void apply_chain_rule(
     const VectorMax12d& grad_f,
@@ -1190,10 +1338,11 @@ void apply_chain_rule(
     const std::vector<uint8_t>& local_body_ids,
     const std::array<long, 2>& body_ids,
     const int dim,
-    Eigen::VectorXd& grad,
+    std::vector<Eigen::Triplet<double>>& grad_triplets,
     std::vector<Eigen::Triplet<double>>& hess_triplets,
     bool compute_grad,
-    bool compute_hess)
+    bool compute_hess,
+    BarrierHessianProjection projection = EIGEN_PROJECTION)
 {
     if (!compute_grad && !compute_hess) {
         return;
@@ -1202,11 +1351,24 @@ void apply_chain_rule(
     // PROFILE_POINT("apply_chain_rule");
     // PROFILE_START();
 
+    // Constraints between four vertices use a fixed-size kernel. In 2D
+    // constraints have at most three vertices, so only 3D needs one.
+    if (dim == 3 && grad_f.size() == 12) {
+        apply_chain_rule_fixed_3d(
+            grad_f, jac_V, hess_f, hess_V, vertex_ids, local_body_ids,
+            body_ids, grad_triplets, hess_triplets, compute_grad, compute_hess,
+            projection);
+        return;
+    }
+
     const int rb_ndof = PoseD::dim_to_ndof(dim);
 
-    if (compute_grad) {
+    const bool gauss_newton =
+        compute_hess && projection == GAUSS_NEWTON_PROJECTION;
+
+    VectorMax12d local_grad = VectorMax12d::Zero(2 * rb_ndof);
+    if (compute_grad || gauss_newton) {
         // jac_Vi ∈ R^{4n × 2m}
-        VectorMax12d local_grad = VectorMax12d::Zero(2 * rb_ndof);
         for (int i = 0; i < vertex_ids.size(); i++) {
             if (vertex_ids[i] != -1) {
                 local_grad.segment(rb_ndof * local_body_ids[i], rb_ndof) +=
@@ -1214,11 +1376,21 @@ void apply_chain_rule(
                     * grad_f.segment(i * dim, dim);
             }
         }
+    }
 
-        local_gradient_to_global(local_grad, body_ids, rb_ndof, grad);
+    if (compute_grad) {
+        local_gradient_to_global_triplets(
+            local_grad, body_ids, rb_ndof, grad_triplets);
     }
 
-    if (compute_hess) {
+    if (gauss_newton) {
+        // κ (∇ₓV ∇ᵥf)(∇ₓV ∇ᵥf)ᵀ drops the curvature of V(x) and of f
+        // orthogonal to its gradient, so it is PSD without an eigensolve.
+        const MatrixMax12d hess = rank_one_psd_curvature(grad_f, hess_f)
+            * local_grad * local_grad.transpose();
+        local_hessian_to_global_triplets(
+            hess, body_ids, rb_ndof, hess_triplets);
+    } else if (compute_hess) {
         // jac_Vi ∈ R^{4n × 2m}
         MatrixMax12d jac_Vi =
             MatrixMax12d::Zero(vertex_ids.size() * dim, 2 * rb_ndof);
@@ -1251,18 +1423,70 @@ void apply_chain_rule(
     // PROFILE_END();
 }
 
+// Constraints per block of derivative storage. In deterministic mode the
+// blocks (and so the order of the floating-point sums) do not depend on the
+// number of threads.
+static const size_t POTENTIAL_BLOCK_SIZE = 128;
+
+// Only the entries touched by a block's constraints are stored, so the
+// memory scales with the active constraints instead of blocks × DoF.
 struct PotentialStorage {
-    PotentialStorage() { }
-    PotentialStorage(size_t nvars) { gradient.setZero(nvars); }
     double potential = 0;
-    Eigen::VectorXd gradient;
+    std::vector<Eigen::Triplet<double>> gradient_triplets;
     std::vector<Eigen::Triplet<double>> hessian_triplets;
 };
-typedef tbb::enumerable_thread_specific<PotentialStorage>
-    ThreadSpecificPotentials;
+typedef std::vector<PotentialStorage> BlockPotentials;
+
+inline size_t num_potential_blocks(size_t num_constraints)
+{
+    return (num_constraints + POTENTIAL_BLOCK_SIZE - 1) / POTENTIAL_BLOCK_SIZE;
+}
+
+/// @brief Accumulate the potentials of the constraints [0, num_constraints).
+///
+/// In deterministic mode every fixed block of constraints has its own storage.
+/// Otherwise, every thread accumulates into its own storage, which needs fewer
+/// buffers, but the sums then depend on the scheduling.
+template <typename Accumulate>
+BlockPotentials accumulate_potentials(
+    size_t num_constraints, bool deterministic, const Accumulate& accumulate)
+{
+    if (!deterministic) {
+        tbb::enumerable_thread_specific<PotentialStorage> storages;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(size_t(0), num_constraints),
+            [&](const tbb::blocked_range<size_t>& range) {
+                accumulate(range.begin(), range.end(), storages.local());
+            });
+        return BlockPotentials(
+            std::make_move_iterator(storages.begin()),
+            std::make_move_iterator(storages.end()));
+    }
+
+    BlockPotentials blocks(num_potential_blocks(num_constraints));
+    tbb::parallel_for(size_t(0), blocks.size(), [&](size_t bi) {
+        const size_t begin = bi * POTENTIAL_BLOCK_SIZE;
+        accumulate(
+            begin, std::min(begin + POTENTIAL_BLOCK_SIZE, num_constraints),
+            blocks[bi]);
+    });
+    return blocks;
+}
+
+/// @brief Sum the potentials of the blocks [begin, end) pairwise.
+double sum_block_potentials(
+    const BlockPotentials& potentials, size_t begin, size_t end)
+{
+    if (end - begin == 1) {
+        return potentials[begin].potential;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    return sum_block_potentials(potentials, begin, mid)
+        + sum_block_potentials(potentials, mid, end);
+}
 
 double merge_derivative_storage(
-    const ThreadSpecificPotentials& potentials,
+    const BlockPotentials& potentials,
     size_t nvars,
     Eigen::VectorXd& grad,
     Eigen::SparseMatrix<double>& hess,
@@ -1279,20 +1503,33 @@ double merge_derivative_storage(
         hess.resize(nvars, nvars);
     }
 
-    double potential = 0;
-    for (const auto& p : potentials) {
-        potential += p.potential;
+    // The blocks are merged in order, so the sums only depend on the blocks
+    double potential = potentials.empty()
+        ? 0
+        : sum_block_potentials(potentials, 0, potentials.size());
 
+    size_t num_hessian_triplets = 0;
+    for (const auto& p : potentials) {
         if (compute_grad) {
-            grad += p.gradient;
+            for (const auto& triplet : p.gradient_triplets) {
+                grad[triplet.row()] += triplet.value();
+            }
         }
 
-        if (compute_hess) {
-            Eigen::SparseMatrix<double> p_hess(nvars, nvars);
-            p_hess.setFromTriplets(
-                p.hessian_triplets.begin(), p.hessian_triplets.end());
-            hess += p_hess;
+        num_hessian_triplets += p.hessian_triplets.size();
+    }
+
+    if (compute_hess) {
+        // Assemble all blocks' triplets at once instead of building and
+        // adding a sparse matrix per block.
+        std::vector<Eigen::Triplet<double>> hessian_triplets;
+        hessian_triplets.reserve(num_hessian_triplets);
+        for (const auto& p : potentials) {
+            hessian_triplets.insert(
+                hessian_triplets.end(), p.hessian_triplets.begin(),
+                p.hessian_triplets.end());
         }
+        hess.setFromTriplets(hessian_triplets.begin(), hessian_triplets.end());
     }
 
     PROFILE_END();
@@ -1337,17 +1574,14 @@ double DistanceBarrierRBProblem::compute_barrier_term(
 
     double dhat = barrier_activation_distance();
 
-    ThreadSpecificPotentials thread_storage(x.size());
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(size_t(0), constraints.size()),
-        [&](const tbb::blocked_range<size_t>& range) {
-            // Get references to the local derivative storage
-            auto& local_storage = thread_storage.local();
-            auto& potential = local_storage.potential;
-            auto& local_grad = local_storage.gradient;
-            auto& hess_triplets = local_storage.hessian_triplets;
-
-            for (size_t ci = range.begin(); ci != range.end(); ++ci) {
+    BlockPotentials block_storage = accumulate_potentials(
+        constraints.size(), m_constraint.deterministic,
+        [&](size_t begin, size_t end, PotentialStorage& storage) {
+            // Get references to the derivative storage
+            auto& potential = storage.potential;
+            auto& grad_triplets = storage.gradient_triplets;
+            auto& hess_triplets = storage.hessian_triplets;
+            for (size_t ci = begin; ci != end; ++ci) {
                 const auto& constraint = constraints[ci];
 
                 // PROFILE_START(COMPUTE_BARRIER_VAL);
@@ -1376,13 +1610,14 @@ double DistanceBarrierRBProblem::compute_barrier_term(
                     grad_B, jac_V, hess_B, hess_V,
                     constraint.vertex_ids(edges(), faces()),
                     vertex_local_body_ids(constraints, ci),
-                    body_ids(m_assembler, constraints, ci), dim(), local_grad,
-                    hess_triplets, compute_grad, compute_hess);
+                    body_ids(m_assembler, constraints, ci), dim(),
+                    grad_triplets, hess_triplets, compute_grad, compute_hess,
+                    barrier_hessian_projection);
             }
         });
 
     double potential = merge_derivative_storage(
-        thread_storage, x.size(), grad, hess, compute_grad, compute_hess);
+        block_storage, x.size(), grad, hess, compute_grad, compute_hess);
 
     PROFILE_END();
 
@@ -1417,7 +1652,7 @@ double DistanceBarrierRBProblem::compute_friction_potential(
     const Eigen::MatrixXd& jac_V,
     const Eigen::MatrixXd& hess_V,
     const FrictionConstraint& constraint,
-    Eigen::VectorXd& grad,
+    std::vector<Eigen::Triplet<double>>& grad_triplets,
     std::vector<Eigen::Triplet<double>>& hess_triplets,
     bool compute_grad,
     bool compute_hess)
@@ -1464,7 +1699,7 @@ double DistanceBarrierRBProblem::compute_friction_potential(
     apply_chain_rule(
         grad_D, jac_V, hess_D, hess_V, constraint.vertex_ids(edges(), faces()),
         rbc.vertex_local_body_ids(), rbc.body_ids(), dim(), //
-        grad, hess_triplets, compute_grad, compute_hess);
+        grad_triplets, hess_triplets, compute_grad, compute_hess);
 
     return Dx;
 }
@@ -1497,20 +1732,17 @@ double DistanceBarrierRBProblem::compute_friction_term(
         DISPLACEMENT);
     PROFILE_START(DISPLACEMENT);
     // absolute linear dislacement of each point
-    Eigen::MatrixXd U = V1 - m_assembler.world_vertices(poses_t0);
+    Eigen::MatrixXd U = V1 - m_assembler.world_vertices_buffered(poses_t0);
     PROFILE_END(DISPLACEMENT);
 
-    ThreadSpecificPotentials thread_storage(x.size());
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(size_t(0), friction_constraints.size()),
-        [&](const tbb::blocked_range<size_t>& range) {
-            // Get references to the local derivative storage
-            auto& local_storage = thread_storage.local();
-            auto& potential = local_storage.potential;
-            auto& local_grad = local_storage.gradient;
-            auto& hess_triplets = local_storage.hessian_triplets;
-
-            for (size_t ci = range.begin(); ci != range.end(); ++ci) {
+    BlockPotentials block_storage = accumulate_potentials(
+        friction_constraints.size(), m_constraint.deterministic,
+        [&](size_t begin, size_t end, PotentialStorage& storage) {
+            // Get references to the derivative storage
+            auto& potential = storage.potential;
+            auto& grad_triplets = storage.gradient_triplets;
+            auto& hess_triplets = storage.hessian_triplets;
+            for (size_t ci = begin; ci != end; ++ci) {
                 size_t local_ci = ci;
 
                 if (local_ci < friction_constraints.vv_constraints.size()) {
@@ -1518,7 +1750,8 @@ double DistanceBarrierRBProblem::compute_friction_term(
                         RigidBodyVertexVertexConstraint>(
                         U, jac_V, hess_V,
                         friction_constraints.vv_constraints[local_ci],
-                        local_grad, hess_triplets, compute_grad, compute_hess);
+                        grad_triplets, hess_triplets, compute_grad,
+                        compute_hess);
                     continue;
                 }
 
@@ -1528,18 +1761,19 @@ double DistanceBarrierRBProblem::compute_friction_term(
                         RigidBodyEdgeVertexConstraint>(
                         U, jac_V, hess_V,
                         friction_constraints.ev_constraints[local_ci],
-                        local_grad, hess_triplets, compute_grad, compute_hess);
+                        grad_triplets, hess_triplets, compute_grad,
+                        compute_hess);
                     continue;
                 }
 
                 local_ci -= friction_constraints.ev_constraints.size();
                 if (local_ci < friction_constraints.ee_constraints.size()) {
-                    potential +=
-                        compute_friction_potential<RigidBodyEdgeEdgeConstraint>(
-                            U, jac_V, hess_V,
-                            friction_constraints.ee_constraints[local_ci],
-                            local_grad, hess_triplets, compute_grad,
-                            compute_hess);
+                    potential += compute_friction_potential<
+                        RigidBodyEdgeEdgeConstraint>(
+                        U, jac_V, hess_V,
+                        friction_constraints.ee_constraints[local_ci],
+                        grad_triplets, hess_triplets, compute_grad,
+                        compute_hess);
                     continue;
                 }
 
@@ -1549,12 +1783,13 @@ double DistanceBarrierRBProblem::compute_friction_term(
                     compute_friction_potential<RigidBodyFaceVertexConstraint>(
                         U, jac_V, hess_V,
                         friction_constraints.fv_constraints[local_ci],
-                        local_grad, hess_triplets, compute_grad, compute_hess);
+                        grad_triplets, hess_triplets, compute_grad,
+                        compute_hess);
             }
         });
 
     double potential = merge_derivative_storage(
-        thread_storage, x.size(), grad, hess, compute_grad, compute_hess);
+        block_storage, x.size(), grad, hess, compute_grad, compute_hess);
 
     PROFILE_END();
 
@@ -32,6 +32,19 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
       { STABILIZED_NEWMARK, "stabilized_newmark" },
       { DEFAULT_BODY_ENERGY_INTEGRATION_METHOD, "default" } });
 
+/// @brief Methods for making the barrier hessian positive semi-definite.
+enum BarrierHessianProjection {
+    /// Clamp the eigenvalues of each constraint's body-space hessian.
+    EIGEN_PROJECTION,
+    /// Rank-one approximation along each constraint's gradient.
+    GAUSS_NEWTON_PROJECTION
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(
+    BarrierHessianProjection,
+    { { EIGEN_PROJECTION, "eigen" },
+      { GAUSS_NEWTON_PROJECTION, "gauss_newton" } });
+
 /// This class is both a simulation and optimization problem.
 class DistanceBarrierRBProblem : public RigidBodyProblem,
                                  public virtual BarrierProblem {
@@ -96,7 +109,7 @@ public:
     /// Get the world coordinates of the vertices
     Eigen::MatrixXd world_vertices(const Eigen::VectorXd& x) const override
     {
-        return m_assembler.world_vertices(this->dofs_to_poses(x));
+        return m_assembler.world_vertices_buffered(this->dofs_to_poses(x));
     }
 
     /// Get the length of the diagonal of the worlds bounding box
@@ -200,6 +213,11 @@ public:
         m_barrier_stiffness = kappa;
     }
 
+    int num_active_barriers_t0() const override
+    {
+        return m_num_active_barriers_t0;
+    }
+
     CollisionConstraint& constraint() override { return m_constraint; }
     const CollisionConstraint& constraint() const override
     {
@@ -243,6 +261,12 @@ protected:
     /// Update problem using current status of bodies.
     virtual void update_constraints() override;
 
+    bool reorder_bodies() override;
+
+    /// Compute a starting point for the solver by extrapolating the previous
+    /// step and filtering it with CCD.
+    Eigen::VectorXd compute_warm_start();
+
     /// Update problem using current status of bodies.
     void update_friction_constraints(
         const CollisionConstraints& collision_constraints, const PosesD& poses);
@@ -259,7 +283,7 @@ protected:
         const Eigen::MatrixXd& jac_V,
         const Eigen::MatrixXd& hess_V,
         const FrictionConstraint& constraint,
-        Eigen::VectorXd& grad,
+        std::vector<Eigen::Triplet<double>>& grad_triplets,
         std::vector<Eigen::Triplet<double>>& hess_triplets,
         bool compute_grad,
         bool compute_hess);
@@ -350,6 +374,13 @@ protected:
 
     /// @brief Gradient of barrier potential at the start of the time-step.
     Eigen::VectorXd grad_barrier_t0;
+    /// @brief Number of active barriers at the start of the time-step.
+    int m_num_active_barriers_t0;
+
+    /// @brief Start the solve from the extrapolated poses instead of x0.
+    bool warm_start;
+    /// @brief How to make the barrier hessian positive semi-definite.
+    BarrierHessianProjection barrier_hessian_projection;
 
     // Friction
     double static_friction_speed_bound;
@@ -363,6 +394,10 @@ protected:
     Eigen::MatrixXd angular_augmented_lagrangian_multiplier;
     Eigen::VectorXd x_pred; ///< Predicted DoF using unconstrained timestep
     VectorXb is_dof_satisfied;
+    /// Indices of the kinematic bodies (in the order of the multipliers)
+    std::vector<size_t> kinematic_bodies;
+    /// Predicted rotation matrices of the kinematic bodies (3D only)
+    std::vector<Eigen::Matrix3d> kinematic_Q_pred;
 
 private:
     /// Method for integrating the body energy.
@@ -40,6 +40,8 @@ nlohmann::json SplitDistanceBarrierRBProblem::settings() const
 void SplitDistanceBarrierRBProblem::simulation_step(
     bool& had_collision, bool& _has_intersections, bool solve_collision)
 {
+    update_body_order();
+
     // Take an unconstrained time-step
     m_time_stepper->step(m_assembler, gravity, timestep());
 
@@ -168,7 +170,8 @@ void SplitDistanceBarrierRBProblem::solve_velocities()
 
         case TrajectoryType::PIECEWISE_LINEAR:
         case TrajectoryType::RIGID:
-        case TrajectoryType::REDON: {
+        case TrajectoryType::REDON:
+        case TrajectoryType::CONSERVATIVE_ADVANCEMENT: {
             // Use nonlinear trajectory
             long edge_body_id = m_assembler.edge_id_to_body_id(edge_id);
 
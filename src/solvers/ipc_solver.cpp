@@ -20,7 +20,10 @@ void IPCSolver::settings(const nlohmann::json& json)
     dhat_epsilon = json["dhat_epsilon"].get<double>();
     min_barrier_stiffness_scale =
         json["min_barrier_stiffness_scale"].get<double>();
+    reuse_barrier_stiffness = json["reuse_barrier_stiffness"].get<bool>();
+    prev_num_active_barriers = -1;
     num_kappa_updates = 0;
+    num_kappa_reuses = 0;
 }
 
 // Export the state of the solver using the settings saved in JSON
@@ -29,6 +32,7 @@ nlohmann::json IPCSolver::settings() const
     nlohmann::json json = NewtonSolver::settings();
     json["dhat_epsilon"] = dhat_epsilon;
     json["min_barrier_stiffness_scale"] = min_barrier_stiffness_scale;
+    json["reuse_barrier_stiffness"] = reuse_barrier_stiffness;
     return json;
 }
 
@@ -39,6 +43,25 @@ void IPCSolver::init_solve(const Eigen::VectorXd& x0)
 
     NewtonSolver::init_solve(x0);
 
+    if (reuse_barrier_stiffness && prev_num_active_barriers >= 0) {
+        // The problem already knows its active barriers at the start of the
+        // step, so the contact set can be compared without a barrier pass.
+        int num_active_barriers =
+            barrier_problem_ptr()->num_active_barriers_t0();
+        if (num_active_barriers >= 0
+            && abs(num_active_barriers - prev_num_active_barriers)
+                <= 0.1 * std::max(prev_num_active_barriers, 1)) {
+            // Keep κ, κ_max, and the previous minimum distance
+            spdlog::info(
+                "solver={} num_active_barriers={:d} msg=\"reusing κ={:g}\"",
+                name(), num_active_barriers,
+                barrier_problem_ptr()->barrier_stiffness());
+            prev_num_active_barriers = num_active_barriers;
+            num_kappa_reuses++;
+            return;
+        }
+    }
+
     double bbox_diagonal = problem_ptr->world_bbox_diagonal();
     double dhat = barrier_problem_ptr()->barrier_activation_distance();
     double average_mass = problem_ptr->average_mass();
@@ -62,6 +85,8 @@ void IPCSolver::init_solve(const Eigen::VectorXd& x0)
 
     // Compute the initial minimum distance
     prev_min_distance = problem_ptr->compute_min_distance(x0);
+
+    prev_num_active_barriers = barrier_problem_ptr()->num_active_barriers_t0();
 }
 
 void IPCSolver::post_step_update()
@@ -101,14 +126,15 @@ OptimizationResults IPCSolver::solve(const Eigen::VectorXd& x0)
 std::string IPCSolver::stats_string() const
 {
     return fmt::format(
-        "num_kappa_updates={:d} {}", num_kappa_updates,
-        NewtonSolver::stats_string());
+        "num_kappa_updates={:d} num_kappa_reuses={:d} {}", num_kappa_updates,
+        num_kappa_reuses, NewtonSolver::stats_string());
 }
 
 nlohmann::json IPCSolver::stats() const
 {
     nlohmann::json stats_json = NewtonSolver::stats();
     stats_json["num_kappa_updates"] = num_kappa_updates;
+    stats_json["num_kappa_reuses"] = num_kappa_reuses;
     return stats_json;
 }
 
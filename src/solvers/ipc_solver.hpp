@@ -29,6 +29,13 @@ public:
     /// Solve the saved optimization problem to completion
     virtual OptimizationResults solve(const Eigen::VectorXd& x0) override;
 
+    /// Forget κ and the factorization of the previous solve
+    virtual void reset_history() override
+    {
+        prev_num_active_barriers = -1;
+        NewtonSolver::reset_history();
+    }
+
     virtual std::string stats_string() const override;
     virtual nlohmann::json stats() const override;
 
@@ -54,6 +61,10 @@ protected:
     /// @brief Activation distance of adaptive barrier stiffness.
     double dhat_epsilon;
 
+    /// @brief Keep κ and its adaptive history between solves when the number
+    /// of active barriers is similar.
+    bool reuse_barrier_stiffness;
+
     ///////////////////////////////////////////////////////////////////////
     // Computed values
 
@@ -63,8 +74,12 @@ protected:
     /// @brief The minimum distance of the previous iteration.
     double prev_min_distance;
 
+    /// @brief Number of active barriers at the start of the previous solve.
+    int prev_num_active_barriers = -1;
+
 private:
     int num_kappa_updates = 0;
+    int num_kappa_reuses = 0;
 };
 
 } // namespace ipc::rigid
@@ -1,6 +1,9 @@
 // Functions for optimizing functions.
 #include "newton_solver.hpp"
 
+#include <algorithm>
+
+#include <igl/Timer.h>
 #include <igl/slice.h>
 #include <igl/slice_into.h>
 #include <igl/writeOBJ.h>
@@ -22,6 +25,7 @@ NewtonSolver::NewtonSolver()
     , velocity_conv_tol(Constants::DEFAULT_NEWTON_VELOCITY_CONVERGENCE_TOL)
     , is_velocity_conv_tol_abs(false)
     , is_energy_converged(false)
+    , reuse_factorization(false)
 {
     linear_solver = polysolve::LinearSolver::create("", "");
 }
@@ -34,6 +38,7 @@ void NewtonSolver::settings(const nlohmann::json& json)
     velocity_conv_tol = json["velocity_conv_tol"];
     is_velocity_conv_tol_abs = json["is_velocity_conv_tol_abs"];
     m_line_search_lower_bound = json["line_search_lower_bound"];
+    reuse_factorization = json["reuse_factorization"];
 
     linear_solver_settings = json["linear_solver"];
     try {
@@ -46,6 +51,7 @@ void NewtonSolver::settings(const nlohmann::json& json)
             polysolve::LinearSolver::create(linear_solver_settings["name"], "");
     }
     linear_solver->setParameters(linear_solver_settings);
+    has_factorization = false;
 
     reset_stats();
 }
@@ -59,6 +65,7 @@ nlohmann::json NewtonSolver::settings() const
     settings["energy_conv_tol"] = energy_conv_tol;
     settings["velocity_conv_tol"] = velocity_conv_tol;
     settings["is_velocity_conv_tol_abs"] = is_velocity_conv_tol_abs;
+    settings["reuse_factorization"] = reuse_factorization;
     return settings;
 }
 
@@ -78,7 +85,12 @@ nlohmann::json NewtonSolver::stats() const
              { "count_grad", num_grad_fx },
              { "count_hess", num_hessian_fx },
              { "count_ccd", num_collision_check },
-             { "total_regularizations", regularization_iterations } };
+             { "count_ccd_limited_ls", num_ccd_limited_ls },
+             { "total_regularizations", regularization_iterations },
+             { "count_reused_factorizations", num_reused_factorizations },
+             { "assembly_time", assembly_time },
+             { "factorization_time", factorization_time },
+             { "line_search_time", line_search_time } };
 }
 
 std::string NewtonSolver::stats_string() const
@@ -87,10 +99,12 @@ std::string NewtonSolver::stats_string() const
         "total_newton_steps={:d} total_ls_steps={:d} "
         "num_newton_ls_fails={:d} num_grad_ls_fails={:d} count_fx={:d} "
         "count_grad={:d} count_hess={:d} count_ccd={:d} "
-        "total_regularizations={:d}",
+        "count_ccd_limited_ls={:d} total_regularizations={:d} "
+        "count_reused_factorizations={:d}",
         newton_iterations, ls_iterations, num_newton_ls_fails,
         num_grad_ls_fails, num_fx, num_grad_fx, num_hessian_fx,
-        num_collision_check, regularization_iterations);
+        num_collision_check, num_ccd_limited_ls, regularization_iterations,
+        num_reused_factorizations);
 }
 
 void NewtonSolver::reset_stats()
@@ -99,11 +113,16 @@ void NewtonSolver::reset_stats()
     num_grad_fx = 0;
     num_hessian_fx = 0;
     num_collision_check = 0;
+    num_ccd_limited_ls = 0;
     ls_iterations = 0;
     newton_iterations = 0;
     num_newton_ls_fails = 0;
     num_grad_ls_fails = 0;
     regularization_iterations = 0;
+    num_reused_factorizations = 0;
+    assembly_time = 0;
+    factorization_time = 0;
+    line_search_time = 0;
 }
 
 bool NewtonSolver::converged()
@@ -194,9 +213,12 @@ OptimizationResults NewtonSolver::solve(const Eigen::VectorXd& x0)
     is_energy_converged = false;
     bool success = false;
 
+    igl::Timer timer;
     for (iteration_number = 0; iteration_number < max_iterations;
          iteration_number++) {
+        timer.start();
         double fx = problem_ptr->compute_objective(x, gradient, hessian);
+        assembly_time += timer.getElapsedTime();
 
         num_fx++;
         num_grad_fx++;
@@ -210,13 +232,31 @@ OptimizationResults NewtonSolver::solve(const Eigen::VectorXd& x0)
 #ifdef USE_GRADIENT_DESCENT
         direction_free = -gradient_free;
 #else
-        bool solve_success = compute_regularized_direction(
-            fx, gradient_free, hessian_free, direction_free,
-            regulariztion_coeff);
+        timer.start();
+        bool solve_success = false;
+        // The Hessian changes little between time-steps, so try the last
+        // factorization of the previous solve for the first direction.
+        if (iteration_number == 0 && reuse_factorization && has_factorization
+            && factorized_free_dof.size() == free_dof.size()
+            && factorized_free_dof == free_dof) {
+            solve_success = compute_direction_with_previous_factorization(
+                gradient_free, direction_free);
+            if (solve_success) {
+                num_reused_factorizations++;
+            }
+        }
         if (!solve_success) {
-            exit_reason = "regularization failed";
-            break;
+            solve_success = compute_regularized_direction(
+                fx, gradient_free, hessian_free, direction_free,
+                regulariztion_coeff);
+            if (!solve_success) {
+                factorization_time += timer.getElapsedTime();
+                exit_reason = "regularization failed";
+                break;
+            }
+            factorized_free_dof = free_dof;
         }
+        factorization_time += timer.getElapsedTime();
 #endif
 
         ///////////////////////////////////////////////////////////////////
@@ -232,9 +272,11 @@ OptimizationResults NewtonSolver::solve(const Eigen::VectorXd& x0)
             break;
         }
 
+        timer.start();
         step_length = 1;
         bool found_newton_step =
             line_search(x, direction, fx, grad_direction, step_length);
+        line_search_time += timer.getElapsedTime();
         ///////////////////////////////////////////////////////////////////
 
         ///////////////////////////////////////////////////////////////////
@@ -262,9 +304,11 @@ OptimizationResults NewtonSolver::solve(const Eigen::VectorXd& x0)
             //     success = true;
             //     break;
             // }
+            timer.start();
             step_length = 1;
             bool found_gradient_step =
                 line_search(x, direction, fx, grad_direction, step_length);
+            line_search_time += timer.getElapsedTime();
             ///////////////////////////////////////////////////////////////
 
             // When gradient direction fails, exit
@@ -340,6 +384,9 @@ bool NewtonSolver::line_search(
         max_step_size =
             std::min(problem_ptr->compute_earliest_toi(x, x + dir), 1.0);
         step_length = std::min(step_length, max_step_size);
+        if (max_step_size < 1) {
+            num_ccd_limited_ls++;
+        }
     }
     // #ifndef NDEBUG
     // while (problem_ptr->has_collisions(x, x + step_length * dir)) {
@@ -424,6 +471,37 @@ bool NewtonSolver::line_search(
     return success;
 }
 
+/// Check if two sparse matrices have identical sparsity patterns.
+bool has_same_sparsity_pattern(
+    const Eigen::SparseMatrix<double>& A, const Eigen::SparseMatrix<double>& B)
+{
+    if (A.rows() != B.rows() || A.cols() != B.cols()
+        || A.nonZeros() != B.nonZeros() || !A.isCompressed()
+        || !B.isCompressed()) {
+        return false;
+    }
+    return std::equal(
+               A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1,
+               B.outerIndexPtr())
+        && std::equal(
+               A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros(),
+               B.innerIndexPtr());
+}
+
+bool NewtonSolver::compute_direction_with_previous_factorization(
+    const Eigen::VectorXd& gradient, Eigen::VectorXd& direction)
+{
+    PROFILE_POINT("NewtonSolver::compute_direction:linear_solve");
+    PROFILE_START();
+
+    direction = Eigen::VectorXd::Zero(gradient.size());
+    linear_solver->solve(-gradient, direction);
+
+    PROFILE_END();
+
+    return direction.allFinite() && gradient.dot(direction) < 0;
+}
+
 double norm_Linf(const Eigen::SparseMatrix<double>& M)
 {
     double norm = 0;
@@ -517,7 +595,11 @@ bool NewtonSolver::compute_direction(
     //     direction = dense_hessian.ldlt().solve(-gradient);
     //     solve_success = true;
     // } else {
-    linear_solver->analyzePattern(hessian, hessian.rows());
+    // The symbolic analysis only depends on the sparsity pattern
+    if (!reuse_factorization || !has_factorization
+        || !has_same_sparsity_pattern(hessian, factorized_hessian)) {
+        linear_solver->analyzePattern(hessian, hessian.rows());
+    }
     linear_solver->factorize(hessian);
     nlohmann::json info;
     linear_solver->getInfo(info);
@@ -544,6 +626,11 @@ bool NewtonSolver::compute_direction(
     }
     // }
 
+    if (reuse_factorization) {
+        has_factorization = solve_success;
+        factorized_hessian = hessian;
+    }
+
     PROFILE_END();
 
     // Check solve residual
@@ -81,6 +81,12 @@ public:
         Eigen::VectorXd& delta_x,
         bool make_psd = false);
 
+    /// @brief Solve for the Newton direction using the last factorization.
+    ///
+    /// @returns True if the direction is a finite descent direction.
+    virtual bool compute_direction_with_previous_factorization(
+        const Eigen::VectorXd& gradient, Eigen::VectorXd& delta_x);
+
     virtual bool compute_regularized_direction(
         double& fx,
         Eigen::VectorXd& gradient,
@@ -91,6 +97,9 @@ public:
     virtual std::string stats_string() const override;
     virtual nlohmann::json stats() const override;
 
+    /// Discard the factorization kept for the next solve.
+    virtual void clear_factorization() override { has_factorization = false; }
+
     int max_iterations;
 
 protected:
@@ -134,6 +143,12 @@ protected:
     std::unique_ptr<polysolve::LinearSolver> linear_solver;
     nlohmann::json linear_solver_settings;
 
+    /// @brief Reuse the previous factorization (first direction and pattern)
+    bool reuse_factorization;
+    bool has_factorization = false;
+    Eigen::SparseMatrix<double> factorized_hessian; ///< Last factorized
+    Eigen::VectorXi factorized_free_dof; ///< Free DoF of the factorization
+
 private:
     void reset_stats();
 
@@ -141,11 +156,16 @@ private:
     size_t num_grad_fx = 0;
     size_t num_hessian_fx = 0;
     size_t num_collision_check = 0;
+    size_t num_ccd_limited_ls = 0; ///< Line searches with a CCD step bound
     size_t ls_iterations = 0;
     size_t newton_iterations = 0;
     size_t num_newton_ls_fails = 0;
     size_t num_grad_ls_fails = 0;
     size_t regularization_iterations = 0;
+    size_t num_reused_factorizations = 0;
+    double assembly_time = 0;      ///< Seconds computing f, ∇f, and ∇²f
+    double factorization_time = 0; ///< Seconds solving for the direction
+    double line_search_time = 0;   ///< Seconds in line searches (with CCD)
 };
 
 /**
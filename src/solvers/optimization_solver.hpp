@@ -48,6 +48,25 @@ public:
         throw NotImplementedError(
             fmt::format("{} does not have and inner_solver", name()));
     }
+
+    /// Discard any factorization kept between solves (e.g., because the
+    /// variables were reordered).
+    virtual void clear_factorization()
+    {
+        if (has_inner_solver()) {
+            inner_solver().clear_factorization();
+        }
+    }
+
+    /// Forget the state carried over from the previous solve (e.g., the
+    /// factorization and barrier stiffness) so the next solve starts fresh.
+    virtual void reset_history()
+    {
+        clear_factorization();
+        if (has_inner_solver()) {
+            inner_solver().reset_history();
+        }
+    }
 };
 
 } // namespace ipc::rigid
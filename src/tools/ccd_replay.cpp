@@ -0,0 +1,209 @@
+// Replay a binary CCD query log against the CCD backends.
+
+#include <CLI/CLI.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <numeric>
+
+#include <igl/Timer.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <ccd/query_log.hpp>
+#include <logger.hpp>
+
+using namespace ipc;
+using namespace ipc::rigid;
+
+struct ReplayResults {
+    std::vector<char> is_impacting;
+    std::vector<double> tois;
+    std::vector<double> seconds;
+    double wall_seconds;
+};
+
+ReplayResults replay(
+    const std::vector<CCDQuery>& queries,
+    const std::vector<std::array<RigidBody, 2>>& bodies,
+    TrajectoryType trajectory)
+{
+    ReplayResults results;
+    results.is_impacting.resize(queries.size());
+    results.tois.resize(queries.size());
+    results.seconds.resize(queries.size());
+
+    igl::Timer wall_timer;
+    wall_timer.start();
+    tbb::parallel_for(size_t(0), queries.size(), [&](size_t i) {
+        igl::Timer timer;
+        double toi = std::numeric_limits<double>::infinity();
+        timer.start();
+        bool is_impacting =
+            queries[i].run(bodies[i][0], bodies[i][1], trajectory, toi);
+        timer.stop();
+        results.is_impacting[i] = is_impacting;
+        results.tois[i] =
+            is_impacting ? toi : std::numeric_limits<double>::infinity();
+        results.seconds[i] = timer.getElapsedTimeInSec();
+    });
+    wall_timer.stop();
+    results.wall_seconds = wall_timer.getElapsedTimeInSec();
+    return results;
+}
+
+/// @brief Value at the given quantile of sorted values.
+double quantile(const std::vector<double>& sorted_values, double q)
+{
+    if (sorted_values.empty()) {
+        return 0;
+    }
+    return sorted_values[size_t(q * (sorted_values.size() - 1))];
+}
+
+int main(int argc, char* argv[])
+{
+    set_logger_level(spdlog::level::warn);
+
+    CLI::App app("replay a CCD query log against the CCD backends");
+
+    std::string log_path;
+    app.add_option("log_path,-i,--log", log_path, "binary CCD query log")
+        ->required();
+
+    std::vector<TrajectoryType> trajectories = {
+        { LINEAR, PIECEWISE_LINEAR, RIGID, REDON, CONSERVATIVE_ADVANCEMENT }
+    };
+    app.add_option(
+           "-t,--trajectories", trajectories, "CCD backends to replay with")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, TrajectoryType>(
+                { { "linear", LINEAR },
+                  { "piecewise_linear", PIECEWISE_LINEAR },
+                  { "rigid", RIGID },
+                  { "redon", REDON },
+                  { "conservative_advancement",
+                    CONSERVATIVE_ADVANCEMENT } }),
+            CLI::ignore_case));
+
+    std::string csv_path = "";
+    app.add_option(
+        "-o,--csv", csv_path, "CSV file for the per-query times and results");
+
+    int nthreads = tbb::this_task_arena::max_concurrency();
+    app.add_option("--nthreads", nthreads, "maximum number of threads to use")
+        ->default_val(nthreads);
+
+    CLI11_PARSE(app, argc, argv);
+
+    if (nthreads <= 0) {
+        nthreads = tbb::this_task_arena::max_concurrency();
+    }
+    tbb::global_control thread_limiter(
+        tbb::global_control::max_allowed_parallelism, nthreads);
+
+    std::vector<CCDQuery> queries;
+    if (!CCDQueryLog::read(log_path, queries)) {
+        return 1;
+    }
+    fmt::print("Replaying {:d} queries from {}\n", queries.size(), log_path);
+    if (queries.empty()) {
+        return 0;
+    }
+
+    // Rebuild the bodies up front, so only the CCD itself is timed
+    std::vector<std::array<RigidBody, 2>> bodies;
+    bodies.reserve(queries.size());
+    for (const CCDQuery& query : queries) {
+        bodies.push_back({ { query.body(0), query.body(1) } });
+    }
+
+    std::vector<ReplayResults> results;
+    for (const TrajectoryType trajectory : trajectories) {
+        results.push_back(replay(queries, bodies, trajectory));
+    }
+
+    fmt::print(
+        "{:>26s} {:>12s} {:>10s} {:>10s} {:>10s} {:>10s} {:>10s} {:>8s} "
+        "{:>8s}\n",
+        "backend", "queries/s", "mean(us)", "p50(us)", "p90(us)", "p99(us)",
+        "max(us)", "missed", "extra");
+    for (size_t ti = 0; ti < trajectories.size(); ti++) {
+        const ReplayResults& r = results[ti];
+        std::vector<double> sorted_seconds = r.seconds;
+        std::sort(sorted_seconds.begin(), sorted_seconds.end());
+        double mean = std::accumulate(
+                          sorted_seconds.begin(), sorted_seconds.end(), 0.0)
+            / sorted_seconds.size();
+
+        // Disagreements with the result recorded during the simulation
+        int num_missed = 0, num_extra = 0;
+        for (size_t i = 0; i < queries.size(); i++) {
+            num_missed += queries[i].is_impacting && !r.is_impacting[i];
+            num_extra += !queries[i].is_impacting && r.is_impacting[i];
+        }
+
+        fmt::print(
+            "{:>26s} {:>12.5g} {:>10.4g} {:>10.4g} {:>10.4g} {:>10.4g} "
+            "{:>10.4g} {:>8d} {:>8d}\n",
+            nlohmann::json(trajectories[ti]).get<std::string>(),
+            queries.size() / r.wall_seconds, 1e6 * mean,
+            1e6 * quantile(sorted_seconds, 0.5),
+            1e6 * quantile(sorted_seconds, 0.9),
+            1e6 * quantile(sorted_seconds, 0.99),
+            1e6 * sorted_seconds.back(), num_missed, num_extra);
+    }
+
+    // Pairwise disagreements between the backends
+    for (size_t ti = 0; ti < trajectories.size(); ti++) {
+        for (size_t tj = ti + 1; tj < trajectories.size(); tj++) {
+            int num_disagreements = 0;
+            double max_toi_difference = 0;
+            for (size_t i = 0; i < queries.size(); i++) {
+                if (results[ti].is_impacting[i]
+                    != results[tj].is_impacting[i]) {
+                    num_disagreements++;
+                } else if (results[ti].is_impacting[i]) {
+                    max_toi_difference = std::max(
+                        max_toi_difference,
+                        std::abs(results[ti].tois[i] - results[tj].tois[i]));
+                }
+            }
+            if (num_disagreements || max_toi_difference > 0) {
+                fmt::print(
+                    "{} vs {}: {:d} disagreements, max toi difference {:g}\n",
+                    nlohmann::json(trajectories[ti]).get<std::string>(),
+                    nlohmann::json(trajectories[tj]).get<std::string>(),
+                    num_disagreements, max_toi_difference);
+            }
+        }
+    }
+
+    if (!csv_path.empty()) {
+        std::ofstream csv(csv_path);
+        csv << "query,type,recorded_trajectory,recorded_impacting,"
+               "recorded_toi,recorded_seconds";
+        for (const TrajectoryType trajectory : trajectories) {
+            std::string name = nlohmann::json(trajectory).get<std::string>();
+            csv << fmt::format(",{0}_impacting,{0}_toi,{0}_seconds", name);
+        }
+        csv << "\n";
+        for (size_t i = 0; i < queries.size(); i++) {
+            csv << fmt::format(
+                "{:d},{:d},{},{:d},{:.17g},{:g}", i, queries[i].type,
+                nlohmann::json(queries[i].trajectory).get<std::string>(),
+                int(queries[i].is_impacting), queries[i].toi,
+                queries[i].seconds);
+            for (const ReplayResults& r : results) {
+                csv << fmt::format(
+                    ",{:d},{:.17g},{:g}", int(r.is_impacting[i]), r.tois[i],
+                    r.seconds[i]);
+            }
+            csv << "\n";
+        }
+    }
+}
@@ -7,6 +7,7 @@
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_sort.h>
 
+#include <io/asset_cache.hpp>
 #include <io/read_obj.hpp>
 #include <io/read_rb_scene.hpp>
 #include <io/serialize_json.hpp>
@@ -169,6 +170,15 @@ public:
         state_sequence = sim["animation"]["state_sequence"]
                              .get<std::vector<nlohmann::json>>();
 
+        // Reuse the preprocessed body meshes of the simulation
+        if (sim["args"].contains("asset_cache")) {
+            const std::string asset_cache_dir =
+                sim["args"]["asset_cache"]["directory"];
+            if (!asset_cache_dir.empty()) {
+                ipc::rigid::asset_cache().open(asset_cache_dir);
+            }
+        }
+
         std::vector<ipc::rigid::RigidBody> rbs;
         ipc::rigid::read_rb_scene(sim["args"]["rigid_body_problem"], rbs);
         bodies.init(rbs);
@@ -8,6 +8,7 @@
 #include <ccd/piecewise_linear/time_of_impact.hpp>
 #include <ccd/redon/time_of_impact.hpp>
 #include <ccd/rigid/time_of_impact.hpp>
+#include <interval/interval_root_finder.hpp>
 #include <io/serialize_json.hpp>
 
 using namespace ipc;
@@ -50,6 +51,8 @@ int main(int argc, char* argv[])
     fv_csv << "redon,rigid,pl\n";
     std::ofstream ee_csv("ee.csv");
     ee_csv << "redon,rigid,pl\n";
+    std::ofstream boxes_csv("boxes.csv");
+    boxes_csv << "type,naive,mean_value\n";
 
     std::array<TrajectoryType, 3> traj_types = { { REDON, RIGID,
                                                    PIECEWISE_LINEAR } };
@@ -214,6 +217,30 @@ int main(int argc, char* argv[])
                 timings[i] = timer.getElapsedTimeInMicroSec();
             }
 
+            // Number of boxes the rigid CCD visits with each enclosure
+            std::array<TrajectoryEnclosure, 2> enclosures = { {
+                NAIVE_ENCLOSURE, MEAN_VALUE_ENCLOSURE } };
+            std::array<size_t, 2> num_boxes;
+            for (int i = 0; i < enclosures.size(); i++) {
+                reset_interval_root_finder_num_boxes();
+                if (ccd_type == "ee") {
+                    compute_edge_edge_time_of_impact(
+                        bodyA, bodyA_pose_t0, bodyA_pose_t1, /*edgeA_id=*/0,
+                        bodyB, bodyB_pose_t0, bodyB_pose_t1, /*edgeB_id=*/0,
+                        toi, /*double earliest_toi=*/1, RIGID_TOL,
+                        enclosures[i]);
+                } else if (ccd_type == "fv") {
+                    compute_face_vertex_time_of_impact(
+                        bodyB, bodyB_pose_t0, bodyB_pose_t1, /*vertex_id=*/0,
+                        bodyA, bodyA_pose_t0, bodyA_pose_t1, /*face_id=*/0,
+                        toi, /*double earliest_toi=*/1, RIGID_TOL,
+                        enclosures[i]);
+                }
+                num_boxes[i] = interval_root_finder_num_boxes();
+            }
+            boxes_csv << fmt::format(
+                "{},{:d},{:d}\n", ccd_type, num_boxes[0], num_boxes[1]);
+
             std::string line = fmt::format(
                 "{:g},{:g},{:g}\n", timings[0], timings[1], timings[2]);
             if (ccd_type == "ee") {
@@ -225,5 +252,6 @@ int main(int argc, char* argv[])
 
         fv_csv.flush();
         ee_csv.flush();
+        boxes_csv.flush();
     }
 }
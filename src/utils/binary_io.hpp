@@ -0,0 +1,102 @@
+// Helpers for simple native-endian binary files.
+#pragma once
+
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace ipc::rigid {
+
+template <typename T> void write_binary(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// @brief Write the size and the contents of a vector of plain values.
+template <typename T>
+void write_binary(std::ostream& out, const std::vector<T>& values)
+{
+    write_binary(out, uint64_t(values.size()));
+    out.write(
+        reinterpret_cast<const char*>(values.data()),
+        sizeof(T) * values.size());
+}
+
+/// @brief Write the shape and the (column-major) coefficients of a matrix.
+template <typename Scalar, int R, int C, int O, int MR, int MC>
+void write_binary(
+    std::ostream& out, const Eigen::Matrix<Scalar, R, C, O, MR, MC>& matrix)
+{
+    static_assert(!(O & Eigen::RowMajor) || R == 1 || C == 1);
+    write_binary(out, int64_t(matrix.rows()));
+    write_binary(out, int64_t(matrix.cols()));
+    out.write(
+        reinterpret_cast<const char*>(matrix.data()),
+        sizeof(Scalar) * matrix.size());
+}
+
+/// @brief Cursor over a binary buffer (e.g. a MappedFile) that reads what
+/// write_binary() wrote.
+///
+/// Reading past the end of the buffer fails and leaves the reader bad.
+class BinaryReader {
+public:
+    BinaryReader(const char* begin, const char* end)
+        : m_pos(begin)
+        , m_end(end)
+    {
+    }
+
+    bool good() const { return m_good; }
+    size_t remaining() const { return m_end - m_pos; }
+
+    bool read(void* data, size_t size)
+    {
+        if (!m_good || size > remaining()) {
+            return m_good = false;
+        }
+        std::memcpy(data, m_pos, size);
+        m_pos += size;
+        return true;
+    }
+
+    template <typename T> bool read(T& value)
+    {
+        return read(&value, sizeof(T));
+    }
+
+    template <typename T> bool read(std::vector<T>& values)
+    {
+        uint64_t size;
+        if (!read(size) || size > remaining() / sizeof(T)) {
+            return m_good = false;
+        }
+        values.resize(size);
+        return read(values.data(), sizeof(T) * size);
+    }
+
+    template <typename Scalar, int R, int C, int O, int MR, int MC>
+    bool read(Eigen::Matrix<Scalar, R, C, O, MR, MC>& matrix)
+    {
+        int64_t rows, cols;
+        if (!read(rows) || !read(cols) || rows < 0 || cols < 0
+            || (R != Eigen::Dynamic && rows != R)
+            || (C != Eigen::Dynamic && cols != C)
+            || (MR != Eigen::Dynamic && rows > MR)
+            || (MC != Eigen::Dynamic && cols > MC)
+            || (rows && uint64_t(cols) > remaining() / sizeof(Scalar) / rows)) {
+            return m_good = false;
+        }
+        matrix.resize(rows, cols);
+        return read(matrix.data(), sizeof(Scalar) * matrix.size());
+    }
+
+protected:
+    const char* m_pos;
+    const char* m_end;
+    bool m_good = true;
+};
+
+} // namespace ipc::rigid
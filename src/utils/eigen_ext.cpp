@@ -1,5 +1,17 @@
 #include "eigen_ext.hpp"
 
+#include <algorithm>
+
 namespace ipc {
 
+double rank_one_psd_curvature(const VectorMax12d& g, const MatrixMax12d& H)
+{
+    assert(H.rows() == g.size() && H.cols() == g.size());
+    const double g_sqr_norm = g.squaredNorm();
+    if (g_sqr_norm == 0) {
+        return 0;
+    }
+    return std::max(g.dot(H * g) / (g_sqr_norm * g_sqr_norm), 0.0);
+}
+
 } // namespace ipc
@@ -16,6 +16,12 @@ template <typename T> inline Matrix2<T> Hat(T x);
 template <typename T> inline Matrix3<T> Hat(Vector3<T> x);
 template <typename T> inline MatrixMax3<T> Hat(VectorMax3<T> x);
 
+/// @brief Curvature of the PSD rank-one approximation κ g gᵀ of a hessian.
+///
+/// κ = max(gᵀ H g / ‖g‖⁴, 0) matches the curvature of H along g, which is the
+/// dominant term of a barrier hessian.
+double rank_one_psd_curvature(const VectorMax12d& g, const MatrixMax12d& H);
+
 } // namespace ipc
 
 #include "eigen_ext.tpp"
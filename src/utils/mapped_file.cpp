@@ -0,0 +1,75 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__unix) || defined(unix)                      \
+    || (defined(__APPLE__) && defined(__MACH__))
+#define RIGID_IPC_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ipc::rigid {
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+#ifdef RIGID_IPC_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    m_size = st.st_size;
+    if (m_size > 0) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            ::close(fd); // The mapping stays valid after closing
+            m_data = static_cast<const char*>(data);
+            m_is_open = true;
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    // Fall back to reading the whole file
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    m_size = size_t(in.tellg());
+    m_buffer.resize(m_size);
+    in.seekg(0);
+    if (!in.read(m_buffer.data(), m_size)) {
+        m_buffer.clear();
+        m_size = 0;
+        return false;
+    }
+    m_data = m_buffer.data();
+    m_is_open = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef RIGID_IPC_HAS_MMAP
+    if (m_is_open && m_buffer.empty() && m_size > 0) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+    m_is_open = false;
+}
+
+} // namespace ipc::rigid
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ipc::rigid {
+
+/// @brief Read-only view of the contents of a file.
+///
+/// The file is memory-mapped where supported and read into memory otherwise.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return m_is_open; }
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+protected:
+    bool m_is_open = false;
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    /// @brief Contents of the file if it could not be mapped.
+    std::vector<char> m_buffer;
+};
+
+} // namespace ipc::rigid
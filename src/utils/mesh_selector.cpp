@@ -1,5 +1,8 @@
 #include "mesh_selector.hpp"
 
+#include <algorithm>
+#include <limits>
+
 #include <Eigen/SparseCore>
 #include <igl/Timer.h>
 
@@ -134,4 +137,48 @@ void MeshSelector::init_codim_edges_to_edges(size_t num_edges)
     }
 }
 
+void MeshSelector::write(std::ostream& out) const
+{
+    write_binary(out, m_vertex_to_edge);
+    write_binary(out, m_vertex_to_face);
+    write_binary(out, m_edge_to_face);
+    write_binary(out, m_faces_to_edges);
+    write_binary(out, m_codim_vertices_to_vertices);
+    write_binary(out, m_codim_edges_to_edges);
+}
+
+/// @brief Are all ids less than the count (or the unset id if allowed)?
+static bool are_ids_valid(
+    const std::vector<size_t>& ids, size_t count, bool allow_unset = false)
+{
+    return std::all_of(ids.begin(), ids.end(), [&](size_t id) {
+        return id < count
+            || (allow_unset && id == std::numeric_limits<size_t>::max());
+    });
+}
+
+bool MeshSelector::read(
+    BinaryReader& in, size_t num_vertices, size_t num_edges, size_t num_faces)
+{
+    if (!in.read(m_vertex_to_edge) || !in.read(m_vertex_to_face)
+        || !in.read(m_edge_to_face) || !in.read(m_faces_to_edges)
+        || !in.read(m_codim_vertices_to_vertices)
+        || !in.read(m_codim_edges_to_edges)) {
+        return false;
+    }
+    return m_vertex_to_edge.size() == num_vertices
+        && are_ids_valid(m_vertex_to_edge, num_edges, /*allow_unset=*/true)
+        && m_vertex_to_face.size() == num_vertices
+        && are_ids_valid(m_vertex_to_face, num_faces, /*allow_unset=*/true)
+        && m_edge_to_face.size() == num_edges
+        && are_ids_valid(m_edge_to_face, num_faces, /*allow_unset=*/true)
+        && size_t(m_faces_to_edges.rows()) == num_faces
+        && (num_faces == 0
+            || (m_faces_to_edges.cols() == 3
+                && m_faces_to_edges.minCoeff() >= 0
+                && size_t(m_faces_to_edges.maxCoeff()) < num_edges))
+        && are_ids_valid(m_codim_vertices_to_vertices, num_vertices)
+        && are_ids_valid(m_codim_edges_to_edges, num_edges);
+}
+
 } // namespace ipc::rigid
@@ -3,8 +3,11 @@
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 #include <array>
+#include <ostream>
 #include <vector>
 
+#include <utils/binary_io.hpp>
+
 namespace ipc::rigid {
 
 class MeshSelector {
@@ -49,6 +52,16 @@ public:
 
     size_t num_codim_edges() const { return m_codim_edges_to_edges.size(); }
 
+    /// @brief Serialize the maps (see BinaryReader).
+    void write(std::ostream& out) const;
+    /// @brief Read the maps and check them against the mesh they belong to.
+    /// @return False if the data is truncated or indexes out of the mesh.
+    bool read(
+        BinaryReader& in,
+        size_t num_vertices,
+        size_t num_edges,
+        size_t num_faces);
+
 protected:
     /// Map from vertices to the minimum index edge containing the vertex.
     void init_vertex_to_edge(size_t num_vertices, const Eigen::MatrixXi& E);
@@ -0,0 +1,156 @@
+#include "primitive_bvh.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace ipc::rigid {
+
+void PrimitiveBVH::init(const std::vector<Box>& primitive_boxes)
+{
+    m_nodes.clear();
+    m_boxes.clear();
+    m_num_primitives = primitive_boxes.size();
+    if (primitive_boxes.empty()) {
+        return;
+    }
+
+    std::vector<Eigen::Vector3d> centers(primitive_boxes.size());
+    for (size_t i = 0; i < primitive_boxes.size(); i++) {
+        centers[i] = (primitive_boxes[i][0] + primitive_boxes[i][1]) / 2;
+    }
+
+    std::vector<int> ids(primitive_boxes.size());
+    std::iota(ids.begin(), ids.end(), 0);
+
+    m_nodes.reserve(2 * primitive_boxes.size() - 1);
+    m_boxes.reserve(2 * primitive_boxes.size() - 1);
+    init_recursive(primitive_boxes, centers, ids, 0, ids.size());
+}
+
+int PrimitiveBVH::init_recursive(
+    const std::vector<Box>& primitive_boxes,
+    const std::vector<Eigen::Vector3d>& centers,
+    std::vector<int>& ids,
+    int begin,
+    int end)
+{
+    assert(begin < end);
+    const int node = m_nodes.size();
+    m_nodes.emplace_back();
+    m_boxes.emplace_back();
+
+    if (end - begin == 1) {
+        m_nodes[node].primitive = ids[begin];
+        m_boxes[node] = primitive_boxes[ids[begin]];
+        return node;
+    }
+
+    // Split at the median of the centers along the longest axis
+    Eigen::Vector3d min = centers[ids[begin]], max = centers[ids[begin]];
+    for (int i = begin + 1; i < end; i++) {
+        min = min.cwiseMin(centers[ids[i]]);
+        max = max.cwiseMax(centers[ids[i]]);
+    }
+    int axis;
+    (max - min).maxCoeff(&axis);
+
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(
+        ids.begin() + begin, ids.begin() + mid, ids.begin() + end,
+        [&](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+
+    const int left = init_recursive(primitive_boxes, centers, ids, begin, mid);
+    assert(left == node + 1);
+    const int right = init_recursive(primitive_boxes, centers, ids, mid, end);
+    m_nodes[node].right = right;
+
+    m_boxes[node][0] = m_boxes[left][0].cwiseMin(m_boxes[right][0]);
+    m_boxes[node][1] = m_boxes[left][1].cwiseMax(m_boxes[right][1]);
+    return node;
+}
+
+void PrimitiveBVH::refit(
+    const std::vector<Box>& primitive_boxes, std::vector<Box>& node_boxes) const
+{
+    assert(primitive_boxes.size() == m_num_primitives);
+    node_boxes.resize(m_nodes.size());
+    // Children always come after their parent, so a reverse sweep visits
+    // them first.
+    for (int i = int(m_nodes.size()) - 1; i >= 0; i--) {
+        const Node& node = m_nodes[i];
+        if (node.is_leaf()) {
+            node_boxes[i] = primitive_boxes[node.primitive];
+        } else {
+            node_boxes[i][0] =
+                node_boxes[i + 1][0].cwiseMin(node_boxes[node.right][0]);
+            node_boxes[i][1] =
+                node_boxes[i + 1][1].cwiseMax(node_boxes[node.right][1]);
+        }
+    }
+}
+
+std::vector<int> PrimitiveBVH::subtrees(size_t num_subtrees) const
+{
+    if (m_nodes.empty()) {
+        return std::vector<int>();
+    }
+
+    // Root node and number of nodes of each subtree
+    std::vector<std::pair<int, int>> roots;
+    roots.emplace_back(0, m_nodes.size());
+    while (roots.size() < num_subtrees) {
+        auto largest = std::max_element(
+            roots.begin(), roots.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+        const auto [node, size] = *largest;
+        if (size == 1) {
+            break; // Only leaves are left
+        }
+        // The left child is the next node and ends where the right one starts
+        const int right = m_nodes[node].right;
+        const int left_size = right - (node + 1);
+        *largest = std::make_pair(node + 1, left_size);
+        roots.emplace_back(right, size - 1 - left_size);
+    }
+
+    std::vector<int> nodes(roots.size());
+    for (size_t i = 0; i < roots.size(); i++) {
+        nodes[i] = roots[i].first;
+    }
+    return nodes;
+}
+
+void PrimitiveBVH::write(std::ostream& out) const
+{
+    static_assert(sizeof(Box) == 6 * sizeof(double));
+    write_binary(out, uint64_t(m_num_primitives));
+    write_binary(out, m_nodes);
+    write_binary(out, m_boxes);
+}
+
+bool PrimitiveBVH::read(BinaryReader& in)
+{
+    uint64_t num_primitives;
+    if (!in.read(num_primitives) || !in.read(m_nodes) || !in.read(m_boxes)
+        || m_boxes.size() != m_nodes.size()
+        || m_nodes.size() != (num_primitives ? 2 * num_primitives - 1 : 0)) {
+        return false;
+    }
+    // The nodes are in pre-order: an internal node is followed by its left
+    // child and its right child comes later.
+    const int num_nodes = m_nodes.size();
+    for (int i = 0; i < num_nodes; i++) {
+        const Node& node = m_nodes[i];
+        const bool is_valid = node.is_leaf()
+            ? uint64_t(node.primitive) < num_primitives
+            : node.primitive == -1 && node.right > i + 1
+                && node.right < num_nodes;
+        if (!is_valid) {
+            return false;
+        }
+    }
+    m_num_primitives = num_primitives;
+    return true;
+}
+
+} // namespace ipc::rigid
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <utils/binary_io.hpp>
+
+namespace ipc::rigid {
+
+/// @brief Static bounding volume hierarchy over the primitives of one body.
+///
+/// Unlike BVH::BVH the node boxes are exposed, so the tree of one body can be
+/// refit to moved primitives and traversed simultaneously with another tree.
+class PrimitiveBVH {
+public:
+    typedef std::array<Eigen::Vector3d, 2> Box;
+
+    /// @brief Build the tree over the given primitive boxes.
+    void init(const std::vector<Box>& primitive_boxes);
+
+    size_t num_primitives() const { return m_num_primitives; }
+    size_t num_nodes() const { return m_nodes.size(); }
+
+    /// @brief Node boxes of the tree as built.
+    const std::vector<Box>& boxes() const { return m_boxes; }
+
+    /// @brief Compute the node boxes of this tree for new primitive boxes.
+    /// @param primitive_boxes Boxes indexed like the ones given to init().
+    /// @param node_boxes Output node boxes (same layout as boxes()).
+    void refit(
+        const std::vector<Box>& primitive_boxes,
+        std::vector<Box>& node_boxes) const;
+
+    /// @brief Find all pairs of intersecting primitive boxes of two trees.
+    /// @param a First tree.
+    /// @param a_boxes Node boxes of the first tree (e.g. from refit()).
+    /// @param b Second tree (using its own boxes()).
+    /// @param callback Called with (primitive of a, primitive of b). If it
+    ///                 returns a bool, the traversal stops once it is false.
+    template <typename Callback>
+    static void intersect(
+        const PrimitiveBVH& a,
+        const std::vector<Box>& a_boxes,
+        const PrimitiveBVH& b,
+        Callback callback)
+    {
+        intersect(a, a_boxes, b, /*b_root=*/0, callback);
+    }
+
+    /// @brief Find all pairs of intersecting primitive boxes of a tree and a
+    /// subtree of another tree (see subtrees()).
+    /// @param b_root Root node of the subtree of b.
+    template <typename Callback>
+    static void intersect(
+        const PrimitiveBVH& a,
+        const std::vector<Box>& a_boxes,
+        const PrimitiveBVH& b,
+        int b_root,
+        Callback callback);
+
+    /// @brief Split the tree into disjoint subtrees covering all primitives.
+    ///
+    /// The largest subtree is split until there are num_subtrees of them (or
+    /// only leaves are left), so the subtrees have similar sizes.
+    /// @return Root nodes of the subtrees.
+    std::vector<int> subtrees(size_t num_subtrees) const;
+
+    /// @brief Serialize the tree (see BinaryReader).
+    void write(std::ostream& out) const;
+    /// @brief Read the tree and check that its structure is valid.
+    /// @return False if the data is truncated or the nodes index out of the
+    ///         tree or the primitives.
+    bool read(BinaryReader& in);
+
+    static bool boxes_intersect(const Box& a, const Box& b)
+    {
+        return (a[0].array() <= b[1].array()).all()
+            && (b[0].array() <= a[1].array()).all();
+    }
+
+protected:
+    /// @brief Nodes are stored in pre-order, so the left child of an internal
+    /// node is always the next node.
+    struct Node {
+        int right = -1;     ///< Index of the right child
+        int primitive = -1; ///< Primitive id of a leaf (-1 if internal)
+        bool is_leaf() const { return primitive >= 0; }
+    };
+
+    int init_recursive(
+        const std::vector<Box>& primitive_boxes,
+        const std::vector<Eigen::Vector3d>& centers,
+        std::vector<int>& ids,
+        int begin,
+        int end);
+
+    std::vector<Node> m_nodes;
+    std::vector<Box> m_boxes;
+    size_t m_num_primitives = 0;
+};
+
+template <typename Callback>
+void PrimitiveBVH::intersect(
+    const PrimitiveBVH& a,
+    const std::vector<Box>& a_boxes,
+    const PrimitiveBVH& b,
+    int b_root,
+    Callback callback)
+{
+    if (a.m_nodes.empty() || b.m_nodes.empty()) {
+        return;
+    }
+    assert(a_boxes.size() == a.m_nodes.size());
+    assert(b_root >= 0 && b_root < int(b.m_nodes.size()));
+
+    // The trees are balanced, so the stack never holds more than the sum of
+    // their depths.
+    std::array<std::pair<int, int>, 128> stack;
+    int stack_size = 0;
+    stack[stack_size++] = std::make_pair(0, b_root);
+
+    while (stack_size > 0) {
+        const auto [ai, bi] = stack[--stack_size];
+        const Box& a_box = a_boxes[ai];
+        const Box& b_box = b.m_boxes[bi];
+        if (!boxes_intersect(a_box, b_box)) {
+            continue;
+        }
+
+        const Node& a_node = a.m_nodes[ai];
+        const Node& b_node = b.m_nodes[bi];
+        if (a_node.is_leaf() && b_node.is_leaf()) {
+            const unsigned int a_primitive = a_node.primitive;
+            const unsigned int b_primitive = b_node.primitive;
+            if constexpr (std::is_same_v<
+                              std::invoke_result_t<
+                                  Callback, unsigned int, unsigned int>,
+                              bool>) {
+                if (!callback(a_primitive, b_primitive)) {
+                    return;
+                }
+            } else {
+                callback(a_primitive, b_primitive);
+            }
+            continue;
+        }
+
+        // Descend into the larger of the two nodes
+        bool descend_a = b_node.is_leaf()
+            || (!a_node.is_leaf()
+                && (a_box[1] - a_box[0]).squaredNorm()
+                    >= (b_box[1] - b_box[0]).squaredNorm());
+        assert(stack_size + 2 <= int(stack.size()));
+        if (descend_a) {
+            stack[stack_size++] = std::make_pair(a_node.right, bi);
+            stack[stack_size++] = std::make_pair(ai + 1, bi);
+        } else {
+            stack[stack_size++] = std::make_pair(ai, b_node.right);
+            stack[stack_size++] = std::make_pair(ai, bi + 1);
+        }
+    }
+}
+
+} // namespace ipc::rigid
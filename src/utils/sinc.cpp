@@ -1,5 +1,7 @@
 #include "sinc.hpp"
 
+#include <interval/interval_trig.hpp>
+
 namespace ipc::rigid {
 
 // We use these bounds because for example 1 + x^2 = 1 for x < sqrt(ϵ).
@@ -48,6 +50,10 @@ Interval _sinc_interval_taylor(double x_double)
 
 Interval sinc(const Interval& x)
 {
+    if (is_small_angle(x)) {
+        return small_angle_trig(x).sinc;
+    }
+
     // Define two regions and use even symmetry of sinc.
     // A bound on sinc where it is monotonic ([0, ~4.4934])
     static const double monotonic_bound = 4.4934094579;
@@ -0,0 +1,99 @@
+#include "space_filling_curve.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace ipc::rigid {
+
+/// Interleave the bits of the coordinates with the first coordinate in the
+/// most significant position.
+static uint64_t
+interleave_bits(const std::array<uint32_t, 3>& coords, int dim, int bits)
+{
+    uint64_t key = 0;
+    for (int b = bits - 1; b >= 0; b--) {
+        for (int i = 0; i < dim; i++) {
+            key = (key << 1) | ((coords[i] >> b) & 1);
+        }
+    }
+    return key;
+}
+
+uint64_t morton_key(const std::array<uint32_t, 3>& coords, int dim, int bits)
+{
+    assert(dim >= 1 && dim <= 3 && dim * bits <= 64);
+    return interleave_bits(coords, dim, bits);
+}
+
+uint64_t hilbert_key(std::array<uint32_t, 3> X, int dim, int bits)
+{
+    assert(dim >= 1 && dim <= 3 && dim * bits <= 64);
+    // Convert the coordinates to the transposed Hilbert index (J. Skilling,
+    // "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004).
+    const uint32_t M = uint32_t(1) << (bits - 1);
+    for (uint32_t Q = M; Q > 1; Q >>= 1) { // Inverse undo
+        const uint32_t P = Q - 1;
+        for (int i = 0; i < dim; i++) {
+            if (X[i] & Q) {
+                X[0] ^= P; // Invert
+            } else {
+                const uint32_t t = (X[0] ^ X[i]) & P; // Exchange
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    for (int i = 1; i < dim; i++) { // Gray encode
+        X[i] ^= X[i - 1];
+    }
+    uint32_t t = 0;
+    for (uint32_t Q = M; Q > 1; Q >>= 1) {
+        if (X[dim - 1] & Q) {
+            t ^= Q - 1;
+        }
+    }
+    for (int i = 0; i < dim; i++) {
+        X[i] ^= t;
+    }
+    return interleave_bits(X, dim, bits);
+}
+
+std::vector<size_t>
+space_filling_curve_order(const Eigen::MatrixXd& points, SpaceFillingCurve curve)
+{
+    std::vector<size_t> order(points.rows());
+    std::iota(order.begin(), order.end(), 0);
+    if (points.rows() <= 1) {
+        return order;
+    }
+
+    const int dim = std::min(int(points.cols()), 3);
+    const int bits = 64 / dim > 32 ? 32 : 64 / dim;
+    const double max_coord = double((uint64_t(1) << bits) - 1);
+
+    // Quantize the points to a grid over their bounding box
+    const Eigen::RowVectorXd min = points.colwise().minCoeff();
+    const Eigen::RowVectorXd extent = points.colwise().maxCoeff() - min;
+    std::vector<uint64_t> keys(points.rows());
+    for (size_t i = 0; i < keys.size(); i++) {
+        std::array<uint32_t, 3> coords = { { 0, 0, 0 } };
+        for (int j = 0; j < dim; j++) {
+            if (extent(j) > 0) {
+                coords[j] = uint32_t(
+                    (points(i, j) - min(j)) / extent(j) * max_coord);
+            }
+        }
+        keys[i] = curve == SpaceFillingCurve::HILBERT
+            ? hilbert_key(coords, dim, bits)
+            : morton_key(coords, dim, bits);
+    }
+
+    // Stable, so points in the same cell keep their relative order
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return keys[a] < keys[b];
+    });
+    return order;
+}
+
+} // namespace ipc::rigid
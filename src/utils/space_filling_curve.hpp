@@ -0,0 +1,32 @@
+// Keys and orders of points along space-filling curves.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace ipc::rigid {
+
+enum class SpaceFillingCurve {
+    MORTON, ///< Z-order (interleaved coordinate bits)
+    HILBERT ///< Hilbert curve (consecutive cells are adjacent)
+};
+
+/// @brief Position of a grid cell along the Morton curve.
+/// @param coords Cell coordinates (only the first dim are used).
+/// @param bits Number of bits per coordinate (dim * bits ≤ 64).
+uint64_t morton_key(const std::array<uint32_t, 3>& coords, int dim, int bits);
+
+/// @brief Position of a grid cell along the Hilbert curve.
+/// @param coords Cell coordinates (only the first dim are used).
+/// @param bits Number of bits per coordinate (dim * bits ≤ 64).
+uint64_t hilbert_key(std::array<uint32_t, 3> coords, int dim, int bits);
+
+/// @brief Order of the points (rows) along a curve through their bounding box.
+/// @return Indices of the points sorted by their position along the curve.
+std::vector<size_t>
+space_filling_curve_order(const Eigen::MatrixXd& points, SpaceFillingCurve curve);
+
+} // namespace ipc::rigid
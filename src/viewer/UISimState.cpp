@@ -151,7 +151,15 @@ void UISimState::redraw_scene()
     Eigen::MatrixXd v1 =
         m_state.problem_ptr->velocities() * m_state.problem_ptr->timestep();
 
-    mesh_data->update_vertices(q1);
+    const Eigen::MatrixXi& E = m_state.problem_ptr->edges();
+    const Eigen::MatrixXi& F = m_state.problem_ptr->faces();
+    if (mesh_data->mE.rows() != E.rows() || mesh_data->mE != E
+        || mesh_data->mF.rows() != F.rows() || mesh_data->mF != F) {
+        // The bodies were re-sorted, so the global vertex ids changed
+        mesh_data->set_mesh(q1, E, F);
+    } else {
+        mesh_data->update_vertices(q1);
+    }
     velocity_data->update_vector_field(q1, v1);
     if (m_state.problem_ptr->is_rb_problem()) {
         const auto& bodies =
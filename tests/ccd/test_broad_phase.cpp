@@ -0,0 +1,53 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include <ccd/rigid/broad_phase.hpp>
+
+using namespace ipc;
+using namespace ipc::rigid;
+
+TEST_CASE("Canonical candidate order", "[ccd][broad_phase]")
+{
+    Candidates candidates;
+    for (long i = 0; i < 20; i++) {
+        for (long j = 0; j < 20; j++) {
+            candidates.ev_candidates.emplace_back(i, j);
+            candidates.ee_candidates.emplace_back(i, j);
+            candidates.fv_candidates.emplace_back(i, j);
+        }
+    }
+
+    // Any order the threads could produce sorts to the same list
+    Candidates shuffled = candidates;
+    std::mt19937 gen(GENERATE(0, 1, 2));
+    std::shuffle(
+        shuffled.ev_candidates.begin(), shuffled.ev_candidates.end(), gen);
+    std::shuffle(
+        shuffled.ee_candidates.begin(), shuffled.ee_candidates.end(), gen);
+    std::shuffle(
+        shuffled.fv_candidates.begin(), shuffled.fv_candidates.end(), gen);
+    sort_candidates(shuffled);
+
+    for (size_t i = 0; i < candidates.ev_candidates.size(); i++) {
+        CHECK(
+            shuffled.ev_candidates[i].edge_id
+            == candidates.ev_candidates[i].edge_id);
+        CHECK(
+            shuffled.ev_candidates[i].vertex_id
+            == candidates.ev_candidates[i].vertex_id);
+        CHECK(
+            shuffled.ee_candidates[i].edge0_id
+            == candidates.ee_candidates[i].edge0_id);
+        CHECK(
+            shuffled.ee_candidates[i].edge1_id
+            == candidates.ee_candidates[i].edge1_id);
+        CHECK(
+            shuffled.fv_candidates[i].face_id
+            == candidates.fv_candidates[i].face_id);
+        CHECK(
+            shuffled.fv_candidates[i].vertex_id
+            == candidates.fv_candidates[i].vertex_id);
+    }
+}
@@ -0,0 +1,165 @@
+#include <catch2/catch.hpp>
+
+#include <ghc/fs_std.hpp> // filesystem
+
+#include <ccd/query_log.hpp>
+
+using namespace ipc;
+using namespace ipc::rigid;
+
+TEST_CASE("CCD query log round trip", "[ccd][query_log]")
+{
+    CCDQuery query;
+    query.type = CollisionType::EDGE_EDGE;
+    query.trajectory = TrajectoryType::RIGID;
+    query.dim = 3;
+    query.vertices[0] = Eigen::Vector3d(-1, 0, 0);
+    query.vertices[1] = Eigen::Vector3d(1, 0, 0);
+    query.vertices[2] = Eigen::Vector3d(0, 0, -1);
+    query.vertices[3] = Eigen::Vector3d(0, 0, 1);
+    query.poseA_t0 =
+        PoseD(Eigen::Vector3d(0, 0.5, 0), Eigen::Vector3d(0, 0, 0.1));
+    query.poseA_t1 =
+        PoseD(Eigen::Vector3d(0, -0.5, 0), Eigen::Vector3d(0, 0, -0.1));
+    query.poseB_t0 = PoseD::Zero(3);
+    query.poseB_t1 = PoseD::Zero(3);
+    query.earliest_toi = 1;
+    query.minimum_separation_distance = 0;
+    query.is_impacting = query.run(query.trajectory, query.toi);
+    query.seconds = 1e-6;
+    CHECK(query.is_impacting);
+    CHECK(query.toi == Approx(0.5).margin(1e-3));
+
+    const int num_appended = 10;
+    std::string path =
+        (fs::temp_directory_path() / "rigid_ipc_ccd_query_log.bin").string();
+    CCDQueryLog log;
+    REQUIRE(log.open(path));
+    for (int i = 0; i < num_appended; i++) {
+        log.append(query);
+    }
+    log.close();
+
+    std::vector<CCDQuery> queries;
+    REQUIRE(CCDQueryLog::read(path, queries));
+    CHECK(queries.size() == num_appended);
+    for (const CCDQuery& read_query : queries) {
+        CHECK(read_query.type == query.type);
+        CHECK(read_query.trajectory == query.trajectory);
+        CHECK(read_query.dim == query.dim);
+        for (int i = 0; i < 4; i++) {
+            CHECK(read_query.vertices[i] == query.vertices[i]);
+        }
+        CHECK(read_query.poseA_t0.position == query.poseA_t0.position);
+        CHECK(read_query.poseA_t1.rotation == query.poseA_t1.rotation);
+        CHECK(read_query.toi == query.toi);
+        CHECK(read_query.seconds == query.seconds);
+
+        double toi;
+        CHECK(read_query.run(read_query.trajectory, toi));
+        CHECK(toi == query.toi);
+    }
+    fs::remove(path);
+}
+
+TEST_CASE("CCD query log sampling", "[ccd][query_log]")
+{
+    std::string path =
+        (fs::temp_directory_path() / "rigid_ipc_ccd_query_log.bin").string();
+    CCDQueryLog log;
+    REQUIRE(log.open(path, 0.25));
+
+    const PoseD pose_t0(Eigen::Vector3d(0, 0.5, 0), Eigen::Vector3d::Zero());
+    const PoseD pose_t1(Eigen::Vector3d(0, -0.5, 0), Eigen::Vector3d::Zero());
+    const int num_queries = 1000;
+    std::vector<bool> is_sampled(num_queries);
+    int num_sampled = 0;
+    for (int i = 0; i < num_queries; i++) {
+        is_sampled[i] = log.sample(
+            CollisionType::EDGE_EDGE, i, i + 1, pose_t0, pose_t1, pose_t0,
+            pose_t1);
+        num_sampled += is_sampled[i];
+    }
+    CHECK(num_sampled > 0.15 * num_queries);
+    CHECK(num_sampled < 0.35 * num_queries);
+
+    // The decision only depends on the query, so it does not change with the
+    // order (or thread) the queries are sampled in.
+    for (int i = num_queries - 1; i >= 0; i--) {
+        CHECK(
+            log.sample(
+                CollisionType::EDGE_EDGE, i, i + 1, pose_t0, pose_t1, pose_t0,
+                pose_t1)
+            == is_sampled[i]);
+    }
+
+    log.close();
+    CHECK(!log.sample(
+        CollisionType::EDGE_EDGE, 0, 1, pose_t0, pose_t1, pose_t0, pose_t1));
+    fs::remove(path);
+}
+
+TEST_CASE("CCD query replay of a single vertex", "[ccd][query_log]")
+{
+    CCDQuery query;
+    query.trajectory = TrajectoryType::RIGID;
+    query.earliest_toi = 1;
+    query.minimum_separation_distance = 0;
+
+    SECTION("2D edge-vertex")
+    {
+        query.type = CollisionType::EDGE_VERTEX;
+        query.dim = 2;
+        query.vertices[0] = Eigen::Vector3d(0, 0, 0);
+        query.vertices[1] = Eigen::Vector3d(-1, 0, 0);
+        query.vertices[2] = Eigen::Vector3d(1, 0, 0);
+        query.poseA_t0 = PoseD(0, 0.5, 0);
+        query.poseA_t1 = PoseD(0, -0.5, 0);
+        query.poseB_t0 = PoseD::Zero(2);
+        query.poseB_t1 = PoseD::Zero(2);
+    }
+    SECTION("3D face-vertex")
+    {
+        query.type = CollisionType::FACE_VERTEX;
+        query.dim = 3;
+        query.vertices[0] = Eigen::Vector3d(0, 0, 0);
+        query.vertices[1] = Eigen::Vector3d(-1, -1, 0);
+        query.vertices[2] = Eigen::Vector3d(2, -1, 0);
+        query.vertices[3] = Eigen::Vector3d(-1, 2, 0);
+        query.poseA_t0 =
+            PoseD(Eigen::Vector3d(0, 0, 0.5), Eigen::Vector3d::Zero());
+        query.poseA_t1 =
+            PoseD(Eigen::Vector3d(0, 0, -0.5), Eigen::Vector3d::Zero());
+        query.poseB_t0 = PoseD::Zero(3);
+        query.poseB_t1 = PoseD::Zero(3);
+    }
+
+    // The body of the vertex is rebuilt without mass properties
+    const RigidBody bodyA = query.body(0);
+    REQUIRE(bodyA.num_vertices() == 1);
+    CHECK(bodyA.vertices.row(0).isZero());
+    CHECK(bodyA.world_vertex(query.poseA_t1, 0).isApprox(
+        query.poseA_t1.position));
+
+    query.is_impacting = query.run(query.trajectory, query.toi);
+    query.seconds = 1e-6;
+    CHECK(query.is_impacting);
+    CHECK(query.toi == Approx(0.5).margin(1e-3));
+
+    std::string path =
+        (fs::temp_directory_path() / "rigid_ipc_ccd_query_log.bin").string();
+    CCDQueryLog log;
+    REQUIRE(log.open(path));
+    log.append(query);
+    log.close();
+
+    std::vector<CCDQuery> queries;
+    REQUIRE(CCDQueryLog::read(path, queries));
+    REQUIRE(queries.size() == 1);
+    CHECK(queries[0].type == query.type);
+    CHECK(queries[0].dim == query.dim);
+    double toi;
+    CHECK(queries[0].run(queries[0].trajectory, toi));
+    CHECK(toi == query.toi);
+    fs::remove(path);
+}
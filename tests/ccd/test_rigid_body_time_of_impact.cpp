@@ -7,7 +7,9 @@
 #include <ipc/distance/edge_edge.hpp>
 
 // #include <ccd.hpp>
+#include <ccd/conservative_advancement/time_of_impact.hpp>
 #include <ccd/piecewise_linear/time_of_impact.hpp>
+#include <ccd/rigid/motion_bound.hpp>
 #include <ccd/rigid/time_of_impact.hpp>
 #include <constants.hpp>
 #include <io/serialize_json.hpp>
@@ -163,6 +165,120 @@ TEST_CASE("Rigid edge-vertex time of impact", "[ccd][rigid_toi][edge_vertex]")
         // clang-format on
         CHECK(toi <= expected_toi);
     }
+
+    double toi_lower_bound = edge_vertex_toi_lower_bound(
+        bodyA, bodyA_pose_t0, bodyA_pose_t1, /*vertex_id=*/0, //
+        bodyB, bodyB_pose_t0, bodyB_pose_t1, /*edge_id=*/0);
+    if (is_impact_expected) {
+        CHECK(toi_lower_bound <= expected_toi);
+    }
+
+    // Conservative advancement can report near misses, but never misses an
+    // impact or reports it late.
+    double ca_toi;
+    bool is_ca_impacting =
+        compute_edge_vertex_time_of_impact_conservative_advancement(
+            bodyA, bodyA_pose_t0, bodyA_pose_t1, /*vertex_id=*/0, //
+            bodyB, bodyB_pose_t0, bodyB_pose_t1, /*edge_id=*/0,   //
+            ca_toi, /*earliest_toi=*/1, /*minimum_separation_distance=*/0,
+            /*toi_tolerance=*/TESTING_TOI_TOLERANCE);
+    CAPTURE(ca_toi);
+    if (is_impact_expected) {
+        CHECK(is_ca_impacting);
+        CHECK(ca_toi <= expected_toi);
+    }
+}
+
+TEST_CASE("Rigid vertex motion bound", "[ccd][rigid_toi][motion_bound]")
+{
+    Eigen::MatrixXd vertices(4, 3);
+    vertices << 1, 0, 0, 0, 2, 0, 0, 0, 3, -1, 1, 1;
+    Eigen::MatrixXi edges(1, 2);
+    edges << 0, 1;
+    RigidBody body = create_body(vertices, edges);
+
+    Pose<double> pose_t0(
+        Eigen::Vector3d(0.1, -0.2, 0.3), Eigen::Vector3d(0.5, -1.0, 2.0));
+    Pose<double> pose_t1(
+        Eigen::Vector3d(1.0, 0.0, -1.0), Eigen::Vector3d(-2.0, 3.0, 0.5));
+
+    const int num_samples = 100;
+    for (int vi = 0; vi < vertices.rows(); vi++) {
+        double bound = vertex_motion_bound(body, pose_t0, pose_t1, vi);
+        Eigen::Vector3d v_t0 = body.world_vertex(pose_t0, vi);
+        for (int i = 1; i <= num_samples; i++) {
+            double t = i / double(num_samples);
+            Eigen::Vector3d v_t = body.world_vertex(
+                Pose<double>::interpolate(pose_t0, pose_t1, t), vi);
+            CHECK((v_t - v_t0).norm() <= t * bound + 1e-12);
+        }
+    }
+}
+
+TEST_CASE(
+    "Mean value trajectory enclosure", "[ccd][rigid_toi][edge_edge][enclosure]")
+{
+    Eigen::MatrixXd bodyA_vertices(2, 3), bodyB_vertices(2, 3);
+    bodyA_vertices << -1, 0.1, 0, 1, -0.2, 0.3;
+    bodyB_vertices << 0.2, -1, 0.5, -0.1, 1, -0.5;
+    Eigen::MatrixXi edges(1, 2);
+    edges << 0, 1;
+    RigidBody bodyA = create_body(bodyA_vertices, edges);
+    RigidBody bodyB = create_body(bodyB_vertices, edges);
+
+    Pose<double> poseA_t0(
+        Eigen::Vector3d(0, 0, 1), Eigen::Vector3d(0.1, 0.2, -0.3));
+    Pose<double> poseA_t1(
+        Eigen::Vector3d(0.5, 0, -1), Eigen::Vector3d(1.5, -0.5, 2.0));
+    Pose<double> poseB_t0 = Pose<double>::Zero(3);
+    Pose<double> poseB_t1(
+        Eigen::Vector3d(0, 0.1, 0), Eigen::Vector3d(0, 0, 0.5));
+
+    const Pose<Interval> poseIA_t0 = poseA_t0.cast<Interval>();
+    const Pose<Interval> poseIA_t1 = poseA_t1.cast<Interval>();
+    const Pose<Interval> poseIB_t0 = poseB_t0.cast<Interval>();
+    const Pose<Interval> poseIB_t1 = poseB_t1.cast<Interval>();
+
+    double width = GENERATE(1.0, 0.1, 1e-3);
+    Interval t(0.3, 0.3 + width / 2), alpha(0.2, 0.2 + width),
+        beta(0, width);
+
+    VectorMax3I naive = edge_edge_aabb(
+        bodyA, poseIA_t0, poseIA_t1, 0, bodyB, poseIB_t0, poseIB_t1, 0, t,
+        alpha, beta, NAIVE_ENCLOSURE);
+    VectorMax3I mean_value = edge_edge_aabb(
+        bodyA, poseIA_t0, poseIA_t1, 0, bodyB, poseIB_t0, poseIB_t1, 0, t,
+        alpha, beta, MEAN_VALUE_ENCLOSURE);
+
+    for (int i = 0; i < 3; i++) {
+        CHECK(boost::numeric::subset(mean_value(i), naive(i)));
+    }
+    if (width <= 1e-3) {
+        // The mean value form is tighter for small boxes
+        CHECK(diagonal_width(mean_value) < diagonal_width(naive));
+    }
+
+    const int n = 5;
+    for (int i = 0; i <= n; i++) {
+        double ti = t.lower() + i / double(n) * (t.upper() - t.lower());
+        Pose<double> poseA = Pose<double>::interpolate(poseA_t0, poseA_t1, ti);
+        Pose<double> poseB = Pose<double>::interpolate(poseB_t0, poseB_t1, ti);
+        for (int j = 0; j <= n; j++) {
+            double a = alpha.lower() + j / double(n) * width;
+            for (int k = 0; k <= n; k++) {
+                double b = beta.lower() + k / double(n) * width;
+                Eigen::Vector3d d = (1 - a) * bodyA.world_vertex(poseA, 0)
+                    + a * bodyA.world_vertex(poseA, 1)
+                    - (1 - b) * bodyB.world_vertex(poseB, 0)
+                    - b * bodyB.world_vertex(poseB, 1);
+                for (int l = 0; l < 3; l++) {
+                    // Allow for the rounding of the sampled point
+                    CHECK(d(l) >= mean_value(l).lower() - 1e-12);
+                    CHECK(d(l) <= mean_value(l).upper() + 1e-12);
+                }
+            }
+        }
+    }
 }
 
 TEST_CASE("Rigid edge-edge time of impact", "[ccd][rigid_toi][edge_edge]")
@@ -226,6 +342,19 @@ TEST_CASE("Rigid edge-edge time of impact", "[ccd][rigid_toi][edge_edge]")
         // clang-format on
         CHECK(toi <= expected_toi);
     }
+
+    double ca_toi;
+    bool is_ca_impacting =
+        compute_edge_edge_time_of_impact_conservative_advancement(
+            bodyA, bodyA_pose_t0, bodyA_pose_t1, /*edgeA_id=*/0, //
+            bodyB, bodyB_pose_t0, bodyB_pose_t1, /*edgeB_id=*/0, //
+            ca_toi, /*earliest_toi=*/1, /*minimum_separation_distance=*/0,
+            /*toi_tolerance=*/TESTING_TOI_TOLERANCE);
+    CAPTURE(ca_toi);
+    if (is_impact_expected) {
+        CHECK(is_ca_impacting);
+        CHECK(ca_toi <= expected_toi);
+    }
 }
 
 TEST_CASE("Rigid face-vertex time of impact", "[ccd][rigid_toi][face_vertex]")
@@ -298,6 +427,85 @@ TEST_CASE("Rigid face-vertex time of impact", "[ccd][rigid_toi][face_vertex]")
         // clang-format on
         CHECK(toi <= expected_toi);
     }
+
+    double ca_toi;
+    bool is_ca_impacting =
+        compute_face_vertex_time_of_impact_conservative_advancement(
+            bodyB, bodyB_pose_t0, bodyB_pose_t1, /*vertex_id=*/0, // Vertex body
+            bodyA, bodyA_pose_t0, bodyA_pose_t1, /*face_id=*/0,   // Face body
+            ca_toi, /*earliest_toi=*/1, /*minimum_separation_distance=*/0,
+            /*toi_tolerance=*/TESTING_TOI_TOLERANCE);
+    CAPTURE(ca_toi);
+    if (is_impact_expected) {
+        CHECK(is_ca_impacting);
+        CHECK(ca_toi <= expected_toi);
+    }
+}
+
+TEST_CASE(
+    "Conservative advancement of close primitives",
+    "[ccd][rigid_toi][conservative_advancement]")
+{
+    // The primitives start closer than the distance they travel in
+    // TESTING_TOI_TOLERANCE, and either approach or move apart.
+    const double gap = 1e-7;
+    const double y_t1 = GENERATE(-1.0, 1.0);
+    const bool is_impact_expected = y_t1 < 0;
+    const double expected_toi = gap / (gap - y_t1);
+
+    Pose<double> bodyA_pose_t0 = Pose<double>::Zero(3);
+    Pose<double> bodyA_pose_t1 = Pose<double>::Zero(3);
+    bodyA_pose_t0.position.y() = gap;
+    bodyA_pose_t1.position.y() = y_t1;
+    Pose<double> bodyB_pose_t0 = Pose<double>::Zero(3);
+    Pose<double> bodyB_pose_t1 = Pose<double>::Zero(3);
+
+    double toi;
+    bool is_impacting;
+    SECTION("Edge-edge")
+    {
+        Eigen::MatrixXd bodyA_vertices(2, 3), bodyB_vertices(2, 3);
+        bodyA_vertices << -1, 0, 0, 1, 0, 0;
+        bodyB_vertices << 0, 0, -1, 0, 0, 1;
+        Eigen::MatrixXi edges(1, 2);
+        edges << 0, 1;
+        RigidBody bodyA = create_body(bodyA_vertices, edges);
+        RigidBody bodyB = create_body(bodyB_vertices, edges);
+
+        is_impacting =
+            compute_edge_edge_time_of_impact_conservative_advancement(
+                bodyA, bodyA_pose_t0, bodyA_pose_t1, /*edgeA_id=*/0, //
+                bodyB, bodyB_pose_t0, bodyB_pose_t1, /*edgeB_id=*/0, //
+                toi, /*earliest_toi=*/1, /*minimum_separation_distance=*/0,
+                /*toi_tolerance=*/TESTING_TOI_TOLERANCE);
+    }
+    SECTION("Face-vertex")
+    {
+        Eigen::MatrixXd bodyA_vertices(2, 3), bodyB_vertices(3, 3);
+        bodyA_vertices << 0, 0, 0, 0, 1, 0;
+        bodyB_vertices << -1, 0, -1, 1, 0, -1, 0, 0, 1;
+        Eigen::MatrixXi bodyA_edges(1, 2);
+        bodyA_edges << 0, 1;
+        Eigen::MatrixXi bodyB_faces(1, 3);
+        bodyB_faces << 0, 1, 2;
+        Eigen::MatrixXi bodyB_edges;
+        igl::edges(bodyB_faces, bodyB_edges);
+        RigidBody bodyA = create_body(bodyA_vertices, bodyA_edges);
+        RigidBody bodyB = create_body(bodyB_vertices, bodyB_edges, bodyB_faces);
+
+        is_impacting =
+            compute_face_vertex_time_of_impact_conservative_advancement(
+                bodyA, bodyA_pose_t0, bodyA_pose_t1, /*vertex_id=*/0, //
+                bodyB, bodyB_pose_t0, bodyB_pose_t1, /*face_id=*/0,   //
+                toi, /*earliest_toi=*/1, /*minimum_separation_distance=*/0,
+                /*toi_tolerance=*/TESTING_TOI_TOLERANCE);
+    }
+
+    CAPTURE(y_t1, toi, expected_toi);
+    CHECK(is_impacting == is_impact_expected);
+    if (is_impacting) {
+        CHECK(toi <= expected_toi);
+    }
 }
 
 TEST_CASE("Fast EE case", "[!benchmark][ccd][rigid_toi][edge_edge][fast]")
@@ -0,0 +1,58 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+#include <interval/interval_trig.hpp>
+#include <physics/pose.hpp>
+
+using namespace ipc;
+using namespace ipc::rigid;
+
+TEST_CASE("Small angle interval trig", "[interval][trig]")
+{
+    double lower = GENERATE(-1.0, -0.5, -1e-8, 0.0, 1e-12, 0.25);
+    double dx = GENERATE(0.0, 1e-10, 1e-3, 0.5);
+    Interval x(lower, std::min(lower + dx, SMALL_ANGLE_BOUND));
+    REQUIRE(is_small_angle(x));
+    CAPTURE(x.lower(), x.upper());
+
+    const SmallAngleTrig y = small_angle_trig(x);
+
+    const int num_samples = 100;
+    for (int i = 0; i <= num_samples; i++) {
+        double xi = std::min(
+            x.lower() + i / double(num_samples) * (x.upper() - x.lower()),
+            x.upper());
+        CHECK(boost::numeric::in(std::sin(xi), y.sin));
+        CHECK(boost::numeric::in(std::cos(xi), y.cos));
+        double sinc_xi = xi == 0 ? 1 : std::sin(xi) / xi;
+        CHECK(boost::numeric::in(sinc_xi, y.sinc));
+        double versine_xi = xi == 0 ? 0.5 : (1 - std::cos(xi)) / (xi * xi);
+        // (1 - cos(x)) / x² loses all precision for tiny x in doubles
+        if (std::abs(xi) > 1e-4) {
+            CHECK(boost::numeric::in(versine_xi, y.one_minus_cos_over_x2));
+        }
+    }
+
+    // The enclosures are tight
+    CHECK(boost::numeric::width(y.sin) <= dx + 1e-13);
+    CHECK(boost::numeric::width(y.cos) <= dx + 1e-13);
+}
+
+TEST_CASE("Small angle interval rotation", "[interval][trig][pose]")
+{
+    Eigen::Vector3d r(0.1, -0.3, 0.2);
+    Pose<double> pose(Eigen::Vector3d::Zero(), r);
+    Eigen::Matrix3d R = pose.construct_rotation_matrix();
+
+    Pose<Interval> poseI = pose.cast<Interval>();
+    poseI.rotation(0) = Interval(0.1 - 1e-6, 0.1 + 1e-6);
+    Matrix3I RI = poseI.construct_rotation_matrix();
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            CHECK(boost::numeric::in(R(i, j), RI(i, j)));
+            CHECK(boost::numeric::width(RI(i, j)) < 1e-5);
+        }
+    }
+}
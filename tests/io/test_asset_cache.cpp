@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+
+#include <fstream>
+
+#include <ghc/fs_std.hpp> // filesystem
+
+#include <io/asset_cache.hpp>
+#include <io/read_rb_scene.hpp>
+
+using namespace ipc::rigid;
+
+TEST_CASE("Cached rigid body assets", "[io][asset_cache]")
+{
+    nlohmann::json scene = R"({"rigid_bodies": [
+        {
+            "mesh": "bunny-lowpoly.obj",
+            "position": [1, 2, 3],
+            "rotation": [10, 20, 30],
+            "scale": 0.5,
+            "density": 500,
+            "linear_velocity": [1, 0, 0],
+            "angular_velocity": [0, 90, 0]
+        },
+        {
+            "mesh": "2cubes.obj",
+            "split_components": true
+        }
+    ]})"_json;
+
+    std::vector<RigidBody> expected_rbs;
+    REQUIRE(read_rb_scene(scene, expected_rbs));
+
+    fs::path cache_dir = fs::temp_directory_path() / "rigid_ipc_asset_cache";
+    fs::remove_all(cache_dir);
+    REQUIRE(asset_cache().open(cache_dir.string()));
+
+    // The first read fills the cache and the second one reads from it
+    for (int i = 0; i < 2; i++) {
+        std::vector<RigidBody> rbs;
+        REQUIRE(read_rb_scene(scene, rbs));
+        CHECK(std::distance(
+                  fs::directory_iterator(cache_dir), fs::directory_iterator())
+              == 2);
+
+        REQUIRE(rbs.size() == expected_rbs.size());
+        for (int j = 0; j < rbs.size(); j++) {
+            const RigidBody& rb = rbs[j];
+            const RigidBody& expected = expected_rbs[j];
+            CHECK(rb.name == expected.name);
+            CHECK(rb.vertices == expected.vertices);
+            CHECK(rb.edges == expected.edges);
+            CHECK(rb.faces == expected.faces);
+            CHECK(rb.mass == expected.mass);
+            CHECK(rb.moment_of_inertia == expected.moment_of_inertia);
+            CHECK(rb.pose.position == expected.pose.position);
+            CHECK(rb.pose.rotation == expected.pose.rotation);
+            CHECK(rb.velocity.rotation == expected.velocity.rotation);
+            CHECK(rb.num_codim_edges() == expected.num_codim_edges());
+            CHECK(rb.bvh.boxes().size() == expected.bvh.boxes().size());
+        }
+    }
+
+    asset_cache().close();
+    fs::remove_all(cache_dir);
+}
+
+TEST_CASE("Corrupted rigid body assets", "[io][asset_cache]")
+{
+    nlohmann::json scene = R"({"rigid_bodies": [
+        {"mesh": "bunny-lowpoly.obj"}
+    ]})"_json;
+
+    fs::path cache_dir =
+        fs::temp_directory_path() / "rigid_ipc_corrupted_asset_cache";
+    fs::remove_all(cache_dir);
+    REQUIRE(asset_cache().open(cache_dir.string()));
+
+    std::vector<RigidBody> rbs;
+    REQUIRE(read_rb_scene(scene, rbs));
+    REQUIRE(
+        std::distance(
+            fs::directory_iterator(cache_dir), fs::directory_iterator())
+        == 1);
+    const fs::path entry = fs::directory_iterator(cache_dir)->path();
+    const std::string key = entry.stem().string();
+
+    std::vector<RigidBodyAsset> assets;
+    REQUIRE(asset_cache().load(key, assets));
+    REQUIRE(assets.size() == 1);
+
+    SECTION("Edge index out of range")
+    {
+        assets[0].edges(0, 1) = assets[0].vertices.rows();
+        REQUIRE(asset_cache().store(key, assets));
+    }
+    SECTION("Face index out of range")
+    {
+        assets[0].faces(0, 2) = -1;
+        REQUIRE(asset_cache().store(key, assets));
+    }
+    SECTION("Too many assets")
+    {
+        // The number of assets follows the magic and the version
+        std::fstream file(
+            entry.string(), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(8 + sizeof(uint32_t));
+        const uint64_t num_assets = uint64_t(1) << 60;
+        file.write(
+            reinterpret_cast<const char*>(&num_assets), sizeof(num_assets));
+    }
+
+    CHECK(!asset_cache().load(key, assets));
+    CHECK(assets.empty());
+
+    asset_cache().close();
+    fs::remove_all(cache_dir);
+}
@@ -0,0 +1,62 @@
+#include <catch2/catch.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <ghc/fs_std.hpp> // filesystem
+
+#include <io/metrics_log.hpp>
+
+using namespace ipc::rigid;
+
+static std::vector<std::string> read_lines(const fs::path& path)
+{
+    std::vector<std::string> lines;
+    std::ifstream file(path.string());
+    for (std::string line; std::getline(file, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+TEST_CASE("Metrics log", "[io][metrics_log]")
+{
+    const int num_steps = 100;
+    fs::path path = fs::temp_directory_path() / "rigid_ipc_metrics";
+
+    MetricsLog log;
+    CHECK(!log.is_open());
+    SECTION("JSON Lines")
+    {
+        REQUIRE(log.open(path.string(), MetricsFormat::JSON_LINES));
+        for (int i = 0; i < num_steps; i++) {
+            log.append({ { "step", i }, { "step_time", 0.5 * i } });
+        }
+        log.close();
+        CHECK(!log.is_open());
+
+        std::vector<std::string> lines = read_lines(path);
+        REQUIRE(lines.size() == num_steps);
+        for (int i = 0; i < num_steps; i++) {
+            nlohmann::json record = nlohmann::json::parse(lines[i]);
+            CHECK(record["step"] == i);
+            CHECK(record["step_time"] == 0.5 * i);
+        }
+    }
+    SECTION("CSV")
+    {
+        REQUIRE(log.open(path.string(), MetricsFormat::CSV));
+        log.append({ { "step", 0 }, { "step_time", 1.5 } });
+        // Missing values are left empty and extra ones are dropped
+        log.append({ { "step", 1 }, { "rss", 1024 } });
+        log.close();
+
+        std::vector<std::string> lines = read_lines(path);
+        REQUIRE(lines.size() == 3);
+        CHECK(lines[0] == "step,step_time");
+        CHECK(lines[1] == "0,1.5");
+        CHECK(lines[2] == "1,");
+    }
+    fs::remove(path);
+}
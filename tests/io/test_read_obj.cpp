@@ -0,0 +1,63 @@
+#include <catch2/catch.hpp>
+
+#include <fstream>
+
+#include <ghc/fs_std.hpp> // filesystem
+
+#include <io/read_obj.hpp>
+
+using namespace ipc::rigid;
+
+TEST_CASE("Read OBJ", "[io][obj]")
+{
+    const std::string path =
+        (fs::temp_directory_path() / "rigid_ipc_read_obj.obj").string();
+    {
+        std::ofstream obj(path, std::ios::binary);
+        obj << "# comment\r\n"
+               "o mesh\n"
+               "v 0 0 0\n"
+               "v +1.0 0 0\r\n"
+               "v 0 1e0 0\n"
+               "vn 0 0 1\n"
+               "vt 0 0\n"
+               "v 0 0 -1.5\n"
+               "s off\n"
+               "f 1/1/1 2/1/1 3/1/1\n"
+               "f 1//1 -1//1 2//1\n"
+               "\n"
+               "f  1   4 3 \n"
+               "l 1 2 -1";
+    }
+
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi E, F;
+    REQUIRE(read_obj(path, V, E, F));
+
+    Eigen::MatrixXd expected_V(4, 3);
+    expected_V << 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, -1.5;
+    CHECK(V == expected_V);
+
+    Eigen::MatrixXi expected_F(3, 3);
+    expected_F << 0, 1, 2, 0, 3, 1, 0, 3, 2;
+    CHECK(F == expected_F);
+
+    // Polyline edges followed by the face edges
+    REQUIRE(E.rows() > 2);
+    CHECK(E.row(0) == Eigen::RowVector2i(0, 1));
+    CHECK(E.row(1) == Eigen::RowVector2i(1, 3));
+
+    SECTION("Faces of different degrees")
+    {
+        std::ofstream(path, std::ios::app) << "\nf 1 2 3 4\n";
+        CHECK(!read_obj(path, V, E, F));
+    }
+
+    SECTION("Invalid vertex")
+    {
+        std::ofstream(path, std::ios::app) << "\nv 0 x 0\n";
+        CHECK(!read_obj(path, V, E, F));
+    }
+
+    fs::remove(path);
+}
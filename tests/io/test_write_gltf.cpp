@@ -0,0 +1,134 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <igl/edges.h>
+
+#define TINYGLTF_NO_INCLUDE_JSON
+#define TINYGLTF_NO_STB_IMAGE
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#include <nlohmann/json.hpp>
+#include <tiny_gltf.h>
+
+#include <io/write_gltf.hpp>
+
+using namespace ipc::rigid;
+
+static RigidBody tetrahedron(double scale, int group_id)
+{
+    Eigen::MatrixXd V(4, 3);
+    V << 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1;
+    V *= scale;
+    Eigen::MatrixXi F(4, 3);
+    F << 0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3;
+    Eigen::MatrixXi E;
+    igl::edges(F, E);
+    return RigidBody(
+        V, E, F, PoseD::Zero(3), /*velocity=*/PoseD::Zero(3),
+        /*force=*/PoseD::Zero(3), /*density=*/1.0,
+        /*is_dof_fixed=*/VectorMax6b::Zero(6), /*oriented=*/false, group_id);
+}
+
+static PoseD frame_pose(int body, int frame)
+{
+    PoseD pose = PoseD::Zero(3);
+    pose.position << 0.1 * frame, body, 0;
+    pose.rotation << 0, 0.02 * frame, 0.01 * body;
+    return pose;
+}
+
+/// @brief Element of a float or normalized short accessor.
+static Eigen::VectorXd
+accessor_element(const tinygltf::Model& model, int accessor_id, size_t i)
+{
+    const tinygltf::Accessor& accessor = model.accessors[accessor_id];
+    const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+    const int n = tinygltf::GetNumComponentsInType(accessor.type);
+    const int size = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+    const unsigned char* data = &model.buffers[view.buffer].data[0]
+        + view.byteOffset + accessor.byteOffset + i * n * size;
+
+    Eigen::VectorXd x(n);
+    for (int k = 0; k < n; k++) {
+        if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
+            float value;
+            std::memcpy(&value, data + k * size, size);
+            x[k] = value;
+        } else {
+            REQUIRE(accessor.componentType == TINYGLTF_COMPONENT_TYPE_SHORT);
+            REQUIRE(accessor.normalized);
+            int16_t value;
+            std::memcpy(&value, data + k * size, size);
+            x[k] = std::max(value / 32767.0, -1.0);
+        }
+    }
+    return x;
+}
+
+TEST_CASE("Streaming GLB export", "[io][gltf]")
+{
+    RigidBodyAssembler bodies;
+    bodies.init({ tetrahedron(1, 0), tetrahedron(1, 1), tetrahedron(2, 2) });
+
+    const int num_frames = GENERATE(1, 8, 50);
+    const bool quantize_rotations = GENERATE(false, true);
+    const std::string filename = "test_write_gltf.glb";
+
+    GLBAnimationWriter writer;
+    REQUIRE(writer.open(
+        filename, bodies, /*timestep=*/0.01, quantize_rotations,
+        /*frames_per_chunk=*/8));
+    for (int j = 0; j < num_frames; j++) {
+        PosesD poses;
+        for (int i = 0; i < bodies.num_bodies(); i++) {
+            poses.push_back(frame_pose(i, j));
+        }
+        writer.append(poses);
+    }
+    CHECK(writer.num_frames() == num_frames);
+    REQUIRE(writer.close());
+    // The temporary samples are removed
+    CHECK(!std::ifstream(filename + ".samples"));
+
+    tinygltf::Model model;
+    std::string err, warn;
+    REQUIRE(tinygltf::TinyGLTF().LoadBinaryFromFile(
+        &model, &err, &warn, filename));
+    std::remove(filename.c_str());
+
+    // Identical bodies share a mesh
+    REQUIRE(model.nodes.size() == 3);
+    CHECK(model.meshes.size() == 2);
+    CHECK(model.nodes[0].mesh == model.nodes[1].mesh);
+    CHECK(model.nodes[0].mesh != model.nodes[2].mesh);
+
+    REQUIRE(model.animations.size() == 1);
+    const tinygltf::Animation& animation = model.animations[0];
+    REQUIRE(animation.channels.size() == 6);
+    for (const tinygltf::AnimationChannel& channel : animation.channels) {
+        const tinygltf::AnimationSampler& sampler =
+            animation.samplers[channel.sampler];
+        REQUIRE(model.accessors[sampler.input].count == num_frames);
+        REQUIRE(model.accessors[sampler.output].count == num_frames);
+
+        for (int j = 0; j < num_frames; j++) {
+            CHECK(
+                accessor_element(model, sampler.input, j)[0]
+                == Approx(0.01 * j));
+
+            PoseD pose = frame_pose(channel.target_node, j);
+            Eigen::VectorXd x = accessor_element(model, sampler.output, j);
+            if (channel.target_path == "translation") {
+                CHECK((x - pose.position).norm() < 1e-6);
+            } else {
+                Eigen::Quaterniond q = pose.construct_quaternion();
+                Eigen::Vector4d expected(q.x(), q.y(), q.z(), q.w());
+                CHECK(
+                    (x - expected).norm()
+                    < (quantize_rotations ? 1e-4 : 1e-6));
+            }
+        }
+    }
+}
@@ -73,3 +73,76 @@ TEST_CASE("2D Rigid Body Transform", "[RB][RB-transform]")
 }
 
 // TODO: Add 3D RB test
+
+TEST_CASE("Rigid body swept bounding box", "[RB][RB-bbox]")
+{
+    // A long thin rod
+    Eigen::MatrixXd vertices(4, 2);
+    vertices << -2.0, -0.1, 2.0, -0.1, 2.0, 0.1, -2.0, 0.1;
+    Eigen::MatrixXi edges(4, 2);
+    edges << 0, 1, 1, 2, 2, 3, 3, 0;
+    auto rb = simple(vertices, edges, Pose<double>::Zero(2));
+
+    Pose<double> pose_t0 = rb.pose, pose_t1 = rb.pose;
+    pose_t1.position << 0.5, 0.25;
+
+    double dtheta = GENERATE(0.0, 0.01, 0.1, 1.0, igl::PI, 4.0);
+    pose_t1.rotation << dtheta;
+
+    VectorMax3d box_min, box_max;
+    rb.compute_bounding_box(pose_t0, pose_t1, box_min, box_max);
+
+    const int num_samples = 100;
+    for (int i = 0; i <= num_samples; i++) {
+        double t = i / double(num_samples);
+        Eigen::MatrixXd V = rb.world_vertices<double>(
+            Pose<double>::interpolate(pose_t0, pose_t1, t));
+        for (int vi = 0; vi < V.rows(); vi++) {
+            CHECK((V.row(vi).transpose().array() >= box_min.array()).all());
+            CHECK((V.row(vi).transpose().array() <= box_max.array()).all());
+        }
+    }
+
+    if (dtheta <= 0.1) {
+        // Tighter than the bounding sphere of the rod
+        CHECK(box_max(1) - box_min(1) < 2 * rb.r_max);
+    }
+}
+
+TEST_CASE("Fixed rigid body world cache", "[RB][RB-cache]")
+{
+    Eigen::MatrixXd vertices(3, 2);
+    vertices << 0.0, 0.0, 1.0, 0.0, 0.0, 1.0;
+    Eigen::MatrixXi edges(3, 2);
+    edges << 0, 1, 1, 2, 2, 0;
+    Pose<double> pose(0.5, -1.0, 0.3);
+    RigidBody rb(
+        vertices, edges, pose, /*velocity=*/Pose<double>::Zero(2),
+        /*force=*/Pose<double>::Zero(2), /*density=*/1.0,
+        /*is_dof_fixed=*/VectorXb::Ones(3), /*oriented=*/false, /*group=*/0);
+
+    REQUIRE(rb.type == RigidBodyType::STATIC);
+    REQUIRE(rb.has_world_cache(rb.pose));
+
+    Eigen::MatrixXd expected = rb.world_vertices<double>(
+        rb.pose.construct_rotation_matrix(), rb.pose.position);
+    CHECK(rb.world_vertices(rb.pose) == expected);
+    // The cached vertices are returned without a copy
+    Eigen::MatrixXd buffer;
+    const Eigen::MatrixXd& V = rb.world_vertices(rb.pose, buffer);
+    CHECK(&V != &buffer);
+    CHECK(V == expected);
+    for (int i = 0; i < expected.rows(); i++) {
+        CHECK(rb.world_vertex(rb.pose, i) == expected.row(i).transpose());
+    }
+
+    // A different pose bypasses the cache
+    Pose<double> other = rb.pose;
+    other.position.x() += 1;
+    CHECK(!rb.has_world_cache(other));
+    CHECK(
+        rb.world_vertices(other)
+        == rb.world_vertices<double>(
+            other.construct_rotation_matrix(), other.position));
+    CHECK(&rb.world_vertices(other, buffer) == &buffer);
+}
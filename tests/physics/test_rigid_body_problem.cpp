@@ -1,10 +1,15 @@
+#include <algorithm>
 #include <array>
 #include <iomanip>
 #include <iostream>
+#include <random>
 
 #include <catch2/catch.hpp>
 #include <finitediff.hpp>
 #include <igl/PI.h>
+#include <igl/edges.h>
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
 
 #include <physics/mass.hpp>
 #include <problems/split_distance_barrier_rb_problem.hpp>
@@ -252,4 +257,302 @@ TEST_CASE("dof -> poses -> dof", "[RB][RB-Problem]")
     }
 }
 
+/// Exposes the barrier hessian projection of the problem.
+class BarrierHessianTestProblem : public DistanceBarrierRBProblem {
+public:
+    using DistanceBarrierRBProblem::barrier_hessian_projection;
+};
+
+/// Exposes the intersection check of the problem.
+class IntersectionTestProblem : public DistanceBarrierRBProblem {
+public:
+    using RigidBodyProblem::detect_intersections;
+    using RigidBodyProblem::incremental_intersection_check;
+};
+
+/// Two bodies whose closest primitives are a distance apart: a vertex above
+/// an edge in 2D and two crossing edges in 3D.
+std::vector<RigidBody>
+bodies_in_contact(int dim, double distance, bool is_first_static = false)
+{
+    Eigen::MatrixXd vertices_a, vertices_b;
+    Eigen::MatrixXi edges_a, edges_b, faces;
+    if (dim == 2) {
+        vertices_a.resize(2, 2);
+        vertices_a << -1, 0, 1, 0;
+        edges_a.resize(1, 2);
+        edges_a << 0, 1;
+
+        vertices_b.resize(3, 2);
+        vertices_b << 0, distance, 1, 2, -1, 2;
+        edges_b.resize(3, 2);
+        edges_b << 0, 1, 1, 2, 2, 0;
+    } else {
+        // Tetrahedra with an edge along x on top and along y on the bottom
+        vertices_a.resize(4, 3);
+        vertices_a << -1, 0, 0, 1, 0, 0, 0, -1, -1, 0, 1, -1;
+        vertices_b.resize(4, 3);
+        vertices_b << 0, -1, 0, 0, 1, 0, -1, 0, 1, 1, 0, 1;
+        vertices_b.col(2).array() += distance;
+        faces.resize(4, 3);
+        faces << 0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3;
+        igl::edges(faces, edges_a);
+        edges_b = edges_a;
+    }
+
+    std::vector<RigidBody> rbs;
+    int ndof = Pose<double>::dim_to_ndof(dim);
+    for (int i = 0; i < 2; i++) {
+        bool is_static = i == 0 && is_first_static;
+        rbs.emplace_back(
+            i == 0 ? vertices_a : vertices_b, i == 0 ? edges_a : edges_b,
+            faces, /*pose=*/Pose<double>::Zero(dim),
+            /*velocity=*/Pose<double>::Zero(dim),
+            /*force=*/Pose<double>::Zero(dim), /*density=*/1,
+            /*is_dof_fixed=*/VectorXb::Constant(ndof, is_static),
+            /*oriented=*/false, /*group=*/i);
+    }
+    return rbs;
+}
+
+TEST_CASE(
+    "Gauss-Newton barrier hessian",
+    "[RB][RB-Problem][RB-Problem-hessian][barrier]")
+{
+    // Edge-vertex constraint in 2D and edge-edge constraint in 3D
+    int dim = GENERATE(2, 3);
+
+    BarrierHessianTestProblem rbp;
+    rbp.init(bodies_in_contact(dim, /*distance=*/1e-4));
+    rbp.barrier_activation_distance(0.1);
+
+    Eigen::VectorXd x = rbp.poses_to_dofs(rbp.m_assembler.rb_poses());
+
+    int num_constraints;
+    Eigen::VectorXd grad_eigen, grad_gn;
+    Eigen::SparseMatrix<double> hess_eigen, hess_gn;
+    rbp.barrier_hessian_projection = EIGEN_PROJECTION;
+    rbp.compute_barrier_term(x, grad_eigen, hess_eigen, num_constraints);
+    REQUIRE(num_constraints == 1);
+    rbp.barrier_hessian_projection = GAUSS_NEWTON_PROJECTION;
+    rbp.compute_barrier_term(x, grad_gn, hess_gn, num_constraints);
+    REQUIRE(num_constraints == 1);
+
+    CHECK(grad_gn.isApprox(grad_eigen));
+    REQUIRE(grad_gn.squaredNorm() > 0);
+
+    // The Gauss-Newton hessian is a non-negative multiple of ggᵀ
+    const Eigen::MatrixXd H_gn = hess_gn.toDense();
+    const double curvature = grad_gn.dot(H_gn * grad_gn)
+        / (grad_gn.squaredNorm() * grad_gn.squaredNorm());
+    CHECK(curvature >= 0);
+    CHECK(H_gn.isApprox(curvature * grad_gn * grad_gn.transpose()));
+
+    // Close to contact the barrier's curvature along the constraint
+    // gradient dominates, so both projections agree.
+    const Eigen::MatrixXd H_eigen = hess_eigen.toDense();
+    CHECK((H_gn - H_eigen).norm() <= 1e-2 * H_eigen.norm());
+}
+
+TEST_CASE(
+    "Barrier hessian against a static body",
+    "[RB][RB-Problem][RB-Problem-hessian][barrier]")
+{
+    int dim = GENERATE(2, 3);
+    double distance = GENERATE(1e-3, 5e-2);
+
+    // The free body's block of the hessian does not depend on whether the
+    // other body is free or static.
+    std::array<Eigen::MatrixXd, 2> hessians;
+    for (int is_static = 0; is_static < 2; is_static++) {
+        DistanceBarrierRBProblem rbp;
+        rbp.init(bodies_in_contact(dim, distance, is_static));
+        rbp.barrier_activation_distance(0.1);
+        const RigidBody& rb = rbp.m_assembler[rbp.m_assembler.body_index(0)];
+        REQUIRE(rb.is_dof_fixed.array().all() == bool(is_static));
+
+        Eigen::VectorXd x = rbp.poses_to_dofs(rbp.m_assembler.rb_poses());
+        int num_constraints;
+        Eigen::VectorXd grad;
+        Eigen::SparseMatrix<double> hess;
+        rbp.compute_barrier_term(x, grad, hess, num_constraints);
+        REQUIRE(num_constraints > 0);
+
+        int ndof = Pose<double>::dim_to_ndof(dim);
+        int offset = ndof * rbp.m_assembler.body_index(1);
+        hessians[is_static] =
+            hess.toDense().block(offset, offset, ndof, ndof);
+    }
+
+    REQUIRE(hessians[0].norm() > 0);
+    CHECK(hessians[1].isApprox(hessians[0]));
+}
+
+TEST_CASE(
+    "Incremental intersection check",
+    "[RB][RB-Problem][RB-Problem-intersection]")
+{
+    int dim = GENERATE(2, 3);
+
+    IntersectionTestProblem rbp;
+    rbp.init(bodies_in_contact(dim, /*distance=*/0.05));
+    REQUIRE(rbp.incremental_intersection_check);
+
+    const PosesD poses = rbp.m_assembler.rb_poses();
+    // Move the second body through the first one
+    PosesD intersecting_poses = poses;
+    intersecting_poses[rbp.m_assembler.body_index(1)].position[dim - 1] -= 0.5;
+
+    // The incremental check agrees with a full check
+    const auto check = [&](const PosesD& check_poses, bool expected) {
+        rbp.incremental_intersection_check = false;
+        CHECK(rbp.detect_intersections(check_poses) == expected);
+        rbp.incremental_intersection_check = true;
+        CHECK(rbp.detect_intersections(check_poses) == expected);
+    };
+
+    SECTION("Nothing moves")
+    {
+        CHECK(!rbp.detect_intersections(poses));
+        CHECK(!rbp.detect_intersections(poses));
+        check(poses, false);
+    }
+
+    SECTION("A body moves into another")
+    {
+        CHECK(!rbp.detect_intersections(poses));
+        CHECK(rbp.detect_intersections(intersecting_poses));
+        // Intersecting poses are not remembered as intersection-free
+        CHECK(rbp.detect_intersections(intersecting_poses));
+        check(intersecting_poses, true);
+        // Moving back out
+        check(poses, false);
+    }
+}
+
+/// Exposes the collision constraint of the problem.
+class DeterminismTestProblem : public DistanceBarrierRBProblem {
+public:
+    using DistanceBarrierRBProblem::m_constraint;
+};
+
+/// A grid of unit squares a gap apart, so every square is close to its
+/// neighbours.
+std::vector<RigidBody> grid_of_squares(int num_rows, double gap)
+{
+    Eigen::MatrixXd vertices(4, 2);
+    vertices << -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, 0.5;
+    Eigen::MatrixXi edges(4, 2);
+    edges << 0, 1, 1, 2, 2, 3, 3, 0;
+
+    std::vector<RigidBody> rbs;
+    for (int i = 0; i < num_rows; i++) {
+        for (int j = 0; j < num_rows; j++) {
+            Pose<double> pose = Pose<double>::Zero(2);
+            pose.position << (1 + gap) * i, (1 + gap) * j;
+            rbs.emplace_back(
+                vertices, edges, pose, /*velocity=*/Pose<double>::Zero(2),
+                /*force=*/Pose<double>::Zero(2), /*density=*/1,
+                /*is_dof_fixed=*/VectorXb::Zero(3), /*oriented=*/false,
+                /*group=*/rbs.size());
+        }
+    }
+    return rbs;
+}
+
+/// Are two sparse matrices identical bit for bit?
+bool are_identical(Eigen::SparseMatrix<double> A, Eigen::SparseMatrix<double> B)
+{
+    A.makeCompressed();
+    B.makeCompressed();
+    return A.rows() == B.rows() && A.cols() == B.cols()
+        && A.nonZeros() == B.nonZeros()
+        && std::equal(
+               A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1,
+               B.outerIndexPtr())
+        && std::equal(
+               A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros(),
+               B.innerIndexPtr())
+        && std::equal(
+               A.valuePtr(), A.valuePtr() + A.nonZeros(), B.valuePtr());
+}
+
+TEST_CASE(
+    "Parallel reductions do not depend on the number of threads",
+    "[RB][RB-Problem][RB-Problem-determinism]")
+{
+    struct Results {
+        int num_constraints;
+        double barrier, friction, toi;
+        Eigen::VectorXd barrier_grad, friction_grad;
+        Eigen::SparseMatrix<double> barrier_hess, friction_hess;
+    };
+
+    const auto compute = [](int num_threads, bool deterministic) {
+        tbb::global_control thread_limiter(
+            tbb::global_control::max_allowed_parallelism, num_threads);
+        // An explicit arena has this many threads even on fewer cores
+        tbb::task_arena arena(num_threads);
+
+        Results r;
+        arena.execute([&] {
+            DeterminismTestProblem rbp;
+            rbp.coefficient_friction = 0.5;
+            rbp.m_constraint.initial_barrier_activation_distance = 0.1;
+            rbp.m_constraint.deterministic = deterministic;
+            // Defaults of the simulation settings
+            rbp.m_constraint.detection_method = DetectionMethod::BVH;
+            rbp.m_constraint.trajectory_type =
+                TrajectoryType::PIECEWISE_LINEAR;
+            // Enough contacts for many blocks of constraints and many waves
+            // of narrow-phase candidates
+            rbp.init(grid_of_squares(/*num_rows=*/32, /*gap=*/0.05));
+
+            // The same small displacement in every run
+            const Eigen::VectorXd x0 =
+                rbp.poses_to_dofs(rbp.m_assembler.rb_poses());
+            std::mt19937 gen(0);
+            std::uniform_real_distribution<double> displacement(-0.01, 0.01);
+            Eigen::VectorXd dx(x0.size());
+            for (int i = 0; i < dx.size(); i++) {
+                dx[i] = displacement(gen);
+            }
+            const Eigen::VectorXd x = x0 + dx;
+
+            r.barrier = rbp.compute_barrier_term(
+                x, r.barrier_grad, r.barrier_hess, r.num_constraints);
+            r.friction = rbp.compute_friction_term(
+                x, r.friction_grad, r.friction_hess);
+            // Large enough for the squares to collide
+            r.toi = rbp.compute_earliest_toi(x0, x0 + 10 * dx);
+        });
+        return r;
+    };
+
+    const Results expected = compute(/*num_threads=*/1, true);
+    REQUIRE(expected.num_constraints > 1000);
+    REQUIRE(expected.friction > 0);
+    REQUIRE(expected.toi < 1);
+
+    const int num_threads = GENERATE(3, 8);
+    const Results actual = compute(num_threads, true);
+    CHECK(actual.num_constraints == expected.num_constraints);
+    CHECK(actual.barrier == expected.barrier);
+    CHECK(actual.barrier_grad == expected.barrier_grad);
+    CHECK(are_identical(actual.barrier_hess, expected.barrier_hess));
+    CHECK(actual.friction == expected.friction);
+    CHECK(actual.friction_grad == expected.friction_grad);
+    CHECK(are_identical(actual.friction_hess, expected.friction_hess));
+    CHECK(actual.toi == expected.toi);
+
+    // Without the setting only the order of the sums changes
+    const Results relaxed = compute(num_threads, false);
+    CHECK(relaxed.num_constraints == expected.num_constraints);
+    CHECK(relaxed.barrier == Approx(expected.barrier));
+    CHECK(relaxed.barrier_grad.isApprox(expected.barrier_grad));
+    CHECK(relaxed.friction == Approx(expected.friction));
+    CHECK(relaxed.friction_grad.isApprox(expected.friction_grad));
+    CHECK(relaxed.toi < 1);
+}
+
 // TODO: Add 3D RB test
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <iomanip>
 #include <iostream>
@@ -5,7 +6,11 @@
 #include <catch2/catch.hpp>
 
 #include <igl/PI.h>
+#include <igl/edges.h>
 
+#include <ipc/utils/intersection.hpp>
+
+#include <ccd/rigid/broad_phase.hpp>
 #include <physics/rigid_body_assembler.hpp>
 
 // ---------------------------------------------------
@@ -76,3 +81,180 @@ TEST_CASE("Rigid Body System Transform", "[RB][RB-System][RB-System-transform]")
         assembler.world_vertices(poses) - assembler.world_vertices();
     CHECK((expected - actual).squaredNorm() < 1E-6);
 }
+
+TEST_CASE("Buffered world vertices", "[RB][RB-System][RB-System-buffered]")
+{
+    Eigen::MatrixXd vertices(4, 2);
+    vertices << -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, 0.5;
+    Eigen::MatrixXi edges(4, 2);
+    edges << 0, 1, 1, 2, 2, 3, 3, 0;
+    Pose<double> velocity = Pose<double>::Zero(2);
+
+    std::vector<RigidBody> rbs;
+    for (int i = 0; i < 3; i++) {
+        rbs.push_back(simple_rigid_body(vertices, edges, velocity));
+    }
+    RigidBodyAssembler assembler;
+    assembler.init(rbs);
+
+    Poses<double> poses_t0 = assembler.rb_poses_t0();
+    Poses<double> poses_t1 = poses_t0;
+    poses_t1[1].position << 1.0, 2.0;
+    poses_t1[2].rotation << 0.25 * igl::PI;
+
+    // Alternate between poses and change one body at a time
+    for (int i = 0; i < 3; i++) {
+        CHECK(
+            assembler.world_vertices_buffered(poses_t0)
+            == assembler.world_vertices(poses_t0));
+        CHECK(
+            assembler.world_vertices_buffered(poses_t1)
+            == assembler.world_vertices(poses_t1));
+        poses_t1[i].position.x() += 0.5;
+    }
+}
+
+TEST_CASE(
+    "Early-exit intersection check", "[RB][RB-System][RB-System-intersection]")
+{
+    Eigen::MatrixXd vertices(4, 3);
+    vertices << 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1;
+    Eigen::MatrixXi faces(4, 3);
+    faces << 0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3;
+    Eigen::MatrixXi edges;
+    igl::edges(faces, edges);
+
+    std::vector<RigidBody> rbs;
+    for (int i = 0; i < 3; i++) {
+        rbs.push_back(RigidBody(
+            vertices, edges, faces, /*pose=*/Pose<double>::Zero(3),
+            /*velocity=*/Pose<double>::Zero(3),
+            /*force=*/Pose<double>::Zero(3), /*density=*/1.0,
+            /*is_dof_fixed=*/VectorXb::Zero(6), /*oriented=*/false,
+            /*group=*/i));
+    }
+    RigidBodyAssembler assembler;
+    assembler.init(rbs);
+
+    Poses<double> poses = assembler.rb_poses_t0();
+    poses[1].position << 3, 0, 0;
+    poses[2].position << 0, 3, 0;
+    double offset = GENERATE(0.1, 2.0);
+    poses[2].position.x() = offset;
+    poses[2].rotation << 0.3, -0.2, 0.1;
+
+    const Eigen::MatrixXd V = assembler.world_vertices(poses);
+    const Eigen::MatrixXi& E = assembler.m_edges;
+    const Eigen::MatrixXi& F = assembler.m_faces;
+    auto is_intersecting = [&](const EdgeFaceCandidate& ef) {
+        return is_edge_intersecting_triangle(
+            V.row(E(ef.edge_id, 0)), V.row(E(ef.edge_id, 1)),
+            V.row(F(ef.face_id, 0)), V.row(F(ef.face_id, 1)),
+            V.row(F(ef.face_id, 2)));
+    };
+
+    std::vector<EdgeFaceCandidate> ef_candidates;
+    detect_intersection_candidates_rigid_bvh(assembler, poses, ef_candidates);
+    bool expected = std::any_of(
+        ef_candidates.begin(), ef_candidates.end(), is_intersecting);
+
+    std::vector<std::pair<int, int>> body_pairs =
+        assembler.close_bodies(poses, poses, /*inflation_radius=*/0);
+    CHECK(
+        find_intersection_rigid_bvh(
+            assembler, poses, body_pairs, is_intersecting)
+        == expected);
+}
+
+TEST_CASE("Reorder bodies", "[RB][RB-System][RB-System-reorder]")
+{
+    Eigen::MatrixXd vertices(4, 2);
+    vertices << -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, 0.5;
+    Eigen::MatrixXi edges(4, 2);
+    edges << 0, 1, 1, 2, 2, 3, 3, 0;
+
+    // Bodies on a line in a shuffled order
+    const std::vector<double> xs = { 3, 0, 4, 1, 2 };
+    std::vector<RigidBody> rbs;
+    for (int i = 0; i < int(xs.size()); i++) {
+        Pose<double> pose = Pose<double>::Zero(2);
+        pose.position.x() = 2 * xs[i];
+        rbs.push_back(RigidBody(
+            vertices, edges, pose, /*velocity=*/Pose<double>::Zero(2),
+            /*force=*/Pose<double>::Zero(2), /*density=*/1.0,
+            /*is_dof_fixed=*/VectorXb::Zero(3), /*oriented=*/false,
+            /*group=*/i));
+    }
+    RigidBodyAssembler assembler;
+    assembler.init(rbs);
+    const Eigen::MatrixXd V = assembler.world_vertices();
+    const Poses<double> poses = assembler.rb_poses();
+
+    BodyOrder order = GENERATE(BodyOrder::MORTON, BodyOrder::HILBERT);
+    REQUIRE(assembler.reorder_bodies(order));
+    CHECK(!assembler.reorder_bodies(order));
+    for (size_t i = 0; i < assembler.num_bodies(); i++) {
+        CHECK(assembler[i].pose.position.x() == 2 * i);
+        CHECK(assembler.body_index(assembler.body_id(i)) == i);
+        CHECK(size_t(assembler[i].group_id) == assembler.body_id(i));
+    }
+    CHECK(assembler.to_scene_order(assembler.rb_poses()) == poses);
+    CHECK(assembler.pose_buffer().row(0) == poses[0].dof().transpose());
+    // Like the poses, the world vertex buffer is in scene order
+    CHECK(assembler.world_vertex_buffer() == V);
+
+    // The global vertex ids follow the bodies
+    const Eigen::MatrixXd sorted_V = assembler.world_vertices();
+    for (size_t i = 0; i < assembler.num_bodies(); i++) {
+        CHECK(
+            sorted_V.middleRows(assembler.m_body_vertex_id[i], 4)
+            == V.middleRows(4 * assembler.body_id(i), 4));
+    }
+
+    REQUIRE(assembler.reorder_bodies(BodyOrder::SCENE));
+    CHECK(assembler.rb_poses() == poses);
+}
+
+TEST_CASE("Save and restore body states", "[RB][RB-System][RB-System-states]")
+{
+    Eigen::MatrixXd vertices(4, 2);
+    vertices << -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, 0.5;
+    Eigen::MatrixXi edges(4, 2);
+    edges << 0, 1, 1, 2, 2, 3, 3, 0;
+
+    // Bodies on a line in reverse order
+    std::vector<RigidBody> rbs;
+    for (int i = 0; i < 5; i++) {
+        rbs.push_back(simple_rigid_body(
+            vertices, edges, Pose<double>(Eigen::Vector3d::Random())));
+        rbs.back().pose.position.x() = 2 * (4 - i);
+    }
+    RigidBodyAssembler assembler;
+    assembler.init(rbs);
+    const Poses<double> poses = assembler.rb_poses();
+    Poses<double> velocities;
+    for (size_t i = 0; i < assembler.num_bodies(); i++) {
+        velocities.push_back(assembler[i].velocity);
+    }
+
+    RigidBodyAssembler::BodyStates states;
+    assembler.save_body_states(states);
+    CHECK(states.poses == poses);
+    CHECK(states.velocities == velocities);
+
+    // Change the body order and clobber the state as a failed step would
+    REQUIRE(assembler.reorder_bodies(BodyOrder::MORTON));
+    assembler.set_rb_poses(
+        Pose<double>::dofs_to_poses(Eigen::VectorXd::Random(3 * 5), 2));
+    for (size_t i = 0; i < assembler.num_bodies(); i++) {
+        assembler[i].velocity = Pose<double>(Eigen::Vector3d::Random());
+    }
+
+    // The states are restored to the bodies they were saved from
+    assembler.restore_body_states(states);
+    REQUIRE(assembler.reorder_bodies(BodyOrder::SCENE));
+    CHECK(assembler.rb_poses() == poses);
+    for (size_t i = 0; i < assembler.num_bodies(); i++) {
+        CHECK(assembler[i].velocity == velocities[i]);
+    }
+}
@@ -0,0 +1,43 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+#include <utils/eigen_ext.hpp>
+
+using namespace ipc;
+
+TEST_CASE("Rank-one PSD curvature", "[eigen_ext][psd]")
+{
+    const int n = GENERATE(3, 6, 12);
+    const double b_hess = GENERATE(0.0, 1.0, 1e4);
+    const double b_grad = GENERATE(-1.0, -1e2);
+
+    // Barrier-like hessian: b'' ∇d∇dᵀ + b' ∇²d
+    VectorMax12d grad_d = VectorMax12d::Random(n);
+    MatrixMax12d hess_d = MatrixMax12d::Random(n, n);
+    hess_d = (hess_d + hess_d.transpose()).eval();
+
+    const VectorMax12d g = b_grad * grad_d;
+    const MatrixMax12d H =
+        b_hess * grad_d * grad_d.transpose() + b_grad * hess_d;
+
+    const double kappa = rank_one_psd_curvature(g, H);
+    CHECK(kappa >= 0);
+
+    // Same curvature along the gradient as H (when H is convex along it)
+    const double gHg = g.dot(H * g);
+    const double gAg = kappa * g.squaredNorm() * g.squaredNorm();
+    CHECK(gAg == Approx(std::max(gHg, 0.0)).margin(1e-8));
+
+    // Never more curved along g than the eigenvalue projection of H
+    const MatrixMax12d H_psd = project_to_psd(H);
+    CHECK(gAg <= g.dot(H_psd * g) * (1 + 1e-10) + 1e-8);
+}
+
+TEST_CASE("Rank-one PSD curvature of zero gradient", "[eigen_ext][psd]")
+{
+    CHECK(
+        rank_one_psd_curvature(
+            VectorMax12d::Zero(6), MatrixMax12d::Identity(6, 6))
+        == 0);
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <utils/primitive_bvh.hpp>
+
+using namespace ipc;
+using namespace ipc::rigid;
+
+static std::vector<PrimitiveBVH::Box> random_boxes(int n, double size)
+{
+    std::vector<PrimitiveBVH::Box> boxes(n);
+    for (auto& box : boxes) {
+        box[0] = Eigen::Vector3d::Random();
+        box[1] = box[0] + size * (Eigen::Vector3d::Random().array().abs())
+                                     .matrix();
+    }
+    return boxes;
+}
+
+TEST_CASE("Primitive BVH dual traversal", "[bvh]")
+{
+    int num_a = GENERATE(1, 2, 17, 200);
+    int num_b = GENERATE(1, 3, 150);
+    std::vector<PrimitiveBVH::Box> boxes_a = random_boxes(num_a, 0.1);
+    std::vector<PrimitiveBVH::Box> boxes_b = random_boxes(num_b, 0.1);
+
+    PrimitiveBVH bvh_a, bvh_b;
+    bvh_a.init(boxes_a);
+    bvh_b.init(boxes_b);
+
+    // Move the primitives of A and refit its tree
+    for (auto& box : boxes_a) {
+        box[0].x() += 0.05;
+        box[1].x() += 0.05;
+    }
+    std::vector<PrimitiveBVH::Box> node_boxes;
+    bvh_a.refit(boxes_a, node_boxes);
+
+    std::vector<std::pair<int, int>> expected, actual;
+    for (int i = 0; i < num_a; i++) {
+        for (int j = 0; j < num_b; j++) {
+            if (PrimitiveBVH::boxes_intersect(boxes_a[i], boxes_b[j])) {
+                expected.emplace_back(i, j);
+            }
+        }
+    }
+    PrimitiveBVH::intersect(
+        bvh_a, node_boxes, bvh_b,
+        [&](unsigned int i, unsigned int j) { actual.emplace_back(i, j); });
+
+    std::sort(actual.begin(), actual.end());
+    CHECK(actual == expected);
+}
+
+TEST_CASE("Primitive BVH subtrees", "[bvh]")
+{
+    int num_a = GENERATE(1, 40);
+    int num_b = GENERATE(1, 2, 150);
+    size_t num_subtrees = GENERATE(1, 2, 7, 1000);
+    std::vector<PrimitiveBVH::Box> boxes_a = random_boxes(num_a, 0.2);
+    std::vector<PrimitiveBVH::Box> boxes_b = random_boxes(num_b, 0.2);
+
+    PrimitiveBVH bvh_a, bvh_b;
+    bvh_a.init(boxes_a);
+    bvh_b.init(boxes_b);
+
+    std::vector<int> roots = bvh_b.subtrees(num_subtrees);
+    CHECK(roots.size() == std::min(num_subtrees, size_t(num_b)));
+
+    // The subtrees partition the pairs found by the full traversal
+    std::vector<std::pair<int, int>> expected, actual;
+    auto add_pair = [](std::vector<std::pair<int, int>>& pairs) {
+        return [&pairs](unsigned int i, unsigned int j) {
+            pairs.emplace_back(i, j);
+        };
+    };
+    PrimitiveBVH::intersect(bvh_a, bvh_a.boxes(), bvh_b, add_pair(expected));
+    for (int root : roots) {
+        PrimitiveBVH::intersect(
+            bvh_a, bvh_a.boxes(), bvh_b, root, add_pair(actual));
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    CHECK(actual == expected);
+}
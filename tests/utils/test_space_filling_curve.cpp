@@ -0,0 +1,52 @@
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <map>
+
+#include <utils/space_filling_curve.hpp>
+
+using namespace ipc::rigid;
+
+TEST_CASE("Hilbert curve visits adjacent cells", "[utils][space_filling_curve]")
+{
+    const int dim = GENERATE(2, 3);
+    const int bits = 3, n = 1 << bits;
+    const int num_cells = dim == 2 ? n * n : n * n * n;
+
+    std::map<uint64_t, std::array<uint32_t, 3>> cells;
+    for (int c = 0; c < num_cells; c++) {
+        std::array<uint32_t, 3> coords = { { uint32_t(c % n),
+                                             uint32_t((c / n) % n),
+                                             uint32_t(c / (n * n)) } };
+        cells[hilbert_key(coords, dim, bits)] = coords;
+    }
+    REQUIRE(cells.size() == num_cells);
+    CHECK(cells.rbegin()->first == num_cells - 1);
+
+    for (auto prev = cells.begin(), it = std::next(prev); it != cells.end();
+         prev = it++) {
+        int distance = 0;
+        for (int i = 0; i < dim; i++) {
+            distance += std::abs(int(it->second[i]) - int(prev->second[i]));
+        }
+        CHECK(distance == 1);
+    }
+}
+
+TEST_CASE("Morton curve order", "[utils][space_filling_curve]")
+{
+    CHECK(morton_key({ { 0, 0, 0 } }, 2, 2) == 0);
+    CHECK(morton_key({ { 0, 1, 0 } }, 2, 2) == 1);
+    CHECK(morton_key({ { 1, 0, 0 } }, 2, 2) == 2);
+    CHECK(morton_key({ { 3, 3, 0 } }, 2, 2) == 15);
+    CHECK(morton_key({ { 1, 1, 1 } }, 3, 1) == 7);
+
+    Eigen::MatrixXd points(4, 2);
+    points << 1, 1, 0, 0, 1, 0, 0, 1;
+    CHECK(
+        space_filling_curve_order(points, SpaceFillingCurve::MORTON)
+        == std::vector<size_t> { 1, 3, 2, 0 });
+    CHECK(
+        space_filling_curve_order(points, SpaceFillingCurve::HILBERT)
+        == std::vector<size_t> { 1, 3, 0, 2 });
+}